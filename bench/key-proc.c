@@ -25,9 +25,15 @@
 #include <time.h>
 
 #include "../test/test.h"
+#include "keymap.h"
 #include "bench.h"
 
 #define BENCHMARK_ITERATIONS 20000000
+#define LEVELS_BENCHMARK_ITERATIONS 20000
+#define TEXT_BENCHMARK_ITERATIONS 20000
+#define BATCH_BENCHMARK_EVENTS 4000000
+#define BATCH_FRAME_SIZE 4
+#define QUERY_BENCHMARK_ITERATIONS 10000000
 
 static void
 bench(struct xkb_state *state)
@@ -51,6 +57,269 @@ bench(struct xkb_state *state)
     }
 }
 
+/*
+ * Looks up the level and consumed modifiers of every key under every
+ * combination of the modifiers used by the (heavy) types of the keymap.
+ */
+static unsigned long
+bench_levels(struct xkb_state *state, const xkb_mod_mask_t *mods,
+             unsigned num_mods)
+{
+    struct xkb_keymap *keymap = xkb_state_get_keymap(state);
+    xkb_keycode_t min = xkb_keymap_min_keycode(keymap);
+    xkb_keycode_t max = xkb_keymap_max_keycode(keymap);
+    unsigned long lookups = 0;
+    int i;
+
+    for (i = 0; i < LEVELS_BENCHMARK_ITERATIONS; i++) {
+        for (uint32_t combo = 0; combo < (1u << num_mods); combo++) {
+            xkb_mod_mask_t depressed = 0;
+
+            for (unsigned j = 0; j < num_mods; j++)
+                if (combo & (1u << j))
+                    depressed |= mods[j];
+
+            xkb_state_update_mask(state, depressed, 0, 0, 0, 0, 0);
+
+            for (xkb_keycode_t kc = min; kc <= max; kc++) {
+                xkb_state_key_get_level(state, kc, 0);
+                xkb_state_key_get_consumed_mods(state, kc);
+                lookups++;
+            }
+        }
+    }
+
+    return lookups;
+}
+
+/* Like bench(), but also gets the text of every event, as a client would. */
+static void
+bench_per_event(struct xkb_state *state, struct xkb_key_event *events)
+{
+    for (int i = 0; i < BATCH_BENCHMARK_EVENTS; i += BATCH_FRAME_SIZE) {
+        for (int j = i; j < i + BATCH_FRAME_SIZE; j++) {
+            struct xkb_key_event *event = &events[j];
+
+            event->keysym = xkb_state_key_get_one_sym(state, event->keycode);
+            event->utf32 = xkb_state_key_get_utf32(state, event->keycode);
+            xkb_state_update_key(state, event->keycode, event->direction);
+        }
+        xkb_state_serialize_mods(state, XKB_STATE_MODS_EFFECTIVE);
+    }
+}
+
+static void
+bench_batched(struct xkb_state *state, struct xkb_key_event *events)
+{
+    for (int i = 0; i < BATCH_BENCHMARK_EVENTS; i += BATCH_FRAME_SIZE) {
+        xkb_state_update_keys(state, &events[i], BATCH_FRAME_SIZE);
+        xkb_state_serialize_mods(state, XKB_STATE_MODS_EFFECTIVE);
+    }
+}
+
+static void
+run_batch(struct xkb_keymap *keymap)
+{
+    struct xkb_key_event *events;
+    int8_t keys[256] = { 0 };
+    struct xkb_state *state;
+    struct bench_timer timer;
+    char *elapsed;
+
+    events = calloc(BATCH_BENCHMARK_EVENTS, sizeof(*events));
+    assert(events);
+
+    for (int i = 0; i < BATCH_BENCHMARK_EVENTS; i++) {
+        xkb_keycode_t keycode = (rand() % (255 - 9)) + 9;
+
+        events[i].keycode = keycode;
+        events[i].direction = keys[keycode] ? XKB_KEY_UP : XKB_KEY_DOWN;
+        keys[keycode] = !keys[keycode];
+    }
+
+    state = xkb_state_new(keymap);
+    assert(state);
+
+    bench_timer_reset(&timer);
+    bench_timer_start(&timer);
+    bench_per_event(state, events);
+    bench_timer_stop(&timer);
+
+    elapsed = bench_timer_get_elapsed_time_str(&timer);
+    fprintf(stderr, "processed %d events one by one in %ss\n",
+            BATCH_BENCHMARK_EVENTS, elapsed);
+    free(elapsed);
+
+    xkb_state_unref(state);
+    state = xkb_state_new(keymap);
+    assert(state);
+
+    bench_timer_reset(&timer);
+    bench_timer_start(&timer);
+    bench_batched(state, events);
+    bench_timer_stop(&timer);
+
+    elapsed = bench_timer_get_elapsed_time_str(&timer);
+    fprintf(stderr, "processed %d events in batches of %d in %ss\n",
+            BATCH_BENCHMARK_EVENTS, BATCH_FRAME_SIZE, elapsed);
+    free(elapsed);
+
+    xkb_state_unref(state);
+    free(events);
+}
+
+/* Checks for Ctrl+Alt and the Caps Lock LED, as a toolkit would per event. */
+static void
+run_queries(struct xkb_keymap *keymap)
+{
+    const char *mod_names[] = { XKB_MOD_NAME_CTRL, XKB_MOD_NAME_ALT };
+    const char *led_names[] = { XKB_LED_NAME_CAPS };
+    struct xkb_state_query *mods_query, *led_query;
+    struct xkb_state *state;
+    struct bench_timer timer;
+    unsigned long matches = 0;
+    char *elapsed;
+
+    state = xkb_state_new(keymap);
+    assert(state);
+
+    mods_query = xkb_state_query_new_mods(keymap, XKB_STATE_MODS_EFFECTIVE,
+                                          XKB_STATE_MATCH_ALL,
+                                          mod_names, ARRAY_SIZE(mod_names));
+    led_query = xkb_state_query_new_leds(keymap, XKB_STATE_MATCH_ANY,
+                                         led_names, ARRAY_SIZE(led_names));
+    assert(mods_query && led_query);
+
+    bench_timer_reset(&timer);
+    bench_timer_start(&timer);
+    for (int i = 0; i < QUERY_BENCHMARK_ITERATIONS; i++) {
+        matches += xkb_state_mod_names_are_active(state,
+                                                  XKB_STATE_MODS_EFFECTIVE,
+                                                  XKB_STATE_MATCH_ALL,
+                                                  XKB_MOD_NAME_CTRL,
+                                                  XKB_MOD_NAME_ALT, NULL);
+        matches += xkb_state_led_name_is_active(state, XKB_LED_NAME_CAPS);
+    }
+    bench_timer_stop(&timer);
+
+    elapsed = bench_timer_get_elapsed_time_str(&timer);
+    fprintf(stderr, "checked %d states by name in %ss\n",
+            QUERY_BENCHMARK_ITERATIONS, elapsed);
+    free(elapsed);
+
+    bench_timer_reset(&timer);
+    bench_timer_start(&timer);
+    for (int i = 0; i < QUERY_BENCHMARK_ITERATIONS; i++) {
+        matches += xkb_state_query_is_active(state, mods_query);
+        matches += xkb_state_query_is_active(state, led_query);
+    }
+    bench_timer_stop(&timer);
+
+    elapsed = bench_timer_get_elapsed_time_str(&timer);
+    fprintf(stderr, "checked %d states with prepared queries in %ss\n",
+            QUERY_BENCHMARK_ITERATIONS, elapsed);
+    free(elapsed);
+
+    assert(matches == 0);
+
+    xkb_state_query_unref(mods_query);
+    xkb_state_query_unref(led_query);
+    xkb_state_unref(state);
+}
+
+/*
+ * Gets the text of every key under every combination of the modifiers
+ * which affect it.
+ */
+static unsigned long
+bench_text(struct xkb_state *state, const xkb_mod_mask_t *mods,
+           unsigned num_mods)
+{
+    struct xkb_keymap *keymap = xkb_state_get_keymap(state);
+    xkb_keycode_t min = xkb_keymap_min_keycode(keymap);
+    xkb_keycode_t max = xkb_keymap_max_keycode(keymap);
+    unsigned long lookups = 0;
+    char buf[64];
+    int i;
+
+    for (i = 0; i < TEXT_BENCHMARK_ITERATIONS; i++) {
+        for (uint32_t combo = 0; combo < (1u << num_mods); combo++) {
+            xkb_mod_mask_t depressed = 0;
+
+            for (unsigned j = 0; j < num_mods; j++)
+                if (combo & (1u << j))
+                    depressed |= mods[j];
+
+            xkb_state_update_mask(state, depressed, 0, 0, 0, 0, i % 2);
+
+            for (xkb_keycode_t kc = min; kc <= max; kc++) {
+                xkb_state_key_get_utf8(state, kc, buf, sizeof(buf));
+                lookups++;
+            }
+        }
+    }
+
+    return lookups;
+}
+
+/* The memory used by the texts precomputed with CACHE_TEXT. */
+static size_t
+text_cache_size(struct xkb_keymap *keymap)
+{
+    const struct xkb_key *key;
+    size_t size = 0;
+
+    xkb_keys_foreach(key, keymap)
+        for (xkb_layout_index_t i = 0; i < key->num_groups; i++)
+            if (key->groups[i].texts)
+                size += XkbKeyNumLevels(key, i) *
+                        sizeof(struct xkb_level_text);
+
+    return size;
+}
+
+static void
+run_text(struct xkb_context *ctx, enum xkb_keymap_compile_flags flags)
+{
+    struct xkb_rule_names rmlvo = {
+        "evdev", "pc104", "us,ru", NULL, NULL
+    };
+    const char *mod_names[] = {
+        XKB_MOD_NAME_SHIFT, XKB_MOD_NAME_CAPS, XKB_MOD_NAME_CTRL,
+    };
+    xkb_mod_mask_t mods[ARRAY_SIZE(mod_names)];
+    struct xkb_keymap *keymap;
+    struct xkb_state *state;
+    struct bench_timer timer;
+    unsigned long lookups;
+    char *elapsed;
+
+    keymap = xkb_keymap_new_from_names(ctx, &rmlvo, flags);
+    assert(keymap);
+
+    state = xkb_state_new(keymap);
+    assert(state);
+
+    for (unsigned j = 0; j < ARRAY_SIZE(mod_names); j++)
+        mods[j] = 1u << xkb_keymap_mod_get_index(keymap, mod_names[j]);
+
+    bench_timer_reset(&timer);
+
+    bench_timer_start(&timer);
+    lookups = bench_text(state, mods, ARRAY_SIZE(mods));
+    bench_timer_stop(&timer);
+
+    elapsed = bench_timer_get_elapsed_time_str(&timer);
+    fprintf(stderr, "got text of %lu keys in %ss (%s, %zu bytes cached)\n",
+            lookups, elapsed,
+            flags & XKB_KEYMAP_COMPILE_CACHE_TEXT ? "cached" : "uncached",
+            text_cache_size(keymap));
+    free(elapsed);
+
+    xkb_state_unref(state);
+    xkb_keymap_unref(keymap);
+}
+
 int
 main(void)
 {
@@ -59,6 +328,11 @@ main(void)
     struct xkb_state *state;
     struct bench_timer timer;
     char *elapsed;
+    const char *level_mod_names[] = {
+        XKB_MOD_NAME_SHIFT, XKB_MOD_NAME_CAPS, "LevelThree", "LevelFive",
+    };
+    xkb_mod_mask_t level_mods[ARRAY_SIZE(level_mod_names)];
+    unsigned long lookups;
 
     ctx = test_get_context(0);
     assert(ctx);
@@ -86,8 +360,42 @@ main(void)
             BENCHMARK_ITERATIONS, elapsed);
     free(elapsed);
 
+    run_batch(keymap);
+    run_queries(keymap);
+
+    xkb_state_unref(state);
+    xkb_keymap_unref(keymap);
+
+    /* This one is full of FOUR_LEVEL_SEMIALPHABETIC and EIGHT_LEVEL_*. */
+    keymap = test_compile_rules(ctx, "evdev", "pc104", "ca", "multix", "");
+    assert(keymap);
+
+    state = xkb_state_new(keymap);
+    assert(state);
+
+    for (unsigned j = 0; j < ARRAY_SIZE(level_mod_names); j++) {
+        xkb_mod_index_t idx =
+            xkb_keymap_mod_get_index(keymap, level_mod_names[j]);
+        assert(idx != XKB_MOD_INVALID);
+        level_mods[j] = 1u << idx;
+    }
+
+    bench_timer_reset(&timer);
+
+    bench_timer_start(&timer);
+    lookups = bench_levels(state, level_mods, ARRAY_SIZE(level_mods));
+    bench_timer_stop(&timer);
+
+    elapsed = bench_timer_get_elapsed_time_str(&timer);
+    fprintf(stderr, "looked up %lu keys in %ss\n", lookups, elapsed);
+    free(elapsed);
+
     xkb_state_unref(state);
     xkb_keymap_unref(keymap);
+
+    run_text(ctx, XKB_KEYMAP_COMPILE_NO_FLAGS);
+    run_text(ctx, XKB_KEYMAP_COMPILE_CACHE_TEXT);
+
     xkb_context_unref(ctx);
 
     return 0;
@@ -29,6 +29,46 @@
 #include "bench.h"
 
 #define BENCHMARK_ITERATIONS 20000
+#define COLD_ITERATIONS 2000
+
+static void
+get_components(struct xkb_context *ctx, const struct xkb_rule_names *rmlvo)
+{
+    struct xkb_component_names kccgst;
+
+    assert(xkb_components_from_rules(ctx, rmlvo, &kccgst));
+    free(kccgst.keycodes);
+    free(kccgst.types);
+    free(kccgst.compat);
+    free(kccgst.symbols);
+}
+
+/* In a new context each time, so that the rules file is compiled again. */
+static void
+bench_cold(const struct xkb_rule_names *rmlvo)
+{
+    struct xkb_context *ctx;
+    struct bench_timer timer;
+    char *elapsed;
+    int i;
+
+    bench_timer_reset(&timer);
+
+    bench_timer_start(&timer);
+    for (i = 0; i < COLD_ITERATIONS; i++) {
+        ctx = test_get_context(0);
+        assert(ctx);
+        xkb_context_set_log_level(ctx, XKB_LOG_LEVEL_CRITICAL);
+        get_components(ctx, rmlvo);
+        xkb_context_unref(ctx);
+    }
+    bench_timer_stop(&timer);
+
+    elapsed = bench_timer_get_elapsed_time_str(&timer);
+    fprintf(stderr, "processed %d rule files in new contexts in %ss\n",
+            COLD_ITERATIONS, elapsed);
+    free(elapsed);
+}
 
 int
 main(int argc, char *argv[])
@@ -38,7 +78,6 @@ main(int argc, char *argv[])
     struct xkb_rule_names rmlvo = {
         "evdev", "pc105", "us,il", ",", "ctrl:nocaps,grp:menu_toggle",
     };
-    struct xkb_component_names kccgst;
     struct bench_timer timer;
     char *elapsed;
 
@@ -51,20 +90,19 @@ main(int argc, char *argv[])
     bench_timer_reset(&timer);
 
     bench_timer_start(&timer);
-    for (i = 0; i < BENCHMARK_ITERATIONS; i++) {
-        assert(xkb_components_from_rules(ctx, &rmlvo, &kccgst));
-        free(kccgst.keycodes);
-        free(kccgst.types);
-        free(kccgst.compat);
-        free(kccgst.symbols);
-    }
+    for (i = 0; i < BENCHMARK_ITERATIONS; i++)
+        get_components(ctx, &rmlvo);
     bench_timer_stop(&timer);
 
     elapsed = bench_timer_get_elapsed_time_str(&timer);
     fprintf(stderr, "processed %d rule files in %ss\n",
             BENCHMARK_ITERATIONS, elapsed);
+    fprintf(stderr, "compiled rules files: %u cache hits, %u misses\n",
+            ctx->rules_cache_hits, ctx->rules_cache_misses);
     free(elapsed);
 
+    bench_cold(&rmlvo);
+
     xkb_context_unref(ctx);
     return 0;
 }
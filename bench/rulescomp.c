@@ -21,12 +21,214 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
+#include <sys/stat.h>
+#include <dirent.h>
 #include <time.h>
+#include <unistd.h>
+#include <utime.h>
 
 #include "../test/test.h"
 #include "bench.h"
+#include "context.h"
 
 #define BENCHMARK_ITERATIONS 2500
+#define COLD_ITERATIONS 200
+
+static void
+remove_cache_dir(const char *path)
+{
+    DIR *dir = opendir(path);
+    struct dirent *ent;
+
+    assert(dir);
+    while ((ent = readdir(dir))) {
+        char *entry;
+
+        if (streq(ent->d_name, ".") || streq(ent->d_name, ".."))
+            continue;
+
+        assert(asprintf(&entry, "%s/%s", path, ent->d_name) >= 0);
+        unlink(entry);
+        free(entry);
+    }
+    closedir(dir);
+    rmdir(path);
+}
+
+/* Startup with the keymap cache: the first compilation fills it. */
+static void
+bench_cache(struct xkb_context *ctx)
+{
+    char cache_dir[] = "/tmp/xkbcommon-bench-cache-XXXXXX";
+    struct xkb_keymap *keymap;
+    struct bench_timer timer;
+    char *elapsed;
+    int i;
+
+    assert(mkdtemp(cache_dir));
+    assert(xkb_context_set_keymap_cache_dir(ctx, cache_dir));
+
+    bench_timer_reset(&timer);
+
+    bench_timer_start(&timer);
+    keymap = test_compile_rules(ctx, "evdev", "evdev", "us", "", "");
+    assert(keymap);
+    xkb_keymap_unref(keymap);
+    bench_timer_stop(&timer);
+
+    elapsed = bench_timer_get_elapsed_time_str(&timer);
+    fprintf(stderr, "compiled 1 keymap with a cold cache in %ss\n", elapsed);
+    free(elapsed);
+
+    bench_timer_reset(&timer);
+
+    bench_timer_start(&timer);
+    for (i = 0; i < BENCHMARK_ITERATIONS; i++) {
+        keymap = test_compile_rules(ctx, "evdev", "evdev", "us", "", "");
+        assert(keymap);
+        xkb_keymap_unref(keymap);
+    }
+    bench_timer_stop(&timer);
+
+    elapsed = bench_timer_get_elapsed_time_str(&timer);
+    fprintf(stderr, "compiled %d keymaps with a warm cache in %ss\n",
+            BENCHMARK_ITERATIONS, elapsed);
+    free(elapsed);
+
+    xkb_context_set_keymap_cache_dir(ctx, NULL);
+    remove_cache_dir(cache_dir);
+}
+
+/* One keymap per device, all of them alive at the same time. */
+static void
+bench_shared(void)
+{
+    struct xkb_context *ctx = test_get_context(CONTEXT_SHARE_KEYMAPS);
+    struct xkb_keymap *keymaps[BENCHMARK_ITERATIONS];
+    struct bench_timer timer;
+    char *elapsed;
+    int i;
+
+    assert(ctx);
+
+    bench_timer_reset(&timer);
+
+    bench_timer_start(&timer);
+    for (i = 0; i < BENCHMARK_ITERATIONS; i++) {
+        keymaps[i] = test_compile_rules(ctx, "evdev", "evdev", "us", "", "");
+        assert(keymaps[i]);
+    }
+    bench_timer_stop(&timer);
+
+    for (i = 0; i < BENCHMARK_ITERATIONS; i++)
+        xkb_keymap_unref(keymaps[i]);
+
+    elapsed = bench_timer_get_elapsed_time_str(&timer);
+    fprintf(stderr, "created %d shared keymaps in %ss\n",
+            BENCHMARK_ITERATIONS, elapsed);
+    free(elapsed);
+
+    xkb_context_unref(ctx);
+}
+
+/*
+ * With an empty include directory searched before the real one, where
+ * each file is missing.
+ */
+static void
+bench_include_paths(void)
+{
+    static const char *const subdirs[] = {
+        "keycodes", "types", "compat", "symbols", "rules",
+    };
+    char dir[] = "/tmp/xkbcommon-bench-include-XXXXXX";
+    struct utimbuf times = { time(NULL) - 100, time(NULL) - 100 };
+    struct xkb_context *ctx;
+    struct xkb_keymap *keymap;
+    struct bench_timer timer;
+    char *elapsed, *path;
+    unsigned i;
+
+    assert(mkdtemp(dir));
+    for (i = 0; i < ARRAY_SIZE(subdirs); i++) {
+        assert(asprintf(&path, "%s/%s", dir, subdirs[i]) >= 0);
+        assert(mkdir(path, 0700) == 0);
+        assert(utime(path, &times) == 0);
+        free(path);
+    }
+
+    ctx = xkb_context_new(XKB_CONTEXT_NO_DEFAULT_INCLUDES |
+                          XKB_CONTEXT_NO_ENVIRONMENT_NAMES);
+    assert(ctx);
+    xkb_context_set_log_level(ctx, XKB_LOG_LEVEL_CRITICAL);
+    path = test_get_path("");
+    assert(xkb_context_include_path_append(ctx, dir));
+    assert(xkb_context_include_path_append(ctx, path));
+    free(path);
+
+    bench_timer_reset(&timer);
+
+    bench_timer_start(&timer);
+    for (i = 0; i < BENCHMARK_ITERATIONS; i++) {
+        keymap = test_compile_rules(ctx, "evdev", "evdev", "us", "", "");
+        assert(keymap);
+        xkb_keymap_unref(keymap);
+    }
+    bench_timer_stop(&timer);
+
+    elapsed = bench_timer_get_elapsed_time_str(&timer);
+    fprintf(stderr, "compiled %d keymaps with an extra include path in %ss\n",
+            BENCHMARK_ITERATIONS, elapsed);
+    fprintf(stderr, "include files: %u failed opens avoided, "
+            "%u directory checks\n",
+            ctx->include_opens_avoided, ctx->include_dir_checks);
+    free(elapsed);
+
+    xkb_context_unref(ctx);
+    for (i = 0; i < ARRAY_SIZE(subdirs); i++) {
+        assert(asprintf(&path, "%s/%s", dir, subdirs[i]) >= 0);
+        rmdir(path);
+        free(path);
+    }
+    rmdir(dir);
+}
+
+/*
+ * A keymap with four layouts, in a new context each time, so that all of
+ * its files are parsed.
+ */
+static void
+bench_cold(enum xkb_keymap_compile_flags flags, const char *mode)
+{
+    const struct xkb_rule_names rmlvo = {
+        "evdev", "pc105", "us,de,ru,ca", ",,,multix", "grp:alts_toggle",
+    };
+    struct xkb_context *ctx;
+    struct xkb_keymap *keymap;
+    struct bench_timer timer;
+    char *elapsed;
+    int i;
+
+    bench_timer_reset(&timer);
+
+    bench_timer_start(&timer);
+    for (i = 0; i < COLD_ITERATIONS; i++) {
+        ctx = test_get_context(0);
+        assert(ctx);
+        xkb_context_set_log_level(ctx, XKB_LOG_LEVEL_CRITICAL);
+        keymap = xkb_keymap_new_from_names(ctx, &rmlvo, flags);
+        assert(keymap);
+        xkb_keymap_unref(keymap);
+        xkb_context_unref(ctx);
+    }
+    bench_timer_stop(&timer);
+
+    elapsed = bench_timer_get_elapsed_time_str(&timer);
+    fprintf(stderr, "compiled %d four-layout keymaps in new contexts in "
+            "%ss (%s, %ld CPUs)\n",
+            COLD_ITERATIONS, elapsed, mode, sysconf(_SC_NPROCESSORS_ONLN));
+    free(elapsed);
+}
 
 int
 main(int argc, char *argv[])
@@ -56,8 +258,18 @@ main(int argc, char *argv[])
     elapsed = bench_timer_get_elapsed_time_str(&timer);
     fprintf(stderr, "compiled %d keymaps in %ss\n",
             BENCHMARK_ITERATIONS, elapsed);
+    fprintf(stderr, "parsed include files: %u cache hits, %u misses\n",
+            ctx->parsed_file_hits, ctx->parsed_file_misses);
+    fprintf(stderr, "parsed %u AST allocations in %u arena chunks\n",
+            ctx->ast_allocs, ctx->ast_chunks);
     free(elapsed);
 
+    bench_cache(ctx);
+    bench_shared();
+    bench_include_paths();
+    bench_cold(XKB_KEYMAP_COMPILE_NO_FLAGS, "serial");
+    bench_cold(XKB_KEYMAP_COMPILE_PARALLEL, "parallel");
+
     xkb_context_unref(ctx);
     return 0;
 }
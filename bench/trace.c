@@ -0,0 +1,515 @@
+/*
+ * Copyright © 2026 libxkbcommon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Replays recorded key event traces, from bench/traces, and reports the
+ * time taken by each kind of operation a client does per key event.
+ *
+ * The trace format is line based; '#' starts a comment.
+ *
+ *     keymap RULES MODEL LAYOUT VARIANT OPTIONS
+ *     compose LOCALE
+ *     +LFSH AC01 -LFSH
+ *
+ * The keymap line is required, and "-" stands for an empty RMLVO field.
+ * The compose line is optional, and feeds every pressed key to a compose
+ * state using the test data table for LOCALE.  Events are key names, with
+ * '+' for a press, '-' for a release, and nothing for both.
+ *
+ * Usage: trace [--json] [--iterations N] [TRACE...]
+ *
+ * A TRACE is either a path, or the name of a trace in bench/traces.  By
+ * default, all the traces are replayed.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "xkbcommon/xkbcommon-compose.h"
+
+#include "../test/test.h"
+#include "darray.h"
+
+#define DEFAULT_ITERATIONS 2000
+
+static const char *default_traces[] = {
+    "prose", "shortcuts", "layouts", "latch-lock", "compose",
+};
+
+enum op {
+    OP_UPDATE_KEY,
+    OP_GET_UTF8,
+    OP_SERIALIZE_MODS,
+    OP_CONSUMED_MODS,
+    OP_COMPOSE_FEED,
+    _OP_NUM_ENTRIES
+};
+
+static const char *op_names[_OP_NUM_ENTRIES] = {
+    [OP_UPDATE_KEY] = "update_key",
+    [OP_GET_UTF8] = "get_utf8",
+    [OP_SERIALIZE_MODS] = "serialize_mods",
+    [OP_CONSUMED_MODS] = "consumed_mods",
+    [OP_COMPOSE_FEED] = "compose_feed",
+};
+
+struct trace_event {
+    xkb_keycode_t keycode;
+    enum xkb_key_direction direction;
+};
+
+struct trace {
+    char *name;
+    char *rmlvo[5];
+    char *compose_locale;
+    darray(char *) key_names;
+    darray(bool) presses;
+    darray(struct trace_event) events;
+};
+
+typedef darray(uint32_t) darray_uint32;
+
+struct op_stats {
+    darray_uint32 samples;
+};
+
+static uint64_t
+now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static int
+compare_samples(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *) a, y = *(const uint32_t *) b;
+
+    return (x > y) - (x < y);
+}
+
+/* The cost of taking a timestamp, subtracted from every sample. */
+static uint32_t
+calibrate_timer(void)
+{
+    uint32_t samples[10001];
+
+    for (unsigned i = 0; i < ARRAY_SIZE(samples); i++) {
+        uint64_t start = now_ns();
+        samples[i] = now_ns() - start;
+    }
+
+    qsort(samples, ARRAY_SIZE(samples), sizeof(*samples), compare_samples);
+    return samples[ARRAY_SIZE(samples) / 2];
+}
+
+static char *
+trace_path(const char *name)
+{
+    const char *srcdir;
+    char *path;
+
+    if (strchr(name, '/'))
+        return strdup(name);
+
+    srcdir = getenv("top_srcdir");
+    if (!srcdir)
+        srcdir = ".";
+
+    if (asprintf(&path, "%s/bench/traces/%s.trace", srcdir, name) < 0)
+        return NULL;
+
+    return path;
+}
+
+static void
+trace_free(struct trace *trace)
+{
+    char **key_name;
+
+    free(trace->name);
+    for (unsigned i = 0; i < ARRAY_SIZE(trace->rmlvo); i++)
+        free(trace->rmlvo[i]);
+    free(trace->compose_locale);
+    darray_foreach(key_name, trace->key_names)
+        free(*key_name);
+    darray_free(trace->key_names);
+    darray_free(trace->presses);
+    darray_free(trace->events);
+}
+
+static bool
+trace_parse(struct trace *trace, const char *name)
+{
+    char *path, *line = NULL;
+    size_t line_size = 0;
+    unsigned line_num = 0;
+    FILE *file;
+
+    path = trace_path(name);
+    if (!path)
+        return false;
+
+    file = fopen(path, "r");
+    if (!file) {
+        perror(path);
+        free(path);
+        return false;
+    }
+
+    trace->name = strdup(name);
+
+    while (getline(&line, &line_size, file) >= 0) {
+        char *comment, *token, *saveptr = NULL;
+
+        line_num++;
+
+        comment = strchr(line, '#');
+        if (comment)
+            *comment = '\0';
+
+        token = strtok_r(line, " \t\n", &saveptr);
+        if (!token)
+            continue;
+
+        if (streq(token, "keymap")) {
+            for (unsigned i = 0; i < ARRAY_SIZE(trace->rmlvo); i++) {
+                token = strtok_r(NULL, " \t\n", &saveptr);
+                if (!token)
+                    goto err_syntax;
+                trace->rmlvo[i] = streq(token, "-") ? NULL : strdup(token);
+            }
+            continue;
+        }
+
+        if (streq(token, "compose")) {
+            token = strtok_r(NULL, " \t\n", &saveptr);
+            if (!token)
+                goto err_syntax;
+            trace->compose_locale = strdup(token);
+            continue;
+        }
+
+        for (; token; token = strtok_r(NULL, " \t\n", &saveptr)) {
+            bool press = token[0] != '-', release = token[0] != '+';
+            const char *key_name = token + (token[0] == '+' || token[0] == '-');
+
+            if (press) {
+                darray_append(trace->key_names, strdup(key_name));
+                darray_append(trace->presses, true);
+            }
+            if (release) {
+                darray_append(trace->key_names, strdup(key_name));
+                darray_append(trace->presses, false);
+            }
+        }
+    }
+
+    free(line);
+    fclose(file);
+    free(path);
+    return true;
+
+err_syntax:
+    fprintf(stderr, "%s:%u: syntax error\n", path, line_num);
+    free(line);
+    fclose(file);
+    free(path);
+    return false;
+}
+
+/* Resolves the key names of the trace, once the keymap is known. */
+static bool
+trace_resolve(struct trace *trace, struct xkb_keymap *keymap)
+{
+    for (unsigned i = 0; i < darray_size(trace->key_names); i++) {
+        const char *key_name = darray_item(trace->key_names, i);
+        struct trace_event event;
+
+        event.keycode = xkb_keymap_key_by_name(keymap, key_name);
+        if (event.keycode == XKB_KEYCODE_INVALID) {
+            fprintf(stderr, "%s: unknown key %s\n", trace->name, key_name);
+            return false;
+        }
+
+        event.direction = darray_item(trace->presses, i) ?
+                          XKB_KEY_DOWN : XKB_KEY_UP;
+        darray_append(trace->events, event);
+    }
+
+    return true;
+}
+
+#define TIME_OP(stats, op, overhead, expr) do { \
+    uint64_t start_ = now_ns(), elapsed_; \
+    (expr); \
+    elapsed_ = now_ns() - start_; \
+    darray_append((stats)[op].samples, \
+                  elapsed_ > (overhead) ? elapsed_ - (overhead) : 0); \
+} while (0)
+
+static void
+replay(const struct trace *trace, struct xkb_keymap *keymap,
+       struct xkb_compose_table *table, struct op_stats *stats,
+       uint32_t overhead)
+{
+    struct xkb_state *state = xkb_state_new(keymap);
+    struct xkb_compose_state *compose_state = NULL;
+    const struct trace_event *event;
+    char buf[64];
+
+    assert(state);
+
+    if (table) {
+        compose_state = xkb_compose_state_new(table,
+                                              XKB_COMPOSE_STATE_NO_FLAGS);
+        assert(compose_state);
+    }
+
+    darray_foreach(event, trace->events) {
+        if (event->direction == XKB_KEY_DOWN) {
+            TIME_OP(stats, OP_GET_UTF8, overhead,
+                    xkb_state_key_get_utf8(state, event->keycode,
+                                           buf, sizeof(buf)));
+            TIME_OP(stats, OP_CONSUMED_MODS, overhead,
+                    xkb_state_key_get_consumed_mods2(state, event->keycode,
+                                                     XKB_CONSUMED_MODE_XKB));
+            if (compose_state) {
+                xkb_keysym_t sym = xkb_state_key_get_one_sym(state,
+                                                             event->keycode);
+                TIME_OP(stats, OP_COMPOSE_FEED, overhead,
+                        xkb_compose_state_feed(compose_state, sym));
+            }
+        }
+
+        TIME_OP(stats, OP_UPDATE_KEY, overhead,
+                xkb_state_update_key(state, event->keycode,
+                                     event->direction));
+        TIME_OP(stats, OP_SERIALIZE_MODS, overhead,
+                xkb_state_serialize_mods(state, XKB_STATE_MODS_EFFECTIVE));
+    }
+
+    xkb_compose_state_unref(compose_state);
+    xkb_state_unref(state);
+}
+
+static uint32_t
+percentile(const darray_uint32 *samples, unsigned p)
+{
+    size_t n = darray_size(*samples);
+    return darray_item(*samples, MIN(n - 1, n * p / 100));
+}
+
+static void
+report(const struct trace *trace, int iterations, struct op_stats *stats,
+       bool json, bool first)
+{
+    /* The ops written to the JSON output so far. */
+    unsigned int n = 0;
+
+    fprintf(stderr, "%s: %u events, %d iterations\n",
+            trace->name, darray_size(trace->events), iterations);
+
+    if (json)
+        printf("%s\n    {\"name\": \"%s\", \"events\": %u, \"iterations\": %d, "
+               "\"ops\": {", first ? "" : ",", trace->name,
+               darray_size(trace->events), iterations);
+
+    for (enum op op = 0; op < _OP_NUM_ENTRIES; op++) {
+        darray_uint32 *samples = &stats[op].samples;
+        uint64_t total = 0;
+        uint32_t *sample;
+        double mean;
+
+        if (darray_empty(*samples))
+            continue;
+
+        darray_foreach(sample, *samples)
+            total += *sample;
+        mean = (double) total / darray_size(*samples);
+
+        qsort(samples->item, darray_size(*samples),
+              sizeof(uint32_t), compare_samples);
+
+        fprintf(stderr, "  %-15s %9u ops %8.1f ns/op  "
+                "p50 %5u  p90 %5u  p99 %6u  max %8u ns\n",
+                op_names[op], darray_size(*samples), mean,
+                percentile(samples, 50), percentile(samples, 90),
+                percentile(samples, 99), darray_item(*samples,
+                                                     darray_size(*samples) - 1));
+
+        if (json)
+            printf("%s\n        \"%s\": {\"count\": %u, \"mean_ns\": %.1f, "
+                   "\"p50_ns\": %u, \"p90_ns\": %u, \"p99_ns\": %u, "
+                   "\"max_ns\": %u}",
+                   n++ ? "," : "", op_names[op], darray_size(*samples), mean,
+                   percentile(samples, 50), percentile(samples, 90),
+                   percentile(samples, 99),
+                   darray_item(*samples, darray_size(*samples) - 1));
+    }
+
+    if (json)
+        printf("\n    }}");
+}
+
+static bool
+run_trace(struct xkb_context *ctx, const char *name, int iterations,
+          uint32_t overhead, bool json, bool first)
+{
+    struct trace trace = { 0 };
+    struct xkb_rule_names rmlvo;
+    struct xkb_keymap *keymap = NULL;
+    struct xkb_compose_table *table = NULL;
+    struct op_stats stats[_OP_NUM_ENTRIES] = { { darray_new() } };
+    bool ok = false;
+
+    if (!trace_parse(&trace, name))
+        goto out;
+
+    rmlvo.rules = trace.rmlvo[0];
+    rmlvo.model = trace.rmlvo[1];
+    rmlvo.layout = trace.rmlvo[2];
+    rmlvo.variant = trace.rmlvo[3];
+    rmlvo.options = trace.rmlvo[4];
+
+    keymap = xkb_keymap_new_from_names(ctx, &rmlvo, 0);
+    if (!keymap) {
+        fprintf(stderr, "%s: failed to compile keymap\n", name);
+        goto out;
+    }
+
+    if (!trace_resolve(&trace, keymap))
+        goto out;
+
+    if (trace.compose_locale) {
+        char *rel, *path;
+        FILE *file;
+
+        if (asprintf(&rel, "compose/%s/Compose", trace.compose_locale) < 0)
+            goto out;
+        path = test_get_path(rel);
+        free(rel);
+
+        file = path ? fopen(path, "r") : NULL;
+        if (!file) {
+            perror(path);
+            free(path);
+            goto out;
+        }
+
+        table = xkb_compose_table_new_from_file(ctx, file,
+                                                trace.compose_locale,
+                                                XKB_COMPOSE_FORMAT_TEXT_V1,
+                                                XKB_COMPOSE_COMPILE_NO_FLAGS);
+        fclose(file);
+        free(path);
+        if (!table)
+            goto out;
+    }
+
+    for (int i = 0; i < iterations; i++)
+        replay(&trace, keymap, table, stats, overhead);
+
+    report(&trace, iterations, stats, json, first);
+    ok = true;
+
+out:
+    for (enum op op = 0; op < _OP_NUM_ENTRIES; op++)
+        darray_free(stats[op].samples);
+    xkb_compose_table_unref(table);
+    xkb_keymap_unref(keymap);
+    trace_free(&trace);
+    return ok;
+}
+
+static void
+usage(const char *argv0)
+{
+    fprintf(stderr, "Usage: %s [--json] [--iterations N] [TRACE...]\n",
+            argv0);
+}
+
+int
+main(int argc, char *argv[])
+{
+    struct xkb_context *ctx;
+    int iterations = DEFAULT_ITERATIONS;
+    bool json = false;
+    uint32_t overhead;
+    int first_trace, ret = 0;
+
+    for (first_trace = 1; first_trace < argc; first_trace++) {
+        if (streq(argv[first_trace], "--json")) {
+            json = true;
+        }
+        else if (streq(argv[first_trace], "--iterations") &&
+                 first_trace + 1 < argc) {
+            iterations = atoi(argv[++first_trace]);
+            if (iterations <= 0) {
+                usage(argv[0]);
+                return 2;
+            }
+        }
+        else if (argv[first_trace][0] == '-') {
+            usage(argv[0]);
+            return 2;
+        }
+        else {
+            break;
+        }
+    }
+
+    ctx = test_get_context(0);
+    assert(ctx);
+
+    xkb_context_set_log_level(ctx, XKB_LOG_LEVEL_CRITICAL);
+    xkb_context_set_log_verbosity(ctx, 0);
+
+    overhead = calibrate_timer();
+    fprintf(stderr, "timer overhead: %u ns (subtracted)\n", overhead);
+
+    if (json)
+        printf("{\"timer_overhead_ns\": %u, \"traces\": [", overhead);
+
+    if (first_trace < argc) {
+        for (int i = first_trace; i < argc; i++)
+            if (!run_trace(ctx, argv[i], iterations, overhead, json,
+                           i == first_trace))
+                ret = 1;
+    }
+    else {
+        for (unsigned i = 0; i < ARRAY_SIZE(default_traces); i++)
+            if (!run_trace(ctx, default_traces[i], iterations, overhead,
+                           json, i == 0))
+                ret = 1;
+    }
+
+    if (json)
+        printf("\n]}\n");
+
+    xkb_context_unref(ctx);
+    return ret;
+}
@@ -0,0 +1,195 @@
+/*
+ * Copyright © 2026 libxkbcommon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <stdlib.h>
+
+#include "utils.h"
+#include "arena.h"
+
+#define ARENA_MIN_CHUNK_SIZE 1024
+#define ARENA_MAX_CHUNK_SIZE (64 * 1024)
+
+/* Allocations are aligned for the most demanding of these. */
+union arena_align {
+    void *ptr;
+    int64_t i;
+    long double d;
+};
+
+struct arena_chunk {
+    struct arena_chunk *next;
+    size_t size;
+    size_t used;
+    union arena_align data[];
+};
+
+struct arena {
+    struct arena_chunk *chunks;
+    size_t next_chunk_size;
+    unsigned num_allocs;
+    unsigned num_chunks;
+};
+
+#define ARENA_ALIGN(size) \
+    (((size) + sizeof(union arena_align) - 1) & \
+     ~(sizeof(union arena_align) - 1))
+
+struct arena *
+arena_new(void)
+{
+    struct arena *arena = calloc(1, sizeof(*arena));
+    if (!arena)
+        return NULL;
+
+    arena->next_chunk_size = ARENA_MIN_CHUNK_SIZE;
+    return arena;
+}
+
+void
+arena_free(struct arena *arena)
+{
+    struct arena_chunk *chunk, *next;
+
+    if (!arena)
+        return;
+
+    for (chunk = arena->chunks; chunk; chunk = next) {
+        next = chunk->next;
+        free(chunk);
+    }
+    free(arena);
+}
+
+void *
+arena_alloc(struct arena *arena, size_t size)
+{
+    struct arena_chunk *chunk = arena->chunks;
+    void *ptr;
+
+    size = ARENA_ALIGN(size);
+
+    if (!chunk || chunk->size - chunk->used < size) {
+        size_t chunk_size = MAX(arena->next_chunk_size, size);
+
+        chunk = malloc(sizeof(*chunk) + chunk_size);
+        if (!chunk)
+            return NULL;
+
+        chunk->size = chunk_size;
+        chunk->used = 0;
+        chunk->next = arena->chunks;
+        arena->chunks = chunk;
+        arena->num_chunks++;
+
+        /* Files vary a lot in size, so start small. */
+        if (arena->next_chunk_size < ARENA_MAX_CHUNK_SIZE)
+            arena->next_chunk_size *= 2;
+    }
+
+    ptr = (char *) chunk->data + chunk->used;
+    chunk->used += size;
+    arena->num_allocs++;
+    return ptr;
+}
+
+void *
+arena_calloc(struct arena *arena, size_t size)
+{
+    void *ptr = arena_alloc(arena, size);
+    if (ptr)
+        memset(ptr, 0, size);
+    return ptr;
+}
+
+void *
+arena_realloc(struct arena *arena, void *ptr, size_t old_size,
+              size_t new_size)
+{
+    struct arena_chunk *chunk = arena->chunks;
+    void *new_ptr;
+
+    if (new_size <= old_size)
+        return ptr;
+
+    /* The last allocation can often grow in place. */
+    if (ptr && chunk &&
+        (char *) ptr + ARENA_ALIGN(old_size) ==
+            (char *) chunk->data + chunk->used &&
+        chunk->size - ((char *) ptr - (char *) chunk->data) >=
+            ARENA_ALIGN(new_size)) {
+        chunk->used = ((char *) ptr - (char *) chunk->data) +
+                      ARENA_ALIGN(new_size);
+        return ptr;
+    }
+
+    new_ptr = arena_alloc(arena, new_size);
+    if (new_ptr && ptr)
+        memcpy(new_ptr, ptr, old_size);
+    return new_ptr;
+}
+
+char *
+arena_strdup(struct arena *arena, const char *s)
+{
+    size_t len;
+    char *copy;
+
+    if (!s)
+        return NULL;
+
+    len = strlen(s) + 1;
+    copy = arena_alloc(arena, len);
+    if (copy)
+        memcpy(copy, s, len);
+    return copy;
+}
+
+void *
+arena_darray_grow(struct arena *arena, void *items, unsigned *alloc,
+                  unsigned size, size_t item_size)
+{
+    unsigned new_alloc;
+
+    if (size <= *alloc)
+        return items;
+
+    new_alloc = MAX(*alloc * 2, MAX(size, 4u));
+    items = arena_realloc(arena, items, *alloc * item_size,
+                          new_alloc * item_size);
+    if (items)
+        *alloc = new_alloc;
+    return items;
+}
+
+unsigned
+arena_num_allocs(const struct arena *arena)
+{
+    return arena->num_allocs;
+}
+
+unsigned
+arena_num_chunks(const struct arena *arena)
+{
+    return arena->num_chunks;
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright © 2026 libxkbcommon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef ARENA_H
+#define ARENA_H
+
+/*
+ * A simple region allocator: allocations are carved out of larger chunks,
+ * and are never freed individually, only all at once with the arena.  This
+ * suits data with a shared lifetime, made of many small objects, like the
+ * AST of a parsed file.
+ */
+
+struct arena;
+
+struct arena *
+arena_new(void);
+
+void
+arena_free(struct arena *arena);
+
+/* Returns memory suitably aligned for any type, or NULL. */
+void *
+arena_alloc(struct arena *arena, size_t size);
+
+void *
+arena_calloc(struct arena *arena, size_t size);
+
+/*
+ * Move an allocation of @old_size bytes to one of @new_size bytes.  The old
+ * allocation isn't reclaimed until the arena is freed.
+ */
+void *
+arena_realloc(struct arena *arena, void *ptr, size_t old_size,
+              size_t new_size);
+
+char *
+arena_strdup(struct arena *arena, const char *s);
+
+/*
+ * Append to a darray whose items are in the arena.  Such a darray can be
+ * read with the usual darray macros, but must not be freed or resized
+ * with them.
+ */
+#define arena_darray_append(arena, arr, ...) do { \
+    void *__items = arena_darray_grow((arena), (arr).item, &(arr).alloc, \
+                                      (arr).size + 1, sizeof(*(arr).item)); \
+    if (__items) { \
+        (arr).item = __items; \
+        (arr).item[(arr).size++] = (__VA_ARGS__); \
+    } \
+} while (0)
+
+/* Returns the items, moved if needed to hold @size of them, or NULL. */
+void *
+arena_darray_grow(struct arena *arena, void *items, unsigned *alloc,
+                  unsigned size, size_t item_size);
+
+/* How many allocations and chunks the arena has made. */
+unsigned
+arena_num_allocs(const struct arena *arena);
+
+unsigned
+arena_num_chunks(const struct arena *arena);
+
+#endif
@@ -70,21 +70,74 @@
  *
  ********************************************************/
 
+
+#ifdef HAVE_PTHREADS
+#include <pthread.h>
+#endif
+
 #include "utils.h"
 #include "atom.h"
 
 struct atom_node {
     xkb_atom_t left, right;
-    xkb_atom_t atom;
     unsigned int fingerprint;
     char *string;
 };
 
+struct atom_nodes {
+    xkb_atom_t capacity;
+    struct atom_node item[];
+};
+
+/*
+ * The table may be searched without a lock while another thread adds to
+ * it.  A node is complete before it is linked into the tree, and the links,
+ * the size and the nodes array are accessed atomically.  Adding takes the
+ * lock, and when the array is full it is copied to a bigger one; the old
+ * array is kept, unchanged from then on, for the threads still searching
+ * it, which then just don't see the newer atoms.
+ */
 struct atom_table {
     xkb_atom_t root;
-    darray(struct atom_node) table;
+    /* The number of nodes, including the throw-away one at atom 0. */
+    xkb_atom_t size;
+    struct atom_nodes *nodes;
+    darray(struct atom_nodes *) retired;
+#ifdef HAVE_PTHREADS
+    pthread_mutex_t lock;
+#endif
 };
 
+#ifdef HAVE_PTHREADS
+static inline void
+atom_table_lock(struct atom_table *table)
+{
+    pthread_mutex_lock(&table->lock);
+}
+
+static inline void
+atom_table_unlock(struct atom_table *table)
+{
+    pthread_mutex_unlock(&table->lock);
+}
+#else
+static inline void atom_table_lock(struct atom_table *table) {}
+static inline void atom_table_unlock(struct atom_table *table) {}
+#endif
+
+static struct atom_nodes *
+atom_nodes_new(xkb_atom_t capacity)
+{
+    struct atom_nodes *nodes;
+
+    nodes = calloc(1, sizeof(*nodes) + capacity * sizeof(nodes->item[0]));
+    if (!nodes)
+        return NULL;
+
+    nodes->capacity = capacity;
+    return nodes;
+}
+
 struct atom_table *
 atom_table_new(void)
 {
@@ -94,9 +147,18 @@ atom_table_new(void)
     if (!table)
         return NULL;
 
-    darray_init(table->table);
     /* The original throw-away root is here, at the illegal atom 0. */
-    darray_resize0(table->table, 1);
+    table->nodes = atom_nodes_new(256);
+    if (!table->nodes) {
+        free(table);
+        return NULL;
+    }
+    table->size = 1;
+    darray_init(table->retired);
+
+#ifdef HAVE_PTHREADS
+    pthread_mutex_init(&table->lock, NULL);
+#endif
 
     return table;
 }
@@ -104,31 +166,40 @@ atom_table_new(void)
 void
 atom_table_free(struct atom_table *table)
 {
-    struct atom_node *node;
+    struct atom_nodes **nodes;
 
     if (!table)
         return;
 
-    darray_foreach(node, table->table)
-        free(node->string);
-    darray_free(table->table);
+    for (xkb_atom_t atom = 1; atom < table->size; atom++)
+        free(table->nodes->item[atom].string);
+    free(table->nodes);
+    darray_foreach(nodes, table->retired)
+        free(*nodes);
+    darray_free(table->retired);
+#ifdef HAVE_PTHREADS
+    pthread_mutex_destroy(&table->lock);
+#endif
     free(table);
 }
 
 const char *
 atom_text(struct atom_table *table, xkb_atom_t atom)
 {
-    if (atom == XKB_ATOM_NONE || atom >= darray_size(table->table))
+    /* The nodes array is at least as recent as the size. */
+    if (atom == XKB_ATOM_NONE || atom >= xkb_atomic_load(&table->size))
         return NULL;
 
-    return darray_item(table->table, atom).string;
+    return xkb_atomic_load(&table->nodes)->item[atom].string;
 }
 
 static bool
 find_atom_pointer(struct atom_table *table, const char *string, size_t len,
                   xkb_atom_t **atomp_out, unsigned int *fingerprint_out)
 {
+    struct atom_nodes *nodes = xkb_atomic_load(&table->nodes);
     xkb_atom_t *atomp = &table->root;
+    xkb_atom_t atom;
     unsigned int fingerprint = 0;
     bool found = false;
 
@@ -137,8 +208,8 @@ find_atom_pointer(struct atom_table *table, const char *string, size_t len,
         fingerprint = fingerprint * 27 + string[len - 1 - i];
     }
 
-    while (*atomp != XKB_ATOM_NONE) {
-        struct atom_node *node = &darray_item(table->table, *atomp);
+    while ((atom = xkb_atomic_load(atomp)) != XKB_ATOM_NONE) {
+        struct atom_node *node = &nodes->item[atom];
 
         if (fingerprint < node->fingerprint) {
             atomp = &node->left;
@@ -180,7 +251,29 @@ atom_lookup(struct atom_table *table, const char *string, size_t len)
     if (!find_atom_pointer(table, string, len, &atomp, NULL))
         return XKB_ATOM_NONE;
 
-    return *atomp;
+    return xkb_atomic_load(atomp);
+}
+
+/* Makes room for one more node; the lock must be held. */
+static bool
+grow_nodes(struct atom_table *table)
+{
+    struct atom_nodes *nodes = table->nodes, *new_nodes;
+
+    if (table->size < nodes->capacity)
+        return true;
+    if (nodes->capacity > UINT32_MAX / 2)
+        return false;
+
+    new_nodes = atom_nodes_new(nodes->capacity * 2);
+    if (!new_nodes)
+        return false;
+
+    memcpy(new_nodes->item, nodes->item,
+           nodes->capacity * sizeof(nodes->item[0]));
+    darray_append(table->retired, nodes);
+    xkb_atomic_store(&table->nodes, new_nodes);
+    return true;
 }
 
 /*
@@ -193,33 +286,52 @@ atom_intern(struct atom_table *table, const char *string, size_t len,
             bool steal)
 {
     xkb_atom_t *atomp;
-    struct atom_node node;
+    xkb_atom_t atom = XKB_ATOM_NONE;
+    struct atom_node *node;
     unsigned int fingerprint;
 
     if (!string)
         return XKB_ATOM_NONE;
 
-    if (find_atom_pointer(table, string, len, &atomp, &fingerprint)) {
+    if (find_atom_pointer(table, string, len, &atomp, NULL)) {
         if (steal)
             free(UNCONSTIFY(string));
-        return *atomp;
+        return xkb_atomic_load(atomp);
+    }
+
+    atom_table_lock(table);
+
+    /* Do this before the search, as it may change the links' addresses. */
+    if (!grow_nodes(table))
+        goto out;
+
+    /* Another thread may have added it, or something else at its place. */
+    if (find_atom_pointer(table, string, len, &atomp, &fingerprint)) {
+        atom = xkb_atomic_load(atomp);
+        goto out;
     }
 
+    node = &table->nodes->item[table->size];
     if (steal) {
-        node.string = UNCONSTIFY(string);
+        node->string = UNCONSTIFY(string);
+        steal = false;
     }
     else {
-        node.string = strndup(string, len);
-        if (!node.string)
-            return XKB_ATOM_NONE;
+        node->string = strndup(string, len);
+        if (!node->string)
+            goto out;
     }
 
-    node.left = node.right = XKB_ATOM_NONE;
-    node.fingerprint = fingerprint;
-    node.atom = darray_size(table->table);
-    /* Do this before the append, as it may realloc and change the offsets. */
-    *atomp = node.atom;
-    darray_append(table->table, node);
+    node->left = node->right = XKB_ATOM_NONE;
+    node->fingerprint = fingerprint;
+    atom = table->size;
+    xkb_atomic_store(&table->size, atom + 1);
+    /* Only now may other threads find it. */
+    xkb_atomic_store(atomp, atom);
 
-    return node.atom;
+out:
+    atom_table_unlock(table);
+    if (steal)
+        free(UNCONSTIFY(string));
+    return atom;
 }
@@ -87,19 +87,35 @@ xkb_log(struct xkb_context *ctx, enum xkb_log_level level, int verbosity,
     va_end(args);
 }
 
+#ifdef HAVE_PTHREADS
+/* Shared by the thread safe contexts, which a thread uses one at a time. */
+static __thread struct context_scratch thread_scratch;
+#endif
+
+struct context_scratch *
+xkb_context_get_scratch(struct xkb_context *ctx)
+{
+#ifdef HAVE_PTHREADS
+    if (ctx->thread_safe)
+        return &thread_scratch;
+#endif
+    return &ctx->scratch;
+}
+
 char *
 xkb_context_get_buffer(struct xkb_context *ctx, size_t size)
 {
+    struct context_scratch *scratch = xkb_context_get_scratch(ctx);
     char *rtrn;
 
-    if (size >= sizeof(ctx->text_buffer))
+    if (size >= sizeof(scratch->text_buffer))
         return NULL;
 
-    if (sizeof(ctx->text_buffer) - ctx->text_next <= size)
-        ctx->text_next = 0;
+    if (sizeof(scratch->text_buffer) - scratch->text_next <= size)
+        scratch->text_next = 0;
 
-    rtrn = &ctx->text_buffer[ctx->text_next];
-    ctx->text_next += size;
+    rtrn = &scratch->text_buffer[scratch->text_next];
+    scratch->text_next += size;
 
     return rtrn;
 }
@@ -62,6 +62,7 @@ xkb_context_include_path_append(struct xkb_context *ctx, const char *path)
 #endif
 
     darray_append(ctx->includes, tmp);
+    xkb_context_forget_shared_keymaps(ctx);
     return 1;
 
 err:
@@ -113,6 +114,39 @@ xkb_context_include_path_clear(struct xkb_context *ctx)
     darray_foreach(path, ctx->failed_includes)
         free(*path);
     darray_free(ctx->failed_includes);
+
+    xkb_context_forget_shared_keymaps(ctx);
+}
+
+void
+xkb_context_forget_shared_keymaps(struct xkb_context *ctx)
+{
+    struct shared_keymap *shared;
+
+    xkb_context_lock(ctx);
+    darray_foreach(shared, ctx->shared_keymaps)
+        free(shared->key);
+    darray_free(ctx->shared_keymaps);
+    xkb_context_unlock(ctx);
+}
+
+void
+xkb_context_begin_compile(struct xkb_context *ctx)
+{
+    xkb_context_lock(ctx);
+    ctx->compiles++;
+    xkb_context_unlock(ctx);
+}
+
+void
+xkb_context_end_compile(struct xkb_context *ctx)
+{
+    xkb_context_lock(ctx);
+    if (--ctx->compiles == 0) {
+        parsed_file_cache_free_retired(ctx->parsed_files);
+        rules_cache_free_retired(ctx->compiled_rules);
+    }
+    xkb_context_unlock(ctx);
 }
 
 /**
@@ -147,13 +181,35 @@ xkb_context_include_path_get(struct xkb_context *ctx, unsigned int idx)
     return darray_item(ctx->includes, idx);
 }
 
+XKB_EXPORT int
+xkb_context_set_keymap_cache_dir(struct xkb_context *ctx, const char *path)
+{
+    struct stat stat_buf;
+    char *tmp = NULL;
+
+    if (path) {
+        if (stat(path, &stat_buf) != 0 || !S_ISDIR(stat_buf.st_mode)) {
+            log_err_func(ctx, "not a directory: %s\n", path);
+            return 0;
+        }
+
+        tmp = strdup(path);
+        if (!tmp)
+            return 0;
+    }
+
+    free(ctx->keymap_cache_dir);
+    ctx->keymap_cache_dir = tmp;
+    return 1;
+}
+
 /**
  * Take a new reference on the context.
  */
 XKB_EXPORT struct xkb_context *
 xkb_context_ref(struct xkb_context *ctx)
 {
-    ctx->refcnt++;
+    xkb_atomic_inc(&ctx->refcnt);
     return ctx;
 }
 
@@ -164,11 +220,34 @@ xkb_context_ref(struct xkb_context *ctx)
 XKB_EXPORT void
 xkb_context_unref(struct xkb_context *ctx)
 {
-    if (!ctx || --ctx->refcnt > 0)
+    if (!ctx || xkb_atomic_dec(&ctx->refcnt) > 0)
         return;
 
+    if (ctx->parsed_file_hits || ctx->parsed_file_misses)
+        log_dbg(ctx, "Parsed include files: %u cache hits, %u misses\n",
+                ctx->parsed_file_hits, ctx->parsed_file_misses);
+
+    if (ctx->rules_cache_hits || ctx->rules_cache_misses)
+        log_dbg(ctx, "Compiled rules files: %u cache hits, %u misses\n",
+                ctx->rules_cache_hits, ctx->rules_cache_misses);
+
+    if (ctx->include_opens_avoided)
+        log_dbg(ctx, "Include files: %u failed opens avoided, "
+                "%u directory checks\n",
+                ctx->include_opens_avoided, ctx->include_dir_checks);
+
     xkb_context_include_path_clear(ctx);
+    include_dir_cache_free(ctx->include_dirs);
+    parsed_file_cache_free(ctx->parsed_files);
+    rules_cache_free(ctx->compiled_rules);
     atom_table_free(ctx->atom_table);
+    free(ctx->keymap_cache_dir);
+#ifdef HAVE_PTHREADS
+    if (ctx->lock) {
+        pthread_mutex_destroy(ctx->lock);
+        free(ctx->lock);
+    }
+#endif
     free(ctx);
 }
 
@@ -273,6 +352,24 @@ xkb_context_new(enum xkb_context_flags flags)
     }
 
     ctx->use_environment_names = !(flags & XKB_CONTEXT_NO_ENVIRONMENT_NAMES);
+    ctx->share_keymaps = !!(flags & XKB_CONTEXT_SHARE_KEYMAPS);
+
+    if (flags & XKB_CONTEXT_THREAD_SAFE) {
+#ifdef HAVE_PTHREADS
+        ctx->lock = malloc(sizeof(*ctx->lock));
+        if (!ctx->lock) {
+            xkb_context_unref(ctx);
+            return NULL;
+        }
+        pthread_mutex_init(ctx->lock, NULL);
+        ctx->thread_safe = true;
+#else
+        log_err(ctx, "%s: built without threads\n",
+                "XKB_CONTEXT_THREAD_SAFE");
+        xkb_context_unref(ctx);
+        return NULL;
+#endif
+    }
 
     ctx->atom_table = atom_table_new();
     if (!ctx->atom_table) {
@@ -26,8 +26,33 @@
 #ifndef CONTEXT_H
 #define CONTEXT_H
 
+#ifdef HAVE_PTHREADS
+#include <pthread.h>
+#endif
+
 #include "atom.h"
 
+/*
+ * The state of what a thread is doing with the context; with
+ * XKB_CONTEXT_THREAD_SAFE, each thread has its own.
+ */
+struct context_scratch {
+    /* Buffer for the *Text() functions. */
+    char text_buffer[2048];
+    size_t text_next;
+
+    /* The files looked up while compiling a keymap to be cached. */
+    struct keymap_cache_deps *keymap_cache_deps;
+};
+
+/* A keymap which xkb_keymap_new_from_names() may return again. */
+struct shared_keymap {
+    struct xkb_keymap *keymap;
+    /* The names and compile flags it was created from. */
+    char *key;
+    size_t key_len;
+};
+
 struct xkb_context {
     int refcnt;
 
@@ -45,11 +70,51 @@ struct xkb_context {
 
     struct atom_table *atom_table;
 
-    /* Buffer for the *Text() functions. */
-    char text_buffer[2048];
-    size_t text_next;
+    /* Unless thread_safe is set, see xkb_context_get_scratch(). */
+    struct context_scratch scratch;
 
     unsigned int use_environment_names : 1;
+    unsigned int share_keymaps : 1;
+    unsigned int thread_safe : 1;
+
+#ifdef HAVE_PTHREADS
+    /*
+     * With XKB_CONTEXT_THREAD_SAFE, held around the accesses to the caches
+     * and counters below; NULL otherwise.
+     */
+    pthread_mutex_t *lock;
+#endif
+
+    /*
+     * With XKB_CONTEXT_SHARE_KEYMAPS, the live keymaps created from names.
+     * These are weak references: a keymap removes itself when freed.
+     */
+    darray(struct shared_keymap) shared_keymaps;
+
+    /* See xkb_context_set_keymap_cache_dir(). */
+    char *keymap_cache_dir;
+
+    /* See FindFileInXkbPath(). */
+    struct include_dir_cache *include_dirs;
+    unsigned int include_dir_checks;
+    unsigned int include_opens_avoided;
+
+    /* See xkb_context_begin_compile(). */
+    unsigned int compiles;
+
+    /* See ProcessIncludeFile(). */
+    struct parsed_file_cache *parsed_files;
+    unsigned int parsed_file_hits;
+    unsigned int parsed_file_misses;
+
+    /* See xkb_components_from_rules(). */
+    struct rules_cache *compiled_rules;
+    unsigned int rules_cache_hits;
+    unsigned int rules_cache_misses;
+
+    /* The AST nodes parsed, and the arena chunks allocated for them. */
+    unsigned int ast_allocs;
+    unsigned int ast_chunks;
 };
 
 unsigned int
@@ -84,9 +149,31 @@ xkb_atom_steal(struct xkb_context *ctx, char *string);
 const char *
 xkb_atom_text(struct xkb_context *ctx, xkb_atom_t atom);
 
+struct context_scratch *
+xkb_context_get_scratch(struct xkb_context *ctx);
+
 char *
 xkb_context_get_buffer(struct xkb_context *ctx, size_t size);
 
+#ifdef HAVE_PTHREADS
+static inline void
+xkb_context_lock(struct xkb_context *ctx)
+{
+    if (ctx->lock)
+        pthread_mutex_lock(ctx->lock);
+}
+
+static inline void
+xkb_context_unlock(struct xkb_context *ctx)
+{
+    if (ctx->lock)
+        pthread_mutex_unlock(ctx->lock);
+}
+#else
+static inline void xkb_context_lock(struct xkb_context *ctx) {}
+static inline void xkb_context_unlock(struct xkb_context *ctx) {}
+#endif
+
 ATTR_PRINTF(4, 5) void
 xkb_log(struct xkb_context *ctx, enum xkb_log_level level, int verbosity,
         const char *fmt, ...);
@@ -95,6 +182,41 @@ void
 xkb_context_sanitize_rule_names(struct xkb_context *ctx,
                                 struct xkb_rule_names *rmlvo);
 
+/*
+ * Stop returning the current shared keymaps, e.g. because they were
+ * compiled with other include paths.  They stay valid.
+ */
+void
+xkb_context_forget_shared_keymaps(struct xkb_context *ctx);
+
+/*
+ * Around the uses of the cached ASTs and rules.  The entries replaced in
+ * the caches may still be used by other compiles, so they are only freed
+ * when the last one ends.
+ */
+void
+xkb_context_begin_compile(struct xkb_context *ctx);
+
+void
+xkb_context_end_compile(struct xkb_context *ctx);
+
+/* Defined in xkbcomp/include.c. */
+void
+include_dir_cache_free(struct include_dir_cache *cache);
+
+void
+parsed_file_cache_free(struct parsed_file_cache *cache);
+
+void
+parsed_file_cache_free_retired(struct parsed_file_cache *cache);
+
+/* Defined in xkbcomp/rules.c. */
+void
+rules_cache_free(struct rules_cache *cache);
+
+void
+rules_cache_free_retired(struct rules_cache *cache);
+
 /*
  * The format is not part of the argument list in order to avoid the
  * "ISO C99 requires rest arguments to be used" warning when only the
@@ -0,0 +1,1007 @@
+/*
+ * Copyright © 2026 libxkbcommon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The XKB_KEYMAP_FORMAT_BINARY_V1 format.
+ *
+ * A binary keymap is a header followed by sections, each an array of
+ * fixed size records.  Everything is made of native endian 32 bit words,
+ * except the string section, and records refer to each other by index,
+ * so the data is position independent.  It is not used in place: loading
+ * copies it into a new keymap in one linear pass, without any parsing.
+ * Strings are referred to by their offset in the string section, or
+ * BINARY_NONE.
+ *
+ * Only the compiled keymap is stored; the lookup tables are rebuilt by
+ * xkb_keymap_build_texts() and xkb_keymap_finalize() when loading, since
+ * they depend on the compile flags.  Everything read is checked, a
+ * corrupt buffer must not crash.
+ */
+
+#include <errno.h>
+
+#include "keymap.h"
+
+/* "xkbB", in the byte order of the writer. */
+#define BINARY_MAGIC 0x786b6242
+#define BINARY_VERSION 1
+#define BINARY_NONE UINT32_MAX
+
+enum binary_section_index {
+    BINARY_SECTION_MODS,
+    BINARY_SECTION_TYPES,
+    BINARY_SECTION_TYPE_ENTRIES,
+    BINARY_SECTION_LEVEL_NAMES,
+    BINARY_SECTION_INTERPRETS,
+    BINARY_SECTION_LEDS,
+    BINARY_SECTION_ALIASES,
+    BINARY_SECTION_GROUP_NAMES,
+    BINARY_SECTION_KEYS,
+    BINARY_SECTION_GROUPS,
+    BINARY_SECTION_LEVELS,
+    BINARY_SECTION_KEYSYMS,
+    BINARY_SECTION_STRINGS,
+    _BINARY_SECTION_NUM_ENTRIES
+};
+
+struct binary_section {
+    /* From the start of the keymap. */
+    uint32_t offset;
+    /* In records. */
+    uint32_t count;
+};
+
+struct binary_header {
+    uint32_t magic;
+    uint32_t version;
+    /* Of the whole keymap. */
+    uint32_t size;
+    uint32_t min_key_code;
+    uint32_t max_key_code;
+    uint32_t enabled_ctrls;
+    uint32_t keycodes_section_name;
+    uint32_t types_section_name;
+    uint32_t compat_section_name;
+    uint32_t symbols_section_name;
+    struct binary_section sections[_BINARY_SECTION_NUM_ENTRIES];
+};
+
+/* type, flags, and two arguments depending on the type. */
+struct binary_action {
+    uint32_t words[4];
+};
+
+struct binary_mod {
+    uint32_t name;
+    uint32_t type;
+    uint32_t mapping;
+};
+
+struct binary_type {
+    uint32_t name;
+    uint32_t mods;
+    uint32_t mask;
+    uint32_t num_levels;
+    /* Index of the first of num_levels level names, or BINARY_NONE. */
+    uint32_t level_names;
+    uint32_t num_entries;
+    uint32_t entries;
+};
+
+struct binary_type_entry {
+    uint32_t level;
+    uint32_t mods;
+    uint32_t mask;
+    uint32_t preserve_mods;
+    uint32_t preserve_mask;
+};
+
+struct binary_interpret {
+    uint32_t sym;
+    uint32_t match;
+    uint32_t mods;
+    uint32_t virtual_mod;
+    struct binary_action action;
+    uint32_t level_one_only;
+    uint32_t repeat;
+};
+
+struct binary_led {
+    uint32_t name;
+    uint32_t which_groups;
+    uint32_t groups;
+    uint32_t which_mods;
+    uint32_t mods;
+    uint32_t mask;
+    uint32_t ctrls;
+};
+
+struct binary_alias {
+    uint32_t real;
+    uint32_t alias;
+};
+
+/* The keys from min_key_code to max_key_code, in order. */
+struct binary_key {
+    uint32_t name;
+    uint32_t explicit;
+    uint32_t modmap;
+    uint32_t vmodmap;
+    uint32_t repeats;
+    uint32_t out_of_range_group_action;
+    uint32_t out_of_range_group_number;
+    uint32_t num_groups;
+    uint32_t groups;
+};
+
+/* Followed by as many levels as the type has. */
+struct binary_group {
+    uint32_t explicit_type;
+    uint32_t type;
+    uint32_t levels;
+};
+
+struct binary_level {
+    struct binary_action action;
+    uint32_t num_syms;
+    /* The keysym if there is one, else the index of the first keysym. */
+    uint32_t syms;
+};
+
+static const size_t record_sizes[_BINARY_SECTION_NUM_ENTRIES] = {
+    [BINARY_SECTION_MODS] = sizeof(struct binary_mod),
+    [BINARY_SECTION_TYPES] = sizeof(struct binary_type),
+    [BINARY_SECTION_TYPE_ENTRIES] = sizeof(struct binary_type_entry),
+    [BINARY_SECTION_LEVEL_NAMES] = sizeof(uint32_t),
+    [BINARY_SECTION_INTERPRETS] = sizeof(struct binary_interpret),
+    [BINARY_SECTION_LEDS] = sizeof(struct binary_led),
+    [BINARY_SECTION_ALIASES] = sizeof(struct binary_alias),
+    [BINARY_SECTION_GROUP_NAMES] = sizeof(uint32_t),
+    [BINARY_SECTION_KEYS] = sizeof(struct binary_key),
+    [BINARY_SECTION_GROUPS] = sizeof(struct binary_group),
+    [BINARY_SECTION_LEVELS] = sizeof(struct binary_level),
+    [BINARY_SECTION_KEYSYMS] = sizeof(uint32_t),
+    [BINARY_SECTION_STRINGS] = 1,
+};
+
+/***====================================================================***/
+
+struct binary_writer {
+    struct xkb_keymap *keymap;
+    darray(uint32_t) sections[BINARY_SECTION_STRINGS];
+    darray_char strings;
+    /* The offset of each atom's string plus one, or 0 if not written yet. */
+    darray(uint32_t) atom_strings;
+};
+
+static uint32_t
+section_count(struct binary_writer *w, enum binary_section_index section)
+{
+    return darray_size(w->sections[section]) /
+           (record_sizes[section] / sizeof(uint32_t));
+}
+
+static void
+write_record(struct binary_writer *w, enum binary_section_index section,
+             const void *record)
+{
+    darray_append_items(w->sections[section], (const uint32_t *) record,
+                        record_sizes[section] / sizeof(uint32_t));
+}
+
+static uint32_t
+write_string(struct binary_writer *w, const char *string)
+{
+    uint32_t offset = darray_size(w->strings);
+
+    if (!string)
+        return BINARY_NONE;
+
+    darray_append_items(w->strings, string, strlen(string) + 1);
+    return offset;
+}
+
+static uint32_t
+write_atom(struct binary_writer *w, xkb_atom_t atom)
+{
+    uint32_t offset;
+
+    if (atom == XKB_ATOM_NONE)
+        return BINARY_NONE;
+
+    if (atom >= darray_size(w->atom_strings))
+        darray_resize0(w->atom_strings, atom + 1);
+
+    if (darray_item(w->atom_strings, atom) == 0) {
+        offset = write_string(w, xkb_atom_text(w->keymap->ctx, atom));
+        darray_item(w->atom_strings, atom) = offset + 1;
+    }
+
+    return darray_item(w->atom_strings, atom) - 1;
+}
+
+static struct binary_action
+write_action(const union xkb_action *action)
+{
+    struct binary_action out = { { action->type } };
+
+    switch (action->type) {
+    case ACTION_TYPE_MOD_SET:
+    case ACTION_TYPE_MOD_LATCH:
+    case ACTION_TYPE_MOD_LOCK:
+        out.words[1] = action->mods.flags;
+        out.words[2] = action->mods.mods.mods;
+        out.words[3] = action->mods.mods.mask;
+        break;
+    case ACTION_TYPE_GROUP_SET:
+    case ACTION_TYPE_GROUP_LATCH:
+    case ACTION_TYPE_GROUP_LOCK:
+        out.words[1] = action->group.flags;
+        out.words[2] = (uint32_t) action->group.group;
+        break;
+    case ACTION_TYPE_PTR_MOVE:
+        out.words[1] = action->ptr.flags;
+        out.words[2] = (uint32_t) action->ptr.x;
+        out.words[3] = (uint32_t) action->ptr.y;
+        break;
+    case ACTION_TYPE_PTR_BUTTON:
+    case ACTION_TYPE_PTR_LOCK:
+        out.words[1] = action->btn.flags;
+        out.words[2] = action->btn.count;
+        out.words[3] = action->btn.button;
+        break;
+    case ACTION_TYPE_PTR_DEFAULT:
+        out.words[1] = action->dflt.flags;
+        out.words[2] = (uint32_t) action->dflt.value;
+        break;
+    case ACTION_TYPE_SWITCH_VT:
+        out.words[1] = action->screen.flags;
+        out.words[2] = (uint32_t) action->screen.screen;
+        break;
+    case ACTION_TYPE_CTRL_SET:
+    case ACTION_TYPE_CTRL_LOCK:
+        out.words[1] = action->ctrls.flags;
+        out.words[2] = action->ctrls.ctrls;
+        break;
+    case ACTION_TYPE_NONE:
+    case ACTION_TYPE_TERMINATE:
+        break;
+    case ACTION_TYPE_PRIVATE:
+    default:
+        /* Private actions keep their own type, from ACTION_TYPE_PRIVATE. */
+        memcpy(&out.words[1], action->priv.data, sizeof(action->priv.data));
+        break;
+    }
+
+    return out;
+}
+
+static void
+write_types(struct binary_writer *w)
+{
+    const struct xkb_keymap *keymap = w->keymap;
+
+    for (unsigned i = 0; i < keymap->num_types; i++) {
+        const struct xkb_key_type *type = &keymap->types[i];
+        struct binary_type out = {
+            .name = write_atom(w, type->name),
+            .mods = type->mods.mods,
+            .mask = type->mods.mask,
+            .num_levels = type->num_levels,
+            .level_names = BINARY_NONE,
+            .num_entries = type->num_entries,
+            .entries = section_count(w, BINARY_SECTION_TYPE_ENTRIES),
+        };
+
+        for (unsigned j = 0; j < type->num_entries; j++) {
+            const struct xkb_key_type_entry *entry = &type->entries[j];
+            struct binary_type_entry entry_out = {
+                .level = entry->level,
+                .mods = entry->mods.mods,
+                .mask = entry->mods.mask,
+                .preserve_mods = entry->preserve.mods,
+                .preserve_mask = entry->preserve.mask,
+            };
+            write_record(w, BINARY_SECTION_TYPE_ENTRIES, &entry_out);
+        }
+
+        if (type->level_names) {
+            out.level_names = section_count(w, BINARY_SECTION_LEVEL_NAMES);
+            for (xkb_level_index_t j = 0; j < type->num_levels; j++) {
+                uint32_t name = write_atom(w, type->level_names[j]);
+                write_record(w, BINARY_SECTION_LEVEL_NAMES, &name);
+            }
+        }
+
+        write_record(w, BINARY_SECTION_TYPES, &out);
+    }
+}
+
+static void
+write_compat(struct binary_writer *w)
+{
+    const struct xkb_keymap *keymap = w->keymap;
+
+    for (unsigned i = 0; i < keymap->num_sym_interprets; i++) {
+        const struct xkb_sym_interpret *si = &keymap->sym_interprets[i];
+        struct binary_interpret out = {
+            .sym = si->sym,
+            .match = si->match,
+            .mods = si->mods,
+            .virtual_mod = si->virtual_mod,
+            .action = write_action(&si->action),
+            .level_one_only = si->level_one_only,
+            .repeat = si->repeat,
+        };
+        write_record(w, BINARY_SECTION_INTERPRETS, &out);
+    }
+
+    for (xkb_led_index_t i = 0; i < keymap->num_leds; i++) {
+        const struct xkb_led *led = &keymap->leds[i];
+        struct binary_led out = {
+            .name = write_atom(w, led->name),
+            .which_groups = led->which_groups,
+            .groups = led->groups,
+            .which_mods = led->which_mods,
+            .mods = led->mods.mods,
+            .mask = led->mods.mask,
+            .ctrls = led->ctrls,
+        };
+        write_record(w, BINARY_SECTION_LEDS, &out);
+    }
+}
+
+static void
+write_keys(struct binary_writer *w)
+{
+    const struct xkb_keymap *keymap = w->keymap;
+    const struct xkb_key *key;
+
+    for (unsigned i = 0; i < keymap->num_key_aliases; i++) {
+        struct binary_alias out = {
+            .real = write_atom(w, keymap->key_aliases[i].real),
+            .alias = write_atom(w, keymap->key_aliases[i].alias),
+        };
+        write_record(w, BINARY_SECTION_ALIASES, &out);
+    }
+
+    for (xkb_layout_index_t i = 0; i < keymap->num_group_names; i++) {
+        uint32_t name = write_atom(w, keymap->group_names[i]);
+        write_record(w, BINARY_SECTION_GROUP_NAMES, &name);
+    }
+
+    xkb_keys_foreach(key, keymap) {
+        struct binary_key out = {
+            .name = write_atom(w, key->name),
+            .explicit = key->explicit,
+            .modmap = key->modmap,
+            .vmodmap = key->vmodmap,
+            .repeats = key->repeats,
+            .out_of_range_group_action = key->out_of_range_group_action,
+            .out_of_range_group_number = key->out_of_range_group_number,
+            .num_groups = key->num_groups,
+            .groups = section_count(w, BINARY_SECTION_GROUPS),
+        };
+
+        for (xkb_layout_index_t i = 0; i < key->num_groups; i++) {
+            const struct xkb_group *group = &key->groups[i];
+            struct binary_group group_out = {
+                .explicit_type = group->explicit_type,
+                .type = group->type - keymap->types,
+                .levels = section_count(w, BINARY_SECTION_LEVELS),
+            };
+
+            for (xkb_level_index_t j = 0; j < XkbKeyNumLevels(key, i); j++) {
+                const struct xkb_level *level = &group->levels[j];
+                struct binary_level level_out = {
+                    .action = write_action(&level->action),
+                    .num_syms = level->num_syms,
+                };
+
+                if (level->num_syms == 1) {
+                    level_out.syms = level->u.sym;
+                }
+                else if (level->num_syms > 1) {
+                    level_out.syms = section_count(w, BINARY_SECTION_KEYSYMS);
+                    darray_append_items(w->sections[BINARY_SECTION_KEYSYMS],
+                                        level->u.syms, level->num_syms);
+                }
+
+                write_record(w, BINARY_SECTION_LEVELS, &level_out);
+            }
+
+            write_record(w, BINARY_SECTION_GROUPS, &group_out);
+        }
+
+        write_record(w, BINARY_SECTION_KEYS, &out);
+    }
+}
+
+static char *
+binary_v1_keymap_get_as_buffer(struct xkb_keymap *keymap, size_t *length)
+{
+    struct binary_writer w = { .keymap = keymap };
+    struct binary_header header = {
+        .magic = BINARY_MAGIC,
+        .version = BINARY_VERSION,
+        .min_key_code = keymap->min_key_code,
+        .max_key_code = keymap->max_key_code,
+        .enabled_ctrls = keymap->enabled_ctrls,
+    };
+    size_t size = sizeof(header);
+    char *buffer = NULL;
+
+    header.keycodes_section_name =
+        write_string(&w, keymap->keycodes_section_name);
+    header.types_section_name = write_string(&w, keymap->types_section_name);
+    header.compat_section_name =
+        write_string(&w, keymap->compat_section_name);
+    header.symbols_section_name =
+        write_string(&w, keymap->symbols_section_name);
+
+    for (xkb_mod_index_t i = 0; i < keymap->mods.num_mods; i++) {
+        const struct xkb_mod *mod = &keymap->mods.mods[i];
+        struct binary_mod out = {
+            .name = write_atom(&w, mod->name),
+            .type = mod->type,
+            .mapping = mod->mapping,
+        };
+        write_record(&w, BINARY_SECTION_MODS, &out);
+    }
+
+    write_types(&w);
+    write_compat(&w);
+    write_keys(&w);
+
+    for (unsigned i = 0; i < BINARY_SECTION_STRINGS; i++) {
+        header.sections[i].offset = size;
+        header.sections[i].count = section_count(&w, i);
+        size += darray_size(w.sections[i]) * sizeof(uint32_t);
+    }
+    header.sections[BINARY_SECTION_STRINGS].offset = size;
+    header.sections[BINARY_SECTION_STRINGS].count = darray_size(w.strings);
+    size += darray_size(w.strings);
+
+    if (size > UINT32_MAX) {
+        log_err(keymap->ctx, "Keymap too large for the binary format\n");
+        goto out;
+    }
+    header.size = size;
+
+    buffer = malloc(size);
+    if (!buffer)
+        goto out;
+
+    memcpy(buffer, &header, sizeof(header));
+    for (unsigned i = 0; i < BINARY_SECTION_STRINGS; i++)
+        if (!darray_empty(w.sections[i]))
+            memcpy(buffer + header.sections[i].offset, w.sections[i].item,
+                   darray_size(w.sections[i]) * sizeof(uint32_t));
+    memcpy(buffer + header.sections[BINARY_SECTION_STRINGS].offset,
+           w.strings.item, darray_size(w.strings));
+    *length = size;
+
+out:
+    for (unsigned i = 0; i < BINARY_SECTION_STRINGS; i++)
+        darray_free(w.sections[i]);
+    darray_free(w.strings);
+    darray_free(w.atom_strings);
+    return buffer;
+}
+
+/***====================================================================***/
+
+struct binary_reader {
+    struct xkb_keymap *keymap;
+    const char *data;
+    struct binary_header header;
+};
+
+#define STRINGIFY(expr) #expr
+#define FAIL_UNLESS(expr) do {                                          \
+    if (!(expr)) {                                                      \
+        log_err(r->keymap->ctx,                                         \
+                "Invalid binary keymap: unmet condition in %s(): %s\n", \
+                __func__, STRINGIFY(expr));                             \
+        return false;                                                   \
+    }                                                                   \
+} while (0)
+
+#define ALLOC_OR_FAIL(arr, nmemb) do {                                  \
+    if ((nmemb) > 0) {                                                  \
+        (arr) = calloc((nmemb), sizeof(*(arr)));                        \
+        if (!(arr))                                                     \
+            return false;                                               \
+    }                                                                   \
+} while (0)
+
+/* Whether the records first to first + count - 1 exist. */
+static bool
+has_records(const struct binary_reader *r, enum binary_section_index section,
+            uint32_t first, uint32_t count)
+{
+    const uint32_t total = r->header.sections[section].count;
+    return count <= total && first <= total - count;
+}
+
+static bool
+read_record(const struct binary_reader *r, enum binary_section_index section,
+            uint32_t index, void *record)
+{
+    const struct binary_section *s = &r->header.sections[section];
+
+    FAIL_UNLESS(index < s->count);
+    memcpy(record, r->data + s->offset + index * record_sizes[section],
+           record_sizes[section]);
+    return true;
+}
+
+static bool
+read_string(const struct binary_reader *r, uint32_t offset,
+            const char **string_out, size_t *len_out)
+{
+    const struct binary_section *s =
+        &r->header.sections[BINARY_SECTION_STRINGS];
+    const char *string, *end;
+
+    if (offset == BINARY_NONE) {
+        *string_out = NULL;
+        return true;
+    }
+
+    FAIL_UNLESS(offset < s->count);
+    string = r->data + s->offset + offset;
+    end = memchr(string, '\0', s->count - offset);
+    FAIL_UNLESS(end);
+
+    *string_out = string;
+    *len_out = end - string;
+    return true;
+}
+
+static bool
+read_atom(const struct binary_reader *r, uint32_t offset, xkb_atom_t *out)
+{
+    const char *string;
+    size_t len;
+
+    if (!read_string(r, offset, &string, &len))
+        return false;
+
+    *out = string ? xkb_atom_intern(r->keymap->ctx, string, len)
+                  : XKB_ATOM_NONE;
+    return true;
+}
+
+static bool
+read_section_name(const struct binary_reader *r, uint32_t offset, char **out)
+{
+    const char *string;
+    size_t len;
+
+    if (!read_string(r, offset, &string, &len))
+        return false;
+
+    if (string) {
+        *out = strndup(string, len);
+        if (!*out)
+            return false;
+    }
+    return true;
+}
+
+static bool
+read_action(const struct binary_reader *r, const struct binary_action *in,
+            union xkb_action *action)
+{
+    const uint32_t *words = in->words;
+
+    FAIL_UNLESS(words[0] <= UINT8_MAX);
+    action->type = words[0];
+
+    switch (action->type) {
+    case ACTION_TYPE_MOD_SET:
+    case ACTION_TYPE_MOD_LATCH:
+    case ACTION_TYPE_MOD_LOCK:
+        action->mods.flags = words[1];
+        action->mods.mods.mods = words[2];
+        action->mods.mods.mask = words[3];
+        break;
+    case ACTION_TYPE_GROUP_SET:
+    case ACTION_TYPE_GROUP_LATCH:
+    case ACTION_TYPE_GROUP_LOCK:
+        action->group.flags = words[1];
+        action->group.group = (int32_t) words[2];
+        break;
+    case ACTION_TYPE_PTR_MOVE:
+        action->ptr.flags = words[1];
+        action->ptr.x = (int16_t) words[2];
+        action->ptr.y = (int16_t) words[3];
+        break;
+    case ACTION_TYPE_PTR_BUTTON:
+    case ACTION_TYPE_PTR_LOCK:
+        action->btn.flags = words[1];
+        action->btn.count = words[2];
+        action->btn.button = words[3];
+        break;
+    case ACTION_TYPE_PTR_DEFAULT:
+        action->dflt.flags = words[1];
+        action->dflt.value = (int8_t) words[2];
+        break;
+    case ACTION_TYPE_SWITCH_VT:
+        action->screen.flags = words[1];
+        action->screen.screen = (int8_t) words[2];
+        break;
+    case ACTION_TYPE_CTRL_SET:
+    case ACTION_TYPE_CTRL_LOCK:
+        action->ctrls.flags = words[1];
+        action->ctrls.ctrls = words[2];
+        break;
+    case ACTION_TYPE_NONE:
+    case ACTION_TYPE_TERMINATE:
+        break;
+    case ACTION_TYPE_PRIVATE:
+    default:
+        memcpy(action->priv.data, &words[1], sizeof(action->priv.data));
+        break;
+    }
+
+    return true;
+}
+
+static bool
+read_mods(const struct binary_reader *r)
+{
+    struct xkb_keymap *keymap = r->keymap;
+    const uint32_t num_mods = r->header.sections[BINARY_SECTION_MODS].count;
+    struct binary_mod in;
+
+    FAIL_UNLESS(num_mods <= XKB_MAX_MODS);
+
+    for (xkb_mod_index_t i = 0; i < num_mods; i++) {
+        struct xkb_mod *mod = &keymap->mods.mods[i];
+
+        if (!read_record(r, BINARY_SECTION_MODS, i, &in) ||
+            !read_atom(r, in.name, &mod->name))
+            return false;
+        FAIL_UNLESS(in.type == MOD_REAL || in.type == MOD_VIRT);
+        mod->type = in.type;
+        mod->mapping = in.mapping;
+    }
+    keymap->mods.num_mods = num_mods;
+
+    return true;
+}
+
+static bool
+read_types(const struct binary_reader *r)
+{
+    struct xkb_keymap *keymap = r->keymap;
+    const uint32_t num_types = r->header.sections[BINARY_SECTION_TYPES].count;
+    struct binary_type in;
+
+    FAIL_UNLESS(num_types > 0);
+    ALLOC_OR_FAIL(keymap->types, num_types);
+    keymap->num_types = num_types;
+
+    for (unsigned i = 0; i < num_types; i++) {
+        struct xkb_key_type *type = &keymap->types[i];
+
+        if (!read_record(r, BINARY_SECTION_TYPES, i, &in) ||
+            !read_atom(r, in.name, &type->name))
+            return false;
+        type->mods.mods = in.mods;
+        type->mods.mask = in.mask;
+
+        /* The levels of the keys are read by the number of the type's. */
+        FAIL_UNLESS(in.num_levels > 0);
+        type->num_levels = in.num_levels;
+
+        FAIL_UNLESS(has_records(r, BINARY_SECTION_TYPE_ENTRIES,
+                                in.entries, in.num_entries));
+        ALLOC_OR_FAIL(type->entries, in.num_entries);
+        type->num_entries = in.num_entries;
+        for (unsigned j = 0; j < in.num_entries; j++) {
+            struct xkb_key_type_entry *entry = &type->entries[j];
+            struct binary_type_entry entry_in;
+
+            if (!read_record(r, BINARY_SECTION_TYPE_ENTRIES, in.entries + j,
+                             &entry_in))
+                return false;
+            FAIL_UNLESS(entry_in.level < type->num_levels);
+            entry->level = entry_in.level;
+            entry->mods.mods = entry_in.mods;
+            entry->mods.mask = entry_in.mask;
+            entry->preserve.mods = entry_in.preserve_mods;
+            entry->preserve.mask = entry_in.preserve_mask;
+        }
+
+        if (in.level_names == BINARY_NONE)
+            continue;
+
+        FAIL_UNLESS(has_records(r, BINARY_SECTION_LEVEL_NAMES,
+                                in.level_names, in.num_levels));
+        ALLOC_OR_FAIL(type->level_names, in.num_levels);
+        for (xkb_level_index_t j = 0; j < in.num_levels; j++) {
+            uint32_t name;
+
+            if (!read_record(r, BINARY_SECTION_LEVEL_NAMES,
+                             in.level_names + j, &name) ||
+                !read_atom(r, name, &type->level_names[j]))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+static bool
+read_compat(const struct binary_reader *r)
+{
+    struct xkb_keymap *keymap = r->keymap;
+    const uint32_t num_interprets =
+        r->header.sections[BINARY_SECTION_INTERPRETS].count;
+    const uint32_t num_leds = r->header.sections[BINARY_SECTION_LEDS].count;
+
+    ALLOC_OR_FAIL(keymap->sym_interprets, num_interprets);
+    keymap->num_sym_interprets = num_interprets;
+    for (unsigned i = 0; i < num_interprets; i++) {
+        struct xkb_sym_interpret *si = &keymap->sym_interprets[i];
+        struct binary_interpret in;
+
+        if (!read_record(r, BINARY_SECTION_INTERPRETS, i, &in) ||
+            !read_action(r, &in.action, &si->action))
+            return false;
+        FAIL_UNLESS(in.match <= MATCH_EXACTLY);
+        FAIL_UNLESS(in.virtual_mod == XKB_MOD_INVALID ||
+                    in.virtual_mod < keymap->mods.num_mods);
+        si->sym = in.sym;
+        si->match = in.match;
+        si->mods = in.mods;
+        si->virtual_mod = in.virtual_mod;
+        si->level_one_only = in.level_one_only;
+        si->repeat = in.repeat;
+    }
+
+    FAIL_UNLESS(num_leds <= XKB_MAX_LEDS);
+    for (xkb_led_index_t i = 0; i < num_leds; i++) {
+        struct xkb_led *led = &keymap->leds[i];
+        struct binary_led in;
+
+        if (!read_record(r, BINARY_SECTION_LEDS, i, &in) ||
+            !read_atom(r, in.name, &led->name))
+            return false;
+        led->which_groups = in.which_groups;
+        led->groups = in.groups;
+        led->which_mods = in.which_mods;
+        led->mods.mods = in.mods;
+        led->mods.mask = in.mask;
+        led->ctrls = in.ctrls;
+    }
+    keymap->num_leds = num_leds;
+
+    return true;
+}
+
+static bool
+read_level(const struct binary_reader *r, uint32_t index,
+           struct xkb_level *level)
+{
+    struct binary_level in;
+
+    if (!read_record(r, BINARY_SECTION_LEVELS, index, &in) ||
+        !read_action(r, &in.action, &level->action))
+        return false;
+
+    if (in.num_syms <= 1) {
+        level->u.sym = in.num_syms == 1 ? in.syms : XKB_KEY_NoSymbol;
+        level->num_syms = in.num_syms;
+        return true;
+    }
+
+    FAIL_UNLESS(has_records(r, BINARY_SECTION_KEYSYMS,
+                            in.syms, in.num_syms));
+    level->u.syms = malloc(in.num_syms * sizeof(*level->u.syms));
+    if (!level->u.syms)
+        return false;
+    level->num_syms = in.num_syms;
+    memcpy(level->u.syms,
+           r->data + r->header.sections[BINARY_SECTION_KEYSYMS].offset +
+           in.syms * sizeof(uint32_t),
+           in.num_syms * sizeof(*level->u.syms));
+    return true;
+}
+
+static bool
+read_key(const struct binary_reader *r, uint32_t index, struct xkb_key *key)
+{
+    struct xkb_keymap *keymap = r->keymap;
+    struct binary_key in;
+
+    if (!read_record(r, BINARY_SECTION_KEYS, index, &in) ||
+        !read_atom(r, in.name, &key->name))
+        return false;
+
+    FAIL_UNLESS(in.out_of_range_group_action <= RANGE_REDIRECT);
+    key->explicit = in.explicit;
+    key->modmap = in.modmap;
+    key->vmodmap = in.vmodmap;
+    key->repeats = in.repeats;
+    key->out_of_range_group_action = in.out_of_range_group_action;
+    key->out_of_range_group_number = in.out_of_range_group_number;
+
+    FAIL_UNLESS(in.num_groups <= XKB_MAX_GROUPS);
+    FAIL_UNLESS(has_records(r, BINARY_SECTION_GROUPS,
+                            in.groups, in.num_groups));
+    ALLOC_OR_FAIL(key->groups, in.num_groups);
+    key->num_groups = in.num_groups;
+
+    for (xkb_layout_index_t i = 0; i < in.num_groups; i++) {
+        struct xkb_group *group = &key->groups[i];
+        struct binary_group group_in;
+        const struct xkb_key_type *type;
+
+        if (!read_record(r, BINARY_SECTION_GROUPS, in.groups + i, &group_in))
+            return false;
+        FAIL_UNLESS(group_in.type < keymap->num_types);
+        type = &keymap->types[group_in.type];
+        group->explicit_type = group_in.explicit_type;
+        /* Set before the levels, xkb_keymap_unref() needs it for them. */
+        group->type = type;
+
+        FAIL_UNLESS(has_records(r, BINARY_SECTION_LEVELS,
+                                group_in.levels, type->num_levels));
+        ALLOC_OR_FAIL(group->levels, type->num_levels);
+        for (xkb_level_index_t j = 0; j < type->num_levels; j++)
+            if (!read_level(r, group_in.levels + j, &group->levels[j]))
+                return false;
+    }
+
+    keymap->num_groups = MAX(keymap->num_groups, key->num_groups);
+    return true;
+}
+
+static bool
+read_keys(const struct binary_reader *r)
+{
+    struct xkb_keymap *keymap = r->keymap;
+    const uint32_t num_aliases =
+        r->header.sections[BINARY_SECTION_ALIASES].count;
+    const uint32_t num_group_names =
+        r->header.sections[BINARY_SECTION_GROUP_NAMES].count;
+    const xkb_keycode_t min_key_code = r->header.min_key_code;
+    const xkb_keycode_t max_key_code = r->header.max_key_code;
+
+    ALLOC_OR_FAIL(keymap->key_aliases, num_aliases);
+    keymap->num_key_aliases = num_aliases;
+    for (unsigned i = 0; i < num_aliases; i++) {
+        struct binary_alias in;
+
+        if (!read_record(r, BINARY_SECTION_ALIASES, i, &in) ||
+            !read_atom(r, in.real, &keymap->key_aliases[i].real) ||
+            !read_atom(r, in.alias, &keymap->key_aliases[i].alias))
+            return false;
+    }
+
+    ALLOC_OR_FAIL(keymap->group_names, num_group_names);
+    keymap->num_group_names = num_group_names;
+    for (xkb_layout_index_t i = 0; i < num_group_names; i++) {
+        uint32_t name;
+
+        if (!read_record(r, BINARY_SECTION_GROUP_NAMES, i, &name) ||
+            !read_atom(r, name, &keymap->group_names[i]))
+            return false;
+    }
+
+    FAIL_UNLESS(min_key_code <= max_key_code &&
+                max_key_code <= XKB_KEYCODE_MAX);
+    FAIL_UNLESS(r->header.sections[BINARY_SECTION_KEYS].count ==
+                max_key_code - min_key_code + 1);
+    ALLOC_OR_FAIL(keymap->keys, max_key_code + 1);
+    keymap->min_key_code = min_key_code;
+    keymap->max_key_code = max_key_code;
+
+    for (xkb_keycode_t kc = min_key_code; kc <= max_key_code; kc++) {
+        keymap->keys[kc].keycode = kc;
+        if (!read_key(r, kc - min_key_code, &keymap->keys[kc]))
+            return false;
+    }
+
+    return true;
+}
+
+static bool
+read_header(struct binary_reader *r, size_t length)
+{
+    struct binary_header *header = &r->header;
+
+    FAIL_UNLESS(length >= sizeof(*header));
+    memcpy(header, r->data, sizeof(*header));
+
+    FAIL_UNLESS(header->magic == BINARY_MAGIC);
+    FAIL_UNLESS(header->version == BINARY_VERSION);
+    FAIL_UNLESS(header->size >= sizeof(*header) && header->size <= length);
+
+    for (unsigned i = 0; i < _BINARY_SECTION_NUM_ENTRIES; i++) {
+        const struct binary_section *s = &header->sections[i];
+        FAIL_UNLESS(s->offset <= header->size);
+        FAIL_UNLESS(s->count <= (header->size - s->offset) / record_sizes[i]);
+    }
+
+    return true;
+}
+
+static bool
+binary_v1_keymap_new_from_string(struct xkb_keymap *keymap,
+                                 const char *string, size_t length)
+{
+    struct binary_reader r = { .keymap = keymap, .data = string };
+
+    if (!read_header(&r, length) ||
+        !read_section_name(&r, r.header.keycodes_section_name,
+                           &keymap->keycodes_section_name) ||
+        !read_section_name(&r, r.header.types_section_name,
+                           &keymap->types_section_name) ||
+        !read_section_name(&r, r.header.compat_section_name,
+                           &keymap->compat_section_name) ||
+        !read_section_name(&r, r.header.symbols_section_name,
+                           &keymap->symbols_section_name) ||
+        !read_mods(&r) ||
+        !read_types(&r) ||
+        !read_compat(&r) ||
+        !read_keys(&r)) {
+        log_err(keymap->ctx, "Failed to load binary keymap\n");
+        return false;
+    }
+
+    keymap->enabled_ctrls = r.header.enabled_ctrls;
+
+    if (!xkb_keymap_build_texts(keymap))
+        return false;
+
+    return xkb_keymap_finalize(keymap);
+}
+
+static bool
+binary_v1_keymap_new_from_file(struct xkb_keymap *keymap, FILE *file)
+{
+    bool ok;
+    char *string;
+    size_t size;
+
+    if (!map_file(file, &string, &size)) {
+        log_err(keymap->ctx, "Couldn't read binary keymap file: %s\n",
+                strerror(errno));
+        return false;
+    }
+
+    ok = binary_v1_keymap_new_from_string(keymap, string, size);
+    unmap_file(string, size);
+    return ok;
+}
+
+const struct xkb_keymap_format_ops binary_v1_keymap_format_ops = {
+    .keymap_new_from_string = binary_v1_keymap_new_from_string,
+    .keymap_new_from_file = binary_v1_keymap_new_from_file,
+    .keymap_get_as_buffer = binary_v1_keymap_get_as_buffer,
+};
@@ -0,0 +1,406 @@
+/*
+ * Copyright © 2026 libxkbcommon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * A cache entry is a file named after a hash of the key, which holds:
+ *
+ *     xkbcommon keymap cache 2 VERSION
+ *     rules RULES
+ *     model MODEL
+ *     layout LAYOUT
+ *     variant VARIANT
+ *     options OPTIONS
+ *     include PATH
+ *     ...
+ *     file INODE SIZE MTIME PATH
+ *     missing PATH
+ *     ...
+ *     keymap
+ *     KEYMAP
+ *
+ * Everything before the file lines is the key, which the entry must match
+ * exactly.  The file and missing lines are the paths which were tried
+ * while compiling the keymap, in the include paths; the entry is only valid
+ * if those which existed are unchanged, and those which didn't still
+ * don't.  The keymap itself is in the binary format, so loading it doesn't
+ * involve the compiler at all.
+ */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "keymap-cache.h"
+
+#define KEYMAP_CACHE_HEADER "xkbcommon keymap cache 2 " PACKAGE_VERSION "\n"
+
+struct keymap_cache_dep {
+    char *path;
+    bool exists;
+    struct file_stamp stamp;
+};
+
+struct keymap_cache_deps {
+    darray(struct keymap_cache_dep) files;
+    /* Some file couldn't be checked, so the keymap can't be cached. */
+    bool failed;
+};
+
+static bool
+append_key_line(darray_char *buf, const char *name, const char *value)
+{
+    if (!value)
+        value = "";
+
+    /* Keep the format line based. */
+    if (strchr(value, '\n'))
+        return false;
+
+    darray_append_string(*buf, name);
+    darray_append_lit(*buf, " ");
+    darray_append_string(*buf, value);
+    darray_append_lit(*buf, "\n");
+    return true;
+}
+
+static bool
+build_key(struct xkb_context *ctx, const struct xkb_rule_names *rmlvo,
+          darray_char *key)
+{
+    darray_append_lit(*key, KEYMAP_CACHE_HEADER);
+
+    if (!append_key_line(key, "rules", rmlvo->rules) ||
+        !append_key_line(key, "model", rmlvo->model) ||
+        !append_key_line(key, "layout", rmlvo->layout) ||
+        !append_key_line(key, "variant", rmlvo->variant) ||
+        !append_key_line(key, "options", rmlvo->options))
+        return false;
+
+    for (unsigned i = 0; i < xkb_context_num_include_paths(ctx); i++)
+        if (!append_key_line(key, "include",
+                             xkb_context_include_path_get(ctx, i)))
+            return false;
+
+    return true;
+}
+
+/* FNV-1a. */
+static uint64_t
+hash_key(const darray_char *key)
+{
+    uint64_t hash = UINT64_C(0xcbf29ce484222325);
+
+    for (unsigned i = 0; i < darray_size(*key); i++) {
+        hash ^= (unsigned char) darray_item(*key, i);
+        hash *= UINT64_C(0x100000001b3);
+    }
+
+    return hash;
+}
+
+static char *
+entry_path(struct xkb_context *ctx, const darray_char *key)
+{
+    char *path;
+
+    if (asprintf(&path, "%s/%016" PRIx64 ".keymap",
+                 ctx->keymap_cache_dir, hash_key(key)) < 0)
+        return NULL;
+
+    return path;
+}
+
+static bool
+dep_is_valid(const struct keymap_cache_dep *dep)
+{
+    struct stat st;
+
+    if (stat(dep->path, &st) != 0)
+        return !dep->exists && (errno == ENOENT || errno == ENOTDIR);
+
+    return dep->exists && file_stamp_matches(&dep->stamp, &st);
+}
+
+/*
+ * Checks the file and missing lines at *pos, and advances it past the
+ * keymap line.
+ */
+static bool
+check_deps(const char *string, size_t size, size_t *pos)
+{
+    while (*pos < size) {
+        const char *line = string + *pos;
+        const char *end = memchr(line, '\n', size - *pos);
+        struct keymap_cache_dep dep = { 0 };
+        char *path, *endptr;
+
+        if (!end)
+            return false;
+
+        *pos += end - line + 1;
+
+        if (end - line == 6 && strncmp(line, "keymap", 6) == 0)
+            return true;
+
+        if (strncmp(line, "missing ", 8) == 0) {
+            path = strndup(line + 8, end - line - 8);
+        }
+        else if (strncmp(line, "file ", 5) == 0) {
+            dep.exists = true;
+            dep.stamp.ino = strtoull(line + 5, &endptr, 10);
+            dep.stamp.size = strtoull(endptr, &endptr, 10);
+            dep.stamp.mtime = strtoll(endptr, &endptr, 10);
+            if (*endptr != ' ' || endptr >= end)
+                return false;
+            path = strndup(endptr + 1, end - endptr - 1);
+        }
+        else {
+            return false;
+        }
+
+        if (!path)
+            return false;
+
+        dep.path = path;
+        if (!dep_is_valid(&dep)) {
+            free(path);
+            return false;
+        }
+        free(path);
+    }
+
+    return false;
+}
+
+struct xkb_keymap *
+keymap_cache_load(struct xkb_context *ctx, const struct xkb_rule_names *rmlvo,
+                  enum xkb_keymap_compile_flags flags)
+{
+    darray_char key = darray_new();
+    struct xkb_keymap *keymap = NULL;
+    char *path = NULL, *string;
+    size_t size, pos;
+    FILE *file;
+
+    if (!build_key(ctx, rmlvo, &key))
+        goto out;
+
+    path = entry_path(ctx, &key);
+    if (!path)
+        goto out;
+
+    file = fopen(path, "rb");
+    if (!file)
+        goto out;
+
+    if (!map_file(file, &string, &size)) {
+        fclose(file);
+        goto out;
+    }
+
+    pos = darray_size(key);
+    if (size >= pos && memcmp(string, key.item, pos) == 0 &&
+        check_deps(string, size, &pos)) {
+        keymap = xkb_keymap_new_from_buffer(ctx, string + pos, size - pos,
+                                            XKB_KEYMAP_FORMAT_BINARY_V1, flags);
+        /* The keymap was compiled from the XKB files. */
+        if (keymap)
+            keymap->format = XKB_KEYMAP_FORMAT_TEXT_V1;
+    }
+
+    unmap_file(string, size);
+    fclose(file);
+
+    log_dbg(ctx, "%s cached keymap %s\n",
+            keymap ? "Using" : "Not using out of date", path);
+
+out:
+    free(path);
+    darray_free(key);
+    return keymap;
+}
+
+void
+keymap_cache_record(struct xkb_context *ctx)
+{
+    struct context_scratch *scratch = xkb_context_get_scratch(ctx);
+
+    scratch->keymap_cache_deps = calloc(1, sizeof(*scratch->keymap_cache_deps));
+}
+
+void
+keymap_cache_note_file(struct xkb_context *ctx, const char *path, FILE *file)
+{
+    struct keymap_cache_deps *deps =
+        xkb_context_get_scratch(ctx)->keymap_cache_deps;
+    struct keymap_cache_dep *dep, new_dep = { 0 };
+    struct stat st;
+    int ret;
+
+    if (!deps || deps->failed)
+        return;
+
+    darray_foreach(dep, deps->files)
+        if (streq(dep->path, path))
+            return;
+
+    if (strchr(path, '\n')) {
+        deps->failed = true;
+        return;
+    }
+
+    ret = file ? fstat(fileno(file), &st) : stat(path, &st);
+    if (ret == 0) {
+        new_dep.exists = true;
+        file_stamp_set(&new_dep.stamp, &st);
+    }
+    else if (errno != ENOENT && errno != ENOTDIR) {
+        deps->failed = true;
+        return;
+    }
+
+    new_dep.path = strdup(path);
+    if (!new_dep.path) {
+        deps->failed = true;
+        return;
+    }
+
+    darray_append(deps->files, new_dep);
+}
+
+static void
+free_deps(struct keymap_cache_deps *deps)
+{
+    struct keymap_cache_dep *dep;
+
+    if (!deps)
+        return;
+
+    darray_foreach(dep, deps->files)
+        free(dep->path);
+    darray_free(deps->files);
+    free(deps);
+}
+
+static bool
+write_entry(FILE *file, const darray_char *key,
+            const struct keymap_cache_deps *deps, const char *keymap_buf,
+            size_t keymap_len)
+{
+    struct keymap_cache_dep *dep;
+
+    if (fwrite(key->item, 1, darray_size(*key), file) != darray_size(*key))
+        return false;
+
+    darray_foreach(dep, deps->files) {
+        int ret;
+
+        if (dep->exists)
+            ret = fprintf(file, "file %" PRIu64 " %" PRIu64 " %" PRId64 " %s\n",
+                          dep->stamp.ino, dep->stamp.size, dep->stamp.mtime,
+                          dep->path);
+        else
+            ret = fprintf(file, "missing %s\n", dep->path);
+
+        if (ret < 0)
+            return false;
+    }
+
+    return fputs("keymap\n", file) >= 0 &&
+           fwrite(keymap_buf, 1, keymap_len, file) == keymap_len;
+}
+
+void
+keymap_cache_store(struct xkb_context *ctx, const struct xkb_rule_names *rmlvo,
+                   struct xkb_keymap *keymap)
+{
+    struct context_scratch *scratch = xkb_context_get_scratch(ctx);
+    struct keymap_cache_deps *deps = scratch->keymap_cache_deps;
+    darray_char key = darray_new();
+    char *path = NULL, *tmp_path = NULL, *keymap_buf = NULL;
+    size_t keymap_len;
+    struct keymap_cache_dep *dep;
+    FILE *file;
+    int fd;
+    bool ok;
+
+    scratch->keymap_cache_deps = NULL;
+
+    if (!keymap || !deps || deps->failed)
+        goto out;
+
+    darray_foreach(dep, deps->files) {
+        if (dep->exists && !mtime_is_settled(dep->stamp.mtime)) {
+            log_dbg(ctx, "Not caching keymap: %s was just modified\n",
+                    dep->path);
+            goto out;
+        }
+    }
+
+    if (!build_key(ctx, rmlvo, &key))
+        goto out;
+
+    path = entry_path(ctx, &key);
+    keymap_buf = xkb_keymap_get_as_buffer(keymap, XKB_KEYMAP_FORMAT_BINARY_V1,
+                                          &keymap_len);
+    if (!path || !keymap_buf ||
+        asprintf(&tmp_path, "%s.XXXXXX", path) < 0) {
+        tmp_path = NULL;
+        goto out;
+    }
+
+    /* Write to a temporary file first, so readers never see partial entries. */
+    fd = mkstemp(tmp_path);
+    if (fd < 0) {
+        log_warn(ctx, "Couldn't create keymap cache entry %s: %s\n",
+                 tmp_path, strerror(errno));
+        goto out;
+    }
+
+    file = fdopen(fd, "wb");
+    if (!file) {
+        close(fd);
+        unlink(tmp_path);
+        goto out;
+    }
+
+    ok = write_entry(file, &key, deps, keymap_buf, keymap_len);
+    ok = (fclose(file) == 0) && ok;
+    if (!ok || rename(tmp_path, path) != 0) {
+        log_warn(ctx, "Couldn't write keymap cache entry %s\n", path);
+        unlink(tmp_path);
+        goto out;
+    }
+
+    log_dbg(ctx, "Cached keymap in %s\n", path);
+
+out:
+    free(tmp_path);
+    free(keymap_buf);
+    free(path);
+    darray_free(key);
+    free_deps(deps);
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright © 2026 libxkbcommon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef KEYMAP_CACHE_H
+#define KEYMAP_CACHE_H
+
+#include "keymap.h"
+
+/*
+ * The on-disk cache of the keymaps compiled from RMLVO names; see
+ * xkb_context_set_keymap_cache_dir().
+ */
+
+/*
+ * Returns the keymap cached for the names, if there is one and it is still
+ * up to date, otherwise NULL.  The names must be sanitized.
+ */
+struct xkb_keymap *
+keymap_cache_load(struct xkb_context *ctx, const struct xkb_rule_names *rmlvo,
+                  enum xkb_keymap_compile_flags flags);
+
+/*
+ * Starts recording the files looked up in the include paths, until
+ * keymap_cache_store() is called.
+ */
+void
+keymap_cache_record(struct xkb_context *ctx);
+
+/*
+ * Stops recording, and stores the keymap compiled from the names with the
+ * recorded files, unless it is NULL.
+ */
+void
+keymap_cache_store(struct xkb_context *ctx, const struct xkb_rule_names *rmlvo,
+                   struct xkb_keymap *keymap);
+
+/*
+ * Notes that a file was looked up at the path; file is the opened file, or
+ * NULL if the path couldn't be opened.  Does nothing unless recording.
+ */
+void
+keymap_cache_note_file(struct xkb_context *ctx, const char *path, FILE *file);
+
+#endif
@@ -147,3 +147,467 @@ XkbLevelsSameSyms(const struct xkb_level *a, const struct xkb_level *b)
         return a->u.sym == b->u.sym;
     return memcmp(a->u.syms, b->u.syms, sizeof(*a->u.syms) * a->num_syms) == 0;
 }
+
+static bool
+build_type_matches(struct xkb_key_type *type)
+{
+    const xkb_mod_mask_t mask = type->mods.mask;
+
+    if (mask > XKB_MAX_TYPE_MATCH_MASK || type->num_entries >= UINT8_MAX)
+        return true;
+
+    type->match_index = calloc(mask + 1, sizeof(*type->match_index));
+    type->matches = calloc(type->num_entries + 1, sizeof(*type->matches));
+    if (!type->match_index || !type->matches)
+        return false;
+
+    for (unsigned i = 0; i < type->num_entries; i++) {
+        const struct xkb_key_type_entry *entry = &type->entries[i];
+
+        type->matches[i + 1].entry = entry;
+        type->matches[i + 1].level = entry->level;
+        type->matches[i + 1].preserve = entry->preserve.mask;
+        type->matches[i + 1].consumed = mask & ~entry->preserve.mask;
+    }
+    type->matches[0].consumed = mask;
+
+    /* Like the lookup itself, the first matching entry wins. */
+    for (xkb_mod_mask_t mods = 0; mods <= mask; mods++) {
+        if ((mods & mask) != mods)
+            continue;
+
+        for (unsigned i = 0; i < type->num_entries; i++) {
+            const struct xkb_key_type_entry *entry = &type->entries[i];
+
+            if (entry_is_active(entry) && entry->mods.mask == mods) {
+                type->match_index[mods] = i + 1;
+                break;
+            }
+        }
+    }
+
+    return true;
+}
+
+static xkb_mod_index_t
+resolve_mod_index(struct xkb_keymap *keymap, const char *name)
+{
+    xkb_atom_t atom = xkb_atom_lookup(keymap->ctx, name);
+
+    if (atom == XKB_ATOM_NONE)
+        return XKB_MOD_INVALID;
+
+    return XkbModNameToIndex(&keymap->mods, atom, MOD_BOTH);
+}
+
+static xkb_led_index_t
+resolve_led_index(struct xkb_keymap *keymap, const char *name)
+{
+    xkb_atom_t atom = xkb_atom_lookup(keymap->ctx, name);
+    xkb_led_index_t i;
+    const struct xkb_led *led;
+
+    if (atom == XKB_ATOM_NONE)
+        return XKB_LED_INVALID;
+
+    xkb_leds_enumerate(i, led, keymap)
+        if (led->name == atom)
+            return i;
+
+    return XKB_LED_INVALID;
+}
+
+/*
+ * In XKB_CONSUMED_MODE_GTK, the consumed modifiers depend on which levels
+ * of the key have the same keysyms, so they are computed per group.
+ */
+static bool
+build_gtk_consumed(struct xkb_group *group)
+{
+    const struct xkb_key_type *type = group->type;
+    const struct xkb_level *no_mods_level;
+
+    if (!type->match_index)
+        return true;
+
+    group->gtk_consumed = calloc(type->num_entries + 1,
+                                 sizeof(*group->gtk_consumed));
+    if (!group->gtk_consumed)
+        return false;
+
+    no_mods_level = &group->levels[type->matches[type->match_index[0]].level];
+
+    for (unsigned m = 0; m <= type->num_entries; m++) {
+        const struct xkb_key_type_match *match = &type->matches[m];
+        xkb_mod_mask_t consumed = 0;
+
+        for (unsigned i = 0; i < type->num_entries; i++) {
+            const struct xkb_key_type_entry *entry = &type->entries[i];
+
+            if (!entry_is_active(entry))
+                continue;
+
+            if (XkbLevelsSameSyms(&group->levels[entry->level], no_mods_level))
+                continue;
+
+            if (entry == match->entry || my_popcount(entry->mods.mask) == 1)
+                consumed |= entry->mods.mask & ~entry->preserve.mask;
+        }
+
+        group->gtk_consumed[m] = consumed & ~match->preserve;
+    }
+
+    return true;
+}
+
+static void
+build_led_deps(struct xkb_keymap *keymap)
+{
+    xkb_led_index_t idx;
+    const struct xkb_led *led;
+
+    xkb_leds_enumerate(idx, led, keymap) {
+        enum xkb_state_component depends = 0;
+
+        /* The controls can't change, so LEDs bound to them are constant. */
+        if (led->mods.mask != 0)
+            depends |= led->which_mods;
+        if (led->groups != 0)
+            depends |= led->which_groups;
+
+        for (unsigned bit = 0; bit < ARRAY_SIZE(keymap->led_deps); bit++) {
+            if (depends & (1u << bit)) {
+                keymap->led_components |= (1u << bit);
+                keymap->led_deps[bit] |= (1u << idx);
+            }
+        }
+    }
+}
+
+static void
+build_effective_layouts_table(const struct xkb_keymap *keymap,
+                              const struct xkb_key *key,
+                              xkb_layout_index_t *table)
+{
+    for (xkb_layout_index_t group = 0; group < keymap->num_groups; group++)
+        table[group] = XkbWrapGroupIntoRange(group, key->num_groups,
+                                             key->out_of_range_group_action,
+                                             key->out_of_range_group_number);
+}
+
+static const xkb_layout_index_t *
+find_effective_layouts_table(const xkb_layout_index_t *tables,
+                             unsigned num_tables,
+                             const xkb_layout_index_t *table,
+                             xkb_layout_index_t num_groups)
+{
+    for (unsigned i = 0; i < num_tables; i++)
+        if (memcmp(&tables[i * num_groups], table,
+                   num_groups * sizeof(*table)) == 0)
+            return &tables[i * num_groups];
+
+    return NULL;
+}
+
+/*
+ * Only a handful of tables are distinct, since they only depend on the
+ * number of groups of the key and its out of range group settings.
+ */
+static bool
+build_effective_layouts(struct xkb_keymap *keymap)
+{
+    const xkb_layout_index_t num_groups = keymap->num_groups;
+    xkb_layout_index_t table[XKB_MAX_GROUPS];
+    xkb_layout_index_t *tables, *shrunk;
+    unsigned num_tables = 0;
+    struct xkb_key *key;
+
+    if (num_groups == 0)
+        return true;
+
+    tables = calloc((keymap->max_key_code - keymap->min_key_code + 1) *
+                    num_groups, sizeof(*tables));
+    if (!tables)
+        return false;
+
+    xkb_keys_foreach(key, keymap) {
+        build_effective_layouts_table(keymap, key, table);
+        if (find_effective_layouts_table(tables, num_tables, table,
+                                         num_groups))
+            continue;
+
+        memcpy(&tables[num_tables * num_groups], table,
+               num_groups * sizeof(*table));
+        num_tables++;
+    }
+
+    shrunk = realloc(tables, num_tables * num_groups * sizeof(*tables));
+    keymap->effective_layouts = shrunk ? shrunk : tables;
+
+    xkb_keys_foreach(key, keymap) {
+        build_effective_layouts_table(keymap, key, table);
+        key->effective_layouts =
+            find_effective_layouts_table(keymap->effective_layouts,
+                                         num_tables, table, num_groups);
+    }
+
+    return true;
+}
+
+/*
+ * Packing the keymap arrays into one block.  The same walk is done twice:
+ * first without a block, only to add up the size, then copying into it.
+ */
+struct slab_writer {
+    char *base;
+    size_t size;
+};
+
+/* Enough for all the keymap structures. */
+#define SLAB_ALIGN 8
+/* For the arrays which key processing goes through. */
+#define SLAB_CACHE_LINE 64
+
+#define SLAB_ALIGN_UP(size, align) (((size) + (align) - 1) & ~((size_t) (align) - 1))
+
+static void *
+slab_copy(struct slab_writer *w, void *src, size_t size, size_t align)
+{
+    void *dst;
+
+    if (!src)
+        return NULL;
+
+    w->size = SLAB_ALIGN_UP(w->size, align);
+    if (!w->base) {
+        w->size += size;
+        return src;
+    }
+
+    dst = w->base + w->size;
+    memcpy(dst, src, size);
+    w->size += size;
+    return dst;
+}
+
+#define slab_copy_array(w, arr, nmemb) \
+    ((arr) = slab_copy((w), (arr), (nmemb) * sizeof(*(arr)), SLAB_ALIGN))
+
+static char *
+slab_copy_string(struct slab_writer *w, char *str)
+{
+    return slab_copy(w, str, str ? strlen(str) + 1 : 0, 1);
+}
+
+/*
+ * The layout follows the lookups of key processing: the types with their
+ * match tables, the effective layouts tables, then the keys, each followed
+ * by its groups and their levels.  What is only used when dumping or by
+ * the compiler comes last.
+ */
+static void
+pack_keymap_arrays(struct xkb_keymap *keymap, struct slab_writer *w,
+                   size_t num_effective_layouts)
+{
+    const struct xkb_key_type *old_types = keymap->types;
+    const xkb_layout_index_t *old_effective_layouts =
+        keymap->effective_layouts;
+    struct xkb_key *key;
+
+    keymap->types = slab_copy(w, keymap->types,
+                              keymap->num_types * sizeof(*keymap->types),
+                              SLAB_CACHE_LINE);
+    for (unsigned i = 0; i < keymap->num_types; i++) {
+        struct xkb_key_type *type = &keymap->types[i];
+        const struct xkb_key_type_entry *old_entries = type->entries;
+
+        slab_copy_array(w, type->entries, type->num_entries);
+        if (type->match_index) {
+            slab_copy_array(w, type->match_index, type->mods.mask + 1);
+            slab_copy_array(w, type->matches, type->num_entries + 1);
+            for (unsigned j = 0; j <= type->num_entries; j++)
+                if (type->matches[j].entry)
+                    type->matches[j].entry = type->entries +
+                        (type->matches[j].entry - old_entries);
+        }
+    }
+
+    slab_copy_array(w, keymap->effective_layouts, num_effective_layouts);
+
+    if (keymap->keys) {
+        keymap->keys = slab_copy(w, keymap->keys,
+                                 (keymap->max_key_code + 1) *
+                                 sizeof(*keymap->keys),
+                                 SLAB_CACHE_LINE);
+
+        xkb_keys_foreach(key, keymap) {
+            if (key->effective_layouts)
+                key->effective_layouts = keymap->effective_layouts +
+                    (key->effective_layouts - old_effective_layouts);
+
+            slab_copy_array(w, key->groups, key->num_groups);
+            for (xkb_layout_index_t i = 0; i < key->num_groups; i++) {
+                struct xkb_group *group = &key->groups[i];
+                xkb_level_index_t num_levels;
+
+                group->type = keymap->types + (group->type - old_types);
+                num_levels = group->type->num_levels;
+
+                slab_copy_array(w, group->levels, num_levels);
+                for (xkb_level_index_t j = 0; j < num_levels; j++)
+                    if (group->levels[j].num_syms > 1)
+                        slab_copy_array(w, group->levels[j].u.syms,
+                                        group->levels[j].num_syms);
+
+                if (group->gtk_consumed)
+                    slab_copy_array(w, group->gtk_consumed,
+                                    group->type->num_entries + 1);
+                slab_copy_array(w, group->texts, num_levels);
+            }
+        }
+    }
+
+    for (unsigned i = 0; i < keymap->num_types; i++)
+        slab_copy_array(w, keymap->types[i].level_names,
+                        keymap->types[i].num_levels);
+    slab_copy_array(w, keymap->sym_interprets, keymap->num_sym_interprets);
+    slab_copy_array(w, keymap->key_aliases, keymap->num_key_aliases);
+    slab_copy_array(w, keymap->group_names, keymap->num_group_names);
+
+    keymap->keycodes_section_name =
+        slab_copy_string(w, keymap->keycodes_section_name);
+    keymap->symbols_section_name =
+        slab_copy_string(w, keymap->symbols_section_name);
+    keymap->types_section_name =
+        slab_copy_string(w, keymap->types_section_name);
+    keymap->compat_section_name =
+        slab_copy_string(w, keymap->compat_section_name);
+}
+
+/*
+ * Moves all the arrays of the keymap into a single block, for locality
+ * and so that it's freed at once.  This is only an optimization: if the
+ * block can't be allocated, the keymap stays as it is.
+ */
+static void
+pack_keymap(struct xkb_keymap *keymap)
+{
+    struct slab_writer w = { NULL, 0 };
+    size_t num_effective_layouts = 0;
+    struct xkb_keymap old;
+    const struct xkb_key *key;
+    void *slab;
+
+    if (keymap->keys) {
+        xkb_keys_foreach(key, keymap)
+            if (key->effective_layouts)
+                num_effective_layouts =
+                    MAX(num_effective_layouts,
+                        (size_t) (key->effective_layouts -
+                                  keymap->effective_layouts) +
+                        keymap->num_groups);
+    }
+
+    pack_keymap_arrays(keymap, &w, num_effective_layouts);
+
+    slab = malloc(w.size + SLAB_CACHE_LINE - 1);
+    if (!slab)
+        return;
+
+    old = *keymap;
+    w.base = (char *) SLAB_ALIGN_UP((uintptr_t) slab, SLAB_CACHE_LINE);
+    w.size = 0;
+    pack_keymap_arrays(keymap, &w, num_effective_layouts);
+    keymap->slab = slab;
+
+    xkb_keymap_free_arrays(&old);
+}
+
+/**
+ * Frees what the keymap points to, but not the keymap itself.
+ */
+void
+xkb_keymap_free_arrays(struct xkb_keymap *keymap)
+{
+    struct xkb_key *key;
+
+    if (keymap->slab) {
+        free(keymap->slab);
+        return;
+    }
+
+    if (keymap->keys) {
+        xkb_keys_foreach(key, keymap) {
+            if (key->groups) {
+                for (unsigned i = 0; i < key->num_groups; i++) {
+                    if (key->groups[i].levels) {
+                        for (unsigned j = 0; j < XkbKeyNumLevels(key, i); j++)
+                            if (key->groups[i].levels[j].num_syms > 1)
+                                free(key->groups[i].levels[j].u.syms);
+                        free(key->groups[i].levels);
+                    }
+                    free(key->groups[i].texts);
+                    free(key->groups[i].gtk_consumed);
+                }
+                free(key->groups);
+            }
+        }
+        free(keymap->keys);
+    }
+    free(keymap->effective_layouts);
+    if (keymap->types) {
+        for (unsigned i = 0; i < keymap->num_types; i++) {
+            free(keymap->types[i].entries);
+            free(keymap->types[i].level_names);
+            free(keymap->types[i].match_index);
+            free(keymap->types[i].matches);
+        }
+        free(keymap->types);
+    }
+    free(keymap->sym_interprets);
+    free(keymap->key_aliases);
+    free(keymap->group_names);
+    free(keymap->keycodes_section_name);
+    free(keymap->symbols_section_name);
+    free(keymap->types_section_name);
+    free(keymap->compat_section_name);
+}
+
+/**
+ * Precomputes the lookup tables used when processing keys.  This must be
+ * called once the keymap is complete, whichever way it was created.
+ */
+bool
+xkb_keymap_finalize(struct xkb_keymap *keymap)
+{
+    struct xkb_key *key;
+
+    for (unsigned i = 0; i < keymap->num_types; i++)
+        if (!build_type_matches(&keymap->types[i]))
+            return false;
+
+    xkb_keys_foreach(key, keymap)
+        for (xkb_layout_index_t i = 0; i < key->num_groups; i++)
+            if (!build_gtk_consumed(&key->groups[i]))
+                return false;
+
+    if (!build_effective_layouts(keymap))
+        return false;
+
+    build_led_deps(keymap);
+
+    keymap->canonical.shift = resolve_mod_index(keymap, XKB_MOD_NAME_SHIFT);
+    keymap->canonical.caps = resolve_mod_index(keymap, XKB_MOD_NAME_CAPS);
+    keymap->canonical.ctrl = resolve_mod_index(keymap, XKB_MOD_NAME_CTRL);
+    keymap->canonical.alt = resolve_mod_index(keymap, XKB_MOD_NAME_ALT);
+    keymap->canonical.num = resolve_mod_index(keymap, XKB_MOD_NAME_NUM);
+    keymap->canonical.logo = resolve_mod_index(keymap, XKB_MOD_NAME_LOGO);
+    keymap->canonical.caps_led = resolve_led_index(keymap, XKB_LED_NAME_CAPS);
+    keymap->canonical.num_led = resolve_led_index(keymap, XKB_LED_NAME_NUM);
+    keymap->canonical.scroll_led =
+        resolve_led_index(keymap, XKB_LED_NAME_SCROLL);
+
+    pack_keymap(keymap);
+
+    return true;
+}
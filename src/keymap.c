@@ -51,61 +51,126 @@
  * ********************************************************/
 
 #include "keymap.h"
+#include "keymap-cache.h"
+#include "keysym.h"
 #include "text.h"
+#include "utf8.h"
 
 XKB_EXPORT struct xkb_keymap *
 xkb_keymap_ref(struct xkb_keymap *keymap)
 {
-    keymap->refcnt++;
+    xkb_atomic_inc(&keymap->refcnt);
     return keymap;
 }
 
+static void
+unshare_keymap(struct xkb_keymap *keymap)
+{
+    struct xkb_context *ctx = keymap->ctx;
+    struct shared_keymap *shared;
+
+    xkb_context_lock(ctx);
+    darray_foreach(shared, ctx->shared_keymaps) {
+        if (shared->keymap == keymap) {
+            free(shared->key);
+            *shared = darray_item(ctx->shared_keymaps,
+                                  darray_size(ctx->shared_keymaps) - 1);
+            darray_size(ctx->shared_keymaps)--;
+            break;
+        }
+    }
+    xkb_context_unlock(ctx);
+}
+
 XKB_EXPORT void
 xkb_keymap_unref(struct xkb_keymap *keymap)
 {
-    if (!keymap || --keymap->refcnt > 0)
+    if (!keymap || xkb_atomic_dec(&keymap->refcnt) > 0)
         return;
 
-    if (keymap->keys) {
-        struct xkb_key *key;
-        xkb_keys_foreach(key, keymap) {
-            if (key->groups) {
-                for (unsigned i = 0; i < key->num_groups; i++) {
-                    if (key->groups[i].levels) {
-                        for (unsigned j = 0; j < XkbKeyNumLevels(key, i); j++)
-                            if (key->groups[i].levels[j].num_syms > 1)
-                                free(key->groups[i].levels[j].u.syms);
-                        free(key->groups[i].levels);
-                    }
-                }
-                free(key->groups);
-            }
-        }
-        free(keymap->keys);
-    }
-    if (keymap->types) {
-        for (unsigned i = 0; i < keymap->num_types; i++) {
-            free(keymap->types[i].entries);
-            free(keymap->types[i].level_names);
-        }
-        free(keymap->types);
-    }
-    free(keymap->sym_interprets);
-    free(keymap->key_aliases);
-    free(keymap->group_names);
-    free(keymap->keycodes_section_name);
-    free(keymap->symbols_section_name);
-    free(keymap->types_section_name);
-    free(keymap->compat_section_name);
+    unshare_keymap(keymap);
+
+#ifdef ENABLE_STATE_COUNTERS
+    xkb_keymap_log_state_counters(keymap);
+#endif
+
+    xkb_keymap_free_arrays(keymap);
     xkb_context_unref(keymap->ctx);
     free(keymap);
 }
 
+static void
+build_text(xkb_keysym_t sym, struct xkb_text *text)
+{
+    char tmp[7];
+    int ret;
+
+    text->utf32 = xkb_keysym_to_utf32(sym);
+
+    ret = xkb_keysym_to_utf8(sym, tmp, sizeof(tmp));
+    if (ret <= 1 || ret - 1 > (int) sizeof(text->utf8))
+        return;
+
+    text->utf8_len = ret - 1;
+    memcpy(text->utf8, tmp, text->utf8_len);
+    text->utf8_valid = is_valid_utf8(text->utf8, text->utf8_len);
+}
+
+static bool
+build_key_texts(struct xkb_key *key)
+{
+    for (xkb_layout_index_t i = 0; i < key->num_groups; i++) {
+        struct xkb_group *group = &key->groups[i];
+        xkb_level_index_t num_levels = XkbKeyNumLevels(key, i);
+
+        group->texts = calloc(num_levels, sizeof(*group->texts));
+        if (!group->texts)
+            return false;
+
+        for (xkb_level_index_t j = 0; j < num_levels; j++) {
+            const struct xkb_level *level = &group->levels[j];
+            struct xkb_level_text *text = &group->texts[j];
+
+            if (level->num_syms != 1)
+                continue;
+
+            text->upper_sym = xkb_keysym_to_upper(level->u.sym);
+            build_text(level->u.sym, &text->forms[0]);
+            build_text(text->upper_sym, &text->forms[1]);
+
+            if (level->u.sym <= 127u)
+                key->ascii_groups |= (1u << i);
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Precomputes the level texts, with XKB_KEYMAP_COMPILE_CACHE_TEXT.  This
+ * must be called before xkb_keymap_finalize().
+ */
+bool
+xkb_keymap_build_texts(struct xkb_keymap *keymap)
+{
+    struct xkb_key *key;
+
+    if (!(keymap->flags & XKB_KEYMAP_COMPILE_CACHE_TEXT))
+        return true;
+
+    xkb_keys_foreach(key, keymap)
+        if (!build_key_texts(key))
+            return false;
+
+    return true;
+}
+
 static const struct xkb_keymap_format_ops *
 get_keymap_format_ops(enum xkb_keymap_format format)
 {
     static const struct xkb_keymap_format_ops *keymap_format_ops[] = {
         [XKB_KEYMAP_FORMAT_TEXT_V1] = &text_v1_keymap_format_ops,
+        [XKB_KEYMAP_FORMAT_BINARY_V1] = &binary_v1_keymap_format_ops,
     };
 
     if ((int) format < 0 || (int) format >= (int) ARRAY_SIZE(keymap_format_ops))
@@ -114,6 +179,66 @@ get_keymap_format_ops(enum xkb_keymap_format format)
     return keymap_format_ops[(int) format];
 }
 
+/*
+ * The key of a keymap in ctx->shared_keymaps: the sanitized names and the
+ * compile flags, NUL separated.  XKB_KEYMAP_COMPILE_PARALLEL doesn't change
+ * the keymap, so it is left out.
+ */
+static void
+build_shared_key(const struct xkb_rule_names *rmlvo,
+                 enum xkb_keymap_compile_flags flags, darray_char *key)
+{
+    const char *names[] = {
+        rmlvo->rules, rmlvo->model, rmlvo->layout, rmlvo->variant,
+        rmlvo->options,
+    };
+    char flags_str[16];
+
+    for (unsigned i = 0; i < ARRAY_SIZE(names); i++) {
+        darray_append_string(*key, names[i] ? names[i] : "");
+        darray_append(*key, '\0');
+    }
+    snprintf(flags_str, sizeof(flags_str), "%#x",
+             (unsigned) (flags & ~XKB_KEYMAP_COMPILE_PARALLEL));
+    darray_append_string(*key, flags_str);
+}
+
+static struct xkb_keymap *
+find_shared_keymap(struct xkb_context *ctx, const darray_char *key)
+{
+    struct shared_keymap *shared;
+    struct xkb_keymap *keymap = NULL;
+
+    xkb_context_lock(ctx);
+    darray_foreach(shared, ctx->shared_keymaps) {
+        /* Skip it if another thread is freeing it. */
+        if (shared->key_len == darray_size(*key) &&
+            memcmp(shared->key, key->item, shared->key_len) == 0 &&
+            xkb_atomic_ref_if_alive(&shared->keymap->refcnt)) {
+            keymap = shared->keymap;
+            break;
+        }
+    }
+    xkb_context_unlock(ctx);
+
+    return keymap;
+}
+
+static void
+share_keymap(struct xkb_context *ctx, struct xkb_keymap *keymap,
+             darray_char *key)
+{
+    struct shared_keymap shared = {
+        .keymap = keymap,
+        .key_len = darray_size(*key),
+    };
+
+    darray_steal(*key, &shared.key, NULL);
+    xkb_context_lock(ctx);
+    darray_append(ctx->shared_keymaps, shared);
+    xkb_context_unlock(ctx);
+}
+
 XKB_EXPORT struct xkb_keymap *
 xkb_keymap_new_from_names(struct xkb_context *ctx,
                           const struct xkb_rule_names *rmlvo_in,
@@ -121,6 +246,7 @@ xkb_keymap_new_from_names(struct xkb_context *ctx,
 {
     struct xkb_keymap *keymap;
     struct xkb_rule_names rmlvo;
+    darray_char shared_key = darray_new();
     const enum xkb_keymap_format format = XKB_KEYMAP_FORMAT_TEXT_V1;
     const struct xkb_keymap_format_ops *ops;
 
@@ -130,26 +256,47 @@ xkb_keymap_new_from_names(struct xkb_context *ctx,
         return NULL;
     }
 
-    if (flags & ~(XKB_KEYMAP_COMPILE_NO_FLAGS)) {
+    if (flags & ~(XKB_KEYMAP_COMPILE_CACHE_TEXT |
+                  XKB_KEYMAP_COMPILE_PARALLEL)) {
         log_err_func(ctx, "unrecognized flags: %#x\n", flags);
         return NULL;
     }
 
-    keymap = xkb_keymap_new(ctx, format, flags);
-    if (!keymap)
-        return NULL;
-
     if (rmlvo_in)
         rmlvo = *rmlvo_in;
     else
         memset(&rmlvo, 0, sizeof(rmlvo));
     xkb_context_sanitize_rule_names(ctx, &rmlvo);
 
-    if (!ops->keymap_new_from_names(keymap, &rmlvo)) {
+    if (ctx->share_keymaps) {
+        build_shared_key(&rmlvo, flags, &shared_key);
+        keymap = find_shared_keymap(ctx, &shared_key);
+        if (keymap)
+            goto out;
+    }
+
+    if (ctx->keymap_cache_dir) {
+        keymap = keymap_cache_load(ctx, &rmlvo, flags);
+        if (keymap)
+            goto share;
+
+        keymap_cache_record(ctx);
+    }
+
+    keymap = xkb_keymap_new(ctx, format, flags);
+    if (keymap && !ops->keymap_new_from_names(keymap, &rmlvo)) {
         xkb_keymap_unref(keymap);
-        return NULL;
+        keymap = NULL;
     }
 
+    if (ctx->keymap_cache_dir)
+        keymap_cache_store(ctx, &rmlvo, keymap);
+
+share:
+    if (keymap && ctx->share_keymaps)
+        share_keymap(ctx, keymap, &shared_key);
+out:
+    darray_free(shared_key);
     return keymap;
 }
 
@@ -178,7 +325,8 @@ xkb_keymap_new_from_buffer(struct xkb_context *ctx,
         return NULL;
     }
 
-    if (flags & ~(XKB_KEYMAP_COMPILE_NO_FLAGS)) {
+    if (flags & ~(XKB_KEYMAP_COMPILE_CACHE_TEXT |
+                  XKB_KEYMAP_COMPILE_PARALLEL)) {
         log_err_func(ctx, "unrecognized flags: %#x\n", flags);
         return NULL;
     }
@@ -215,7 +363,8 @@ xkb_keymap_new_from_file(struct xkb_context *ctx,
         return NULL;
     }
 
-    if (flags & ~(XKB_KEYMAP_COMPILE_NO_FLAGS)) {
+    if (flags & ~(XKB_KEYMAP_COMPILE_CACHE_TEXT |
+                  XKB_KEYMAP_COMPILE_PARALLEL)) {
         log_err_func(ctx, "unrecognized flags: %#x\n", flags);
         return NULL;
     }
@@ -255,6 +404,32 @@ xkb_keymap_get_as_string(struct xkb_keymap *keymap,
     return ops->keymap_get_as_string(keymap);
 }
 
+XKB_EXPORT char *
+xkb_keymap_get_as_buffer(struct xkb_keymap *keymap,
+                         enum xkb_keymap_format format,
+                         size_t *length)
+{
+    const struct xkb_keymap_format_ops *ops;
+    char *buffer;
+
+    if (format == XKB_KEYMAP_USE_ORIGINAL_FORMAT)
+        format = keymap->format;
+
+    ops = get_keymap_format_ops(format);
+    if (!ops || (!ops->keymap_get_as_buffer && !ops->keymap_get_as_string)) {
+        log_err_func(keymap->ctx, "unsupported keymap format: %d\n", format);
+        return NULL;
+    }
+
+    if (ops->keymap_get_as_buffer)
+        return ops->keymap_get_as_buffer(keymap, length);
+
+    buffer = ops->keymap_get_as_string(keymap);
+    if (buffer)
+        *length = strlen(buffer);
+    return buffer;
+}
+
 /**
  * Returns the total number of modifiers active in the keymap.
  */
@@ -526,6 +701,9 @@ xkb_keymap_key_set_repeats(struct xkb_keymap *keymap, xkb_keycode_t kc, int enab
     if (!key)
         return 0;
 
+    /* The keymap doesn't match its names anymore. */
+    unshare_keymap(keymap);
+
     key->repeats = !!enable;
     key->explicit |= EXPLICIT_REPEAT;
 
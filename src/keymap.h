@@ -249,6 +249,16 @@ struct xkb_key_type_entry {
     struct xkb_mods preserve;
 };
 
+/* The result of matching a set of modifiers against a type's entries. */
+struct xkb_key_type_match {
+    /* NULL if no entry matches; the level is then the first one. */
+    const struct xkb_key_type_entry *entry;
+    xkb_level_index_t level;
+    xkb_mod_mask_t preserve;
+    /* The modifiers consumed in XKB_CONSUMED_MODE_XKB. */
+    xkb_mod_mask_t consumed;
+};
+
 struct xkb_key_type {
     xkb_atom_t name;
     struct xkb_mods mods;
@@ -256,8 +266,23 @@ struct xkb_key_type {
     xkb_atom_t *level_names;
     unsigned int num_entries;
     struct xkb_key_type_entry *entries;
+    /*
+     * Lookup table built by xkb_keymap_finalize(): the active modifiers,
+     * masked with mods.mask, index match_index, which in turn indexes
+     * matches.  matches[0] is the "no entry matches" result.  NULL if the
+     * type's modifiers don't fit in the table, see XKB_MAX_TYPE_MATCH_MASK.
+     */
+    uint8_t *match_index;
+    struct xkb_key_type_match *matches;
 };
 
+/*
+ * Types whose mask is larger than this don't get a match table, and are
+ * matched by scanning their entries instead.  This is never hit by real
+ * keymaps, since the effective masks are made of the 8 real modifiers.
+ */
+#define XKB_MAX_TYPE_MATCH_MASK 0xff
+
 struct xkb_sym_interpret {
     xkb_keysym_t sym;
     enum xkb_match_operation match;
@@ -320,12 +345,41 @@ struct xkb_level {
     } u;
 };
 
+/* The text of a keysym, as returned by xkb_state_key_get_utf8/utf32(). */
+struct xkb_text {
+    uint32_t utf32;
+    /* Not NUL-terminated. */
+    char utf8[4];
+    uint8_t utf8_len;
+    /* Whether xkb_keysym_to_utf8() succeeds and gives valid UTF-8. */
+    bool utf8_valid;
+};
+
+/*
+ * The text of a level with exactly one keysym: forms[0] is for the keysym
+ * itself, forms[1] for its uppercase form (the Lock transformation).
+ */
+struct xkb_level_text {
+    xkb_keysym_t upper_sym;
+    struct xkb_text forms[2];
+};
+
 struct xkb_group {
     bool explicit_type;
     /* Points to a type in keymap->types. */
     const struct xkb_key_type *type;
     /* Use XkbKeyNumLevels for the number of levels. */
     struct xkb_level *levels;
+    /*
+     * Parallel to levels, only with XKB_KEYMAP_COMPILE_CACHE_TEXT, else
+     * NULL.  Entries of levels without exactly one keysym are unused.
+     */
+    struct xkb_level_text *texts;
+    /*
+     * The modifiers consumed in XKB_CONSUMED_MODE_GTK, indexed like
+     * type->matches.  NULL if the type has no lookup table.
+     */
+    xkb_mod_mask_t *gtk_consumed;
 };
 
 struct xkb_key {
@@ -344,6 +398,22 @@ struct xkb_key {
 
     xkb_layout_index_t num_groups;
     struct xkb_group *groups;
+
+    /*
+     * The layouts which have a level with a single ASCII keysym, i.e. the
+     * candidates for the Control transformation fallback.  Only with
+     * XKB_KEYMAP_COMPILE_CACHE_TEXT.
+     */
+    xkb_layout_mask_t ascii_groups;
+
+    /*
+     * The layout to use for each effective group of a state, i.e. each
+     * group below keymap->num_groups, with the out of range group action
+     * applied; XKB_LAYOUT_INVALID if the key has no groups.  Points into
+     * keymap->effective_layouts, and is shared between the keys which
+     * resolve the groups the same way.
+     */
+    const xkb_layout_index_t *effective_layouts;
 };
 
 struct xkb_mod {
@@ -357,6 +427,25 @@ struct xkb_mod_set {
     unsigned int num_mods;
 };
 
+#ifdef ENABLE_STATE_COUNTERS
+/*
+ * The slow or unusual paths of the key processing, counted per state with
+ * --enable-state-counters.  The counts of a state are added to its keymap
+ * when it is freed, and the keymap logs the totals when it is freed.
+ */
+enum xkb_state_counter {
+    STATE_COUNTER_KEY_UPDATES,
+    STATE_COUNTER_FILTERS_CREATED,
+    STATE_COUNTER_FILTERS_EXHAUSTED,
+    STATE_COUNTER_GROUPS_WRAPPED,
+    STATE_COUNTER_NO_SYMBOL_LEVELS,
+    STATE_COUNTER_CTRL_FALLBACKS,
+    STATE_COUNTER_CTRL_FALLBACK_LAYOUTS,
+    STATE_COUNTER_MASK_UPDATES_SKIPPED,
+    _STATE_COUNTER_NUM_ENTRIES
+};
+#endif
+
 /* Common keyboard description structure */
 struct xkb_keymap {
     struct xkb_context *ctx;
@@ -392,10 +481,43 @@ struct xkb_keymap {
     struct xkb_led leds[XKB_MAX_LEDS];
     unsigned int num_leds;
 
+    /* The distinct key effective_layouts tables, keymap->num_groups each. */
+    xkb_layout_index_t *effective_layouts;
+
+    /*
+     * The state components which some LED depends on, and for each of
+     * them (by bit index in enum xkb_state_component), the LEDs which
+     * depend on it.  Computed by xkb_keymap_finalize().
+     */
+    enum xkb_state_component led_components;
+    xkb_led_mask_t led_deps[8];
+
+    /*
+     * Indices of the modifiers and LEDs named in xkbcommon-names.h, or
+     * XKB_MOD_INVALID / XKB_LED_INVALID if the keymap doesn't have them.
+     * Resolved by xkb_keymap_finalize(), so the key processing code never
+     * needs to look names up.
+     */
+    struct {
+        xkb_mod_index_t shift, caps, ctrl, alt, num, logo;
+        xkb_led_index_t caps_led, num_led, scroll_led;
+    } canonical;
+
     char *keycodes_section_name;
     char *symbols_section_name;
     char *types_section_name;
     char *compat_section_name;
+
+    /*
+     * The single block holding all the arrays and strings above, once
+     * xkb_keymap_finalize() has packed them; NULL while they are
+     * allocated separately.
+     */
+    void *slab;
+
+#ifdef ENABLE_STATE_COUNTERS
+    uint64_t state_counters[_STATE_COUNTER_NUM_ENTRIES];
+#endif
 };
 
 #define xkb_keys_foreach(iter, keymap) \
@@ -437,11 +559,35 @@ XkbKeyNumLevels(const struct xkb_key *key, xkb_layout_index_t layout)
     return key->groups[layout].type->num_levels;
 }
 
+/*
+ * If the virtual modifiers are not bound to anything, the entry
+ * is not active and should be skipped. xserver does this with
+ * cached entry->active field.
+ */
+static inline bool
+entry_is_active(const struct xkb_key_type_entry *entry)
+{
+    return entry->mods.mods == 0 || entry->mods.mask != 0;
+}
+
 struct xkb_keymap *
 xkb_keymap_new(struct xkb_context *ctx,
                enum xkb_keymap_format format,
                enum xkb_keymap_compile_flags flags);
 
+bool
+xkb_keymap_finalize(struct xkb_keymap *keymap);
+
+/*
+ * Not part of xkb_keymap_finalize(), which libxkbcommon-x11 builds too,
+ * since it needs the keysym tables.
+ */
+bool
+xkb_keymap_build_texts(struct xkb_keymap *keymap);
+
+void
+xkb_keymap_free_arrays(struct xkb_keymap *keymap);
+
 struct xkb_key *
 XkbKeyByName(struct xkb_keymap *keymap, xkb_atom_t name, bool use_aliases);
 
@@ -458,15 +604,51 @@ XkbModNameToIndex(const struct xkb_mod_set *mods, xkb_atom_t name,
 bool
 XkbLevelsSameSyms(const struct xkb_level *a, const struct xkb_level *b);
 
-xkb_layout_index_t
+static inline xkb_layout_index_t
 XkbWrapGroupIntoRange(int32_t group,
                       xkb_layout_index_t num_groups,
                       enum xkb_range_exceed_type out_of_range_group_action,
-                      xkb_layout_index_t out_of_range_group_number);
+                      xkb_layout_index_t out_of_range_group_number)
+{
+    if (num_groups == 0)
+        return XKB_LAYOUT_INVALID;
+
+    if (group >= 0 && (xkb_layout_index_t) group < num_groups)
+        return group;
+
+    switch (out_of_range_group_action) {
+    case RANGE_REDIRECT:
+        if (out_of_range_group_number >= num_groups)
+            return 0;
+        return out_of_range_group_number;
+
+    case RANGE_SATURATE:
+        if (group < 0)
+            return 0;
+        else
+            return num_groups - 1;
+
+    case RANGE_WRAP:
+    default:
+        /*
+         * C99 says a negative dividend in a modulo operation always
+         * gives a negative result.
+         */
+        if (group < 0)
+            return ((int) num_groups + (group % (int) num_groups));
+        else
+            return group % num_groups;
+    }
+}
 
 xkb_mod_mask_t
 mod_mask_get_effective(struct xkb_keymap *keymap, xkb_mod_mask_t mods);
 
+#ifdef ENABLE_STATE_COUNTERS
+void
+xkb_keymap_log_state_counters(struct xkb_keymap *keymap);
+#endif
+
 struct xkb_keymap_format_ops {
     bool (*keymap_new_from_names)(struct xkb_keymap *keymap,
                                   const struct xkb_rule_names *names);
@@ -474,8 +656,11 @@ struct xkb_keymap_format_ops {
                                    const char *string, size_t length);
     bool (*keymap_new_from_file)(struct xkb_keymap *keymap, FILE *file);
     char *(*keymap_get_as_string)(struct xkb_keymap *keymap);
+    /* For the formats which aren't text; sets the length of the buffer. */
+    char *(*keymap_get_as_buffer)(struct xkb_keymap *keymap, size_t *length);
 };
 
 extern const struct xkb_keymap_format_ops text_v1_keymap_format_ops;
+extern const struct xkb_keymap_format_ops binary_v1_keymap_format_ops;
 
 #endif
@@ -74,6 +74,13 @@ struct xkb_filter {
     int refcnt;
 };
 
+/*
+ * The maximum number of filters active at the same time, i.e. roughly the
+ * number of keys with actions held down at the same time.  Must fit in
+ * the active_filters mask.
+ */
+#define XKB_MAX_FILTERS 32
+
 struct state_components {
     /* These may be negative, because of -1 group actions. */
     int32_t base_group; /**< depressed */
@@ -112,38 +119,96 @@ struct xkb_state {
     int16_t mod_key_count[XKB_MAX_MODS];
 
     int refcnt;
-    darray(struct xkb_filter) filters;
+    /*
+     * The arguments of the last xkb_state_update_mask() call, if no other
+     * update happened since, so that repeating it can be skipped.
+     */
+    struct {
+        bool valid;
+        xkb_mod_mask_t base_mods, latched_mods, locked_mods;
+        xkb_layout_index_t base_group, latched_group, locked_group;
+    } last_mask;
+
+    /*
+     * If not NULL, overrides the repeat behavior of the keymap: bit
+     * (kc % 32) of repeats[kc / 32] is set if the key kc repeats.
+     */
+    uint32_t *repeats;
+
+    /* Whether components.leds has been computed at all. */
+    bool leds_valid;
+
+    /* The filters whose bit is set in active_filters are live. */
+    uint32_t active_filters;
+    /* Whether running out of filters was reported already. */
+    bool filters_exhausted_logged;
+    struct xkb_filter filters[XKB_MAX_FILTERS];
     struct xkb_keymap *keymap;
+
+#ifdef ENABLE_STATE_COUNTERS
+    uint64_t counters[_STATE_COUNTER_NUM_ENTRIES];
+#endif
 };
 
-/*
- * If the virtual modifiers are not bound to anything, the entry
- * is not active and should be skipped. xserver does this with
- * cached entry->active field.
- */
-static bool
-entry_is_active(const struct xkb_key_type_entry *entry)
+#ifdef ENABLE_STATE_COUNTERS
+#define state_count(state, counter) ((state)->counters[counter]++)
+
+static const char *state_counter_names[_STATE_COUNTER_NUM_ENTRIES] = {
+    [STATE_COUNTER_KEY_UPDATES] = "key updates",
+    [STATE_COUNTER_FILTERS_CREATED] = "filters created",
+    [STATE_COUNTER_FILTERS_EXHAUSTED] = "filters exhausted",
+    [STATE_COUNTER_GROUPS_WRAPPED] = "groups wrapped into range",
+    [STATE_COUNTER_NO_SYMBOL_LEVELS] = "NoSymbol levels",
+    [STATE_COUNTER_CTRL_FALLBACKS] = "Control fallbacks",
+    [STATE_COUNTER_CTRL_FALLBACK_LAYOUTS] = "Control fallback layouts tried",
+    [STATE_COUNTER_MASK_UPDATES_SKIPPED] = "mask updates skipped",
+};
+
+void
+xkb_keymap_log_state_counters(struct xkb_keymap *keymap)
 {
-    return entry->mods.mods == 0 || entry->mods.mask != 0;
+    for (enum xkb_state_counter i = 0; i < _STATE_COUNTER_NUM_ENTRIES; i++)
+        log_info(keymap->ctx, "State counter: %s: %" PRIu64 "\n",
+                 state_counter_names[i], keymap->state_counters[i]);
 }
+#else
+#define state_count(state, counter) ((void) 0)
+#endif
 
-static const struct xkb_key_type_entry *
-get_entry_for_mods(const struct xkb_key_type *type, xkb_mod_mask_t mods)
+static struct xkb_key_type_match
+get_match_for_mods(const struct xkb_key_type *type, xkb_mod_mask_t mods)
 {
-    for (unsigned i = 0; i < type->num_entries; i++)
+    struct xkb_key_type_match match = { NULL, 0, 0 };
+
+    if (likely(type->match_index))
+        return type->matches[type->match_index[mods]];
+
+    for (unsigned i = 0; i < type->num_entries; i++) {
         if (entry_is_active(&type->entries[i]) &&
-            type->entries[i].mods.mask == mods)
-            return &type->entries[i];
-    return NULL;
+            type->entries[i].mods.mask == mods) {
+            match.entry = &type->entries[i];
+            match.level = type->entries[i].level;
+            match.preserve = type->entries[i].preserve.mask;
+            break;
+        }
+    }
+
+    return match;
 }
 
-static const struct xkb_key_type_entry *
-get_entry_for_key_state(struct xkb_state *state, const struct xkb_key *key,
-                        xkb_layout_index_t group)
+static struct xkb_key_type_match
+get_match_for_key(const struct xkb_key *key, xkb_layout_index_t group,
+                  xkb_mod_mask_t mods)
 {
     const struct xkb_key_type *type = key->groups[group].type;
-    xkb_mod_mask_t active_mods = state->components.mods & type->mods.mask;
-    return get_entry_for_mods(type, active_mods);
+    return get_match_for_mods(type, mods & type->mods.mask);
+}
+
+static struct xkb_key_type_match
+get_match_for_key_state(struct xkb_state *state, const struct xkb_key *key,
+                        xkb_layout_index_t group)
+{
+    return get_match_for_key(key, group, state->components.mods);
 }
 
 /**
@@ -155,54 +220,38 @@ xkb_state_key_get_level(struct xkb_state *state, xkb_keycode_t kc,
                         xkb_layout_index_t layout)
 {
     const struct xkb_key *key = XkbKey(state->keymap, kc);
-    const struct xkb_key_type_entry *entry;
 
     if (!key || layout >= key->num_groups)
         return XKB_LEVEL_INVALID;
 
     /* If we don't find an explicit match the default is 0. */
-    entry = get_entry_for_key_state(state, key, layout);
-    if (!entry)
-        return 0;
-
-    return entry->level;
+    return get_match_for_key_state(state, key, layout).level;
 }
 
-xkb_layout_index_t
-XkbWrapGroupIntoRange(int32_t group,
-                      xkb_layout_index_t num_groups,
-                      enum xkb_range_exceed_type out_of_range_group_action,
-                      xkb_layout_index_t out_of_range_group_number)
+/*
+ * The effective group of a state is always below keymap->num_groups, so
+ * it is resolved with the key's precomputed table.  Groups coming from
+ * elsewhere, e.g. an xkb_state_components, may still need wrapping.
+ */
+static inline xkb_layout_index_t
+key_get_layout(const struct xkb_keymap *keymap, const struct xkb_key *key,
+               xkb_layout_index_t group)
 {
-    if (num_groups == 0)
-        return XKB_LAYOUT_INVALID;
+    if (likely(group < keymap->num_groups))
+        return key->effective_layouts[group];
 
-    if (group >= 0 && (xkb_layout_index_t) group < num_groups)
-        return group;
-
-    switch (out_of_range_group_action) {
-    case RANGE_REDIRECT:
-        if (out_of_range_group_number >= num_groups)
-            return 0;
-        return out_of_range_group_number;
+    return XkbWrapGroupIntoRange(group, key->num_groups,
+                                 key->out_of_range_group_action,
+                                 key->out_of_range_group_number);
+}
 
-    case RANGE_SATURATE:
-        if (group < 0)
-            return 0;
-        else
-            return num_groups - 1;
+static inline xkb_layout_index_t
+state_key_get_layout(struct xkb_state *state, const struct xkb_key *key)
+{
+    if (key->num_groups > 0 && state->components.group >= key->num_groups)
+        state_count(state, STATE_COUNTER_GROUPS_WRAPPED);
 
-    case RANGE_WRAP:
-    default:
-        /*
-         * C99 says a negative dividend in a modulo operation always
-         * gives a negative result.
-         */
-        if (group < 0)
-            return ((int) num_groups + (group % (int) num_groups));
-        else
-            return group % num_groups;
-    }
+    return key_get_layout(state->keymap, key, state->components.group);
 }
 
 /**
@@ -217,9 +266,7 @@ xkb_state_key_get_layout(struct xkb_state *state, xkb_keycode_t kc)
     if (!key)
         return XKB_LAYOUT_INVALID;
 
-    return XkbWrapGroupIntoRange(state->components.group, key->num_groups,
-                                 key->out_of_range_group_action,
-                                 key->out_of_range_group_number);
+    return state_key_get_layout(state, key);
 }
 
 static const union xkb_action *
@@ -230,7 +277,7 @@ xkb_key_get_action(struct xkb_state *state, const struct xkb_key *key)
     xkb_layout_index_t layout;
     xkb_level_index_t level;
 
-    layout = xkb_state_key_get_layout(state, key->keycode);
+    layout = state_key_get_layout(state, key);
     if (layout == XKB_LAYOUT_INVALID)
         return &dummy;
 
@@ -241,23 +288,33 @@ xkb_key_get_action(struct xkb_state *state, const struct xkb_key *key)
     return &key->groups[layout].levels[level].action;
 }
 
+/*
+ * Takes the first free slot, so that the filters are applied in the order
+ * they were created, modulo reuse.  Returns NULL if all slots are taken.
+ */
 static struct xkb_filter *
 xkb_filter_new(struct xkb_state *state)
 {
-    struct xkb_filter *filter = NULL, *iter;
-
-    darray_foreach(iter, state->filters) {
-        if (iter->func)
-            continue;
-        filter = iter;
-        break;
+    struct xkb_filter *filter;
+    int slot;
+
+    if (state->active_filters == UINT32_MAX) {
+        state_count(state, STATE_COUNTER_FILTERS_EXHAUSTED);
+        if (!state->filters_exhausted_logged) {
+            log_warn(state->keymap->ctx,
+                     "More than %d keys with actions held down; "
+                     "ignoring the actions of the others\n",
+                     XKB_MAX_FILTERS);
+            state->filters_exhausted_logged = true;
+        }
+        return NULL;
     }
 
-    if (!filter) {
-        darray_resize0(state->filters, darray_size(state->filters) + 1);
-        filter = &darray_item(state->filters, darray_size(state->filters) -1);
-    }
+    state_count(state, STATE_COUNTER_FILTERS_CREATED);
+    slot = my_ctz(~state->active_filters);
+    state->active_filters |= (1u << slot);
 
+    filter = &state->filters[slot];
     filter->refcnt = 1;
     return filter;
 }
@@ -558,12 +615,15 @@ xkb_filter_apply_all(struct xkb_state *state,
     /* First run through all the currently active filters and see if any of
      * them have consumed this event. */
     consumed = false;
-    darray_foreach(filter, state->filters) {
-        if (!filter->func)
-            continue;
+    for (uint32_t active = state->active_filters; active;
+         active &= active - 1) {
+        int slot = my_ctz(active);
 
+        filter = &state->filters[slot];
         if (filter->func(state, filter, key, direction) == XKB_FILTER_CONSUME)
             consumed = true;
+        if (!filter->func)
+            state->active_filters &= ~(1u << slot);
     }
     if (consumed || direction == XKB_KEY_UP)
         return;
@@ -583,7 +643,11 @@ xkb_filter_apply_all(struct xkb_state *state,
     if (!filter_action_funcs[action->type].new)
         return;
 
+    /* Too many keys held down; the action is ignored. */
     filter = xkb_filter_new(state);
+    if (!filter)
+        return;
+
     filter->key = key;
     filter->func = filter_action_funcs[action->type].func;
     filter->action = *action;
@@ -605,21 +669,65 @@ xkb_state_new(struct xkb_keymap *keymap)
     return ret;
 }
 
+/* The number of words of a bitmap covering all the keycodes. */
+static size_t
+repeats_num_words(const struct xkb_keymap *keymap)
+{
+    return keymap->max_key_code / 32 + 1;
+}
+
+XKB_EXPORT struct xkb_state *
+xkb_state_clone(struct xkb_state *state)
+{
+    struct xkb_state *ret;
+
+    ret = malloc(sizeof(*ret));
+    if (!ret)
+        return NULL;
+
+    *ret = *state;
+    ret->refcnt = 1;
+#ifdef ENABLE_STATE_COUNTERS
+    memset(ret->counters, 0, sizeof(ret->counters));
+#endif
+
+    if (state->repeats) {
+        size_t size = repeats_num_words(state->keymap) * sizeof(uint32_t);
+
+        ret->repeats = malloc(size);
+        if (!ret->repeats) {
+            free(ret);
+            return NULL;
+        }
+        memcpy(ret->repeats, state->repeats, size);
+    }
+
+    ret->keymap = xkb_keymap_ref(state->keymap);
+
+    return ret;
+}
+
 XKB_EXPORT struct xkb_state *
 xkb_state_ref(struct xkb_state *state)
 {
-    state->refcnt++;
+    xkb_atomic_inc(&state->refcnt);
     return state;
 }
 
 XKB_EXPORT void
 xkb_state_unref(struct xkb_state *state)
 {
-    if (!state || --state->refcnt > 0)
+    if (!state || xkb_atomic_dec(&state->refcnt) > 0)
         return;
 
+#ifdef ENABLE_STATE_COUNTERS
+    /* The states of a keymap may be freed from different threads. */
+    for (enum xkb_state_counter i = 0; i < _STATE_COUNTER_NUM_ENTRIES; i++)
+        xkb_atomic_add(&state->keymap->state_counters[i], state->counters[i]);
+#endif
+
     xkb_keymap_unref(state->keymap);
-    darray_free(state->filters);
+    free(state->repeats);
     free(state);
 }
 
@@ -629,6 +737,157 @@ xkb_state_get_keymap(struct xkb_state *state)
     return state->keymap;
 }
 
+XKB_EXPORT int
+xkb_state_key_repeats(struct xkb_state *state, xkb_keycode_t kc)
+{
+    const struct xkb_key *key = XkbKey(state->keymap, kc);
+
+    if (!key)
+        return 0;
+
+    if (state->repeats)
+        return !!(state->repeats[kc / 32] & (1u << (kc % 32)));
+
+    return key->repeats;
+}
+
+/* Starts overriding the keymap, with the same behavior. */
+static bool
+repeats_init(struct xkb_state *state)
+{
+    const struct xkb_key *key;
+
+    if (state->repeats)
+        return true;
+
+    state->repeats = calloc(repeats_num_words(state->keymap),
+                            sizeof(*state->repeats));
+    if (!state->repeats)
+        return false;
+
+    xkb_keys_foreach(key, state->keymap)
+        if (key->repeats)
+            state->repeats[key->keycode / 32] |= (1u << (key->keycode % 32));
+
+    return true;
+}
+
+XKB_EXPORT int
+xkb_state_key_set_repeats(struct xkb_state *state, xkb_keycode_t kc,
+                          int enable)
+{
+    const struct xkb_key *key = XkbKey(state->keymap, kc);
+
+    if (!key || !repeats_init(state))
+        return 0;
+
+    if (enable)
+        state->repeats[kc / 32] |= (1u << (kc % 32));
+    else
+        state->repeats[kc / 32] &= ~(1u << (kc % 32));
+
+    return 1;
+}
+
+XKB_EXPORT size_t
+xkb_state_get_repeats(struct xkb_state *state, uint32_t *bitmap,
+                      size_t num_words)
+{
+    size_t needed = repeats_num_words(state->keymap);
+    const struct xkb_key *key;
+
+    if (!bitmap)
+        return needed;
+
+    if (state->repeats) {
+        memcpy(bitmap, state->repeats,
+               MIN(num_words, needed) * sizeof(*bitmap));
+        if (num_words > needed)
+            memset(bitmap + needed, 0,
+                   (num_words - needed) * sizeof(*bitmap));
+        return needed;
+    }
+
+    memset(bitmap, 0, num_words * sizeof(*bitmap));
+    xkb_keys_foreach(key, state->keymap)
+        if (key->repeats && key->keycode / 32 < num_words)
+            bitmap[key->keycode / 32] |= (1u << (key->keycode % 32));
+
+    return needed;
+}
+
+XKB_EXPORT int
+xkb_state_set_repeats(struct xkb_state *state, const uint32_t *bitmap,
+                      size_t num_words)
+{
+    const struct xkb_key *key;
+
+    if (!bitmap) {
+        free(state->repeats);
+        state->repeats = NULL;
+        return 1;
+    }
+
+    if (!repeats_init(state))
+        return 0;
+
+    /* Only keys which exist in the keymap may have their bit set. */
+    xkb_keys_foreach(key, state->keymap) {
+        xkb_keycode_t kc = key->keycode;
+
+        if (kc / 32 >= num_words)
+            break;
+
+        if (bitmap[kc / 32] & (1u << (kc % 32)))
+            state->repeats[kc / 32] |= (1u << (kc % 32));
+        else
+            state->repeats[kc / 32] &= ~(1u << (kc % 32));
+    }
+
+    return 1;
+}
+
+static enum xkb_state_component
+get_state_component_changes(const struct state_components *a,
+                            const struct state_components *b);
+
+static bool
+led_is_active(struct xkb_state *state, const struct xkb_led *led)
+{
+    xkb_mod_mask_t mod_mask = 0;
+    xkb_layout_mask_t group_mask = 0;
+
+    if (led->which_mods != 0 && led->mods.mask != 0) {
+        if (led->which_mods & XKB_STATE_MODS_EFFECTIVE)
+            mod_mask |= state->components.mods;
+        if (led->which_mods & XKB_STATE_MODS_DEPRESSED)
+            mod_mask |= state->components.base_mods;
+        if (led->which_mods & XKB_STATE_MODS_LATCHED)
+            mod_mask |= state->components.latched_mods;
+        if (led->which_mods & XKB_STATE_MODS_LOCKED)
+            mod_mask |= state->components.locked_mods;
+
+        if (led->mods.mask & mod_mask)
+            return true;
+    }
+
+    if (led->which_groups != 0 && led->groups != 0) {
+        if (led->which_groups & XKB_STATE_LAYOUT_EFFECTIVE)
+            group_mask |= (1u << state->components.group);
+        if (led->which_groups & XKB_STATE_LAYOUT_DEPRESSED)
+            group_mask |= (1u << state->components.base_group);
+        if (led->which_groups & XKB_STATE_LAYOUT_LATCHED)
+            group_mask |= (1u << state->components.latched_group);
+        if (led->which_groups & XKB_STATE_LAYOUT_LOCKED)
+            group_mask |= (1u << state->components.locked_group);
+
+        if (led->groups & group_mask)
+            return true;
+    }
+
+    return led->ctrls & state->keymap->enabled_ctrls;
+}
+
 /**
  * Update the LED state to match the rest of the xkb_state.
  */
@@ -640,55 +899,51 @@ xkb_state_led_update_all(struct xkb_state *state)
 
     state->components.leds = 0;
 
-    xkb_leds_enumerate(idx, led, state->keymap) {
-        xkb_mod_mask_t mod_mask = 0;
-        xkb_layout_mask_t group_mask = 0;
-
-        if (led->which_mods != 0 && led->mods.mask != 0) {
-            if (led->which_mods & XKB_STATE_MODS_EFFECTIVE)
-                mod_mask |= state->components.mods;
-            if (led->which_mods & XKB_STATE_MODS_DEPRESSED)
-                mod_mask |= state->components.base_mods;
-            if (led->which_mods & XKB_STATE_MODS_LATCHED)
-                mod_mask |= state->components.latched_mods;
-            if (led->which_mods & XKB_STATE_MODS_LOCKED)
-                mod_mask |= state->components.locked_mods;
-
-            if (led->mods.mask & mod_mask) {
-                state->components.leds |= (1u << idx);
-                continue;
-            }
-        }
+    xkb_leds_enumerate(idx, led, state->keymap)
+        if (led_is_active(state, led))
+            state->components.leds |= (1u << idx);
 
-        if (led->which_groups != 0 && led->groups != 0) {
-            if (led->which_groups & XKB_STATE_LAYOUT_EFFECTIVE)
-                group_mask |= (1u << state->components.group);
-            if (led->which_groups & XKB_STATE_LAYOUT_DEPRESSED)
-                group_mask |= (1u << state->components.base_group);
-            if (led->which_groups & XKB_STATE_LAYOUT_LATCHED)
-                group_mask |= (1u << state->components.latched_group);
-            if (led->which_groups & XKB_STATE_LAYOUT_LOCKED)
-                group_mask |= (1u << state->components.locked_group);
-
-            if (led->groups & group_mask) {
-                state->components.leds |= (1u << idx);
-                continue;
-            }
-        }
+    state->leds_valid = true;
+}
 
-        if (led->ctrls & state->keymap->enabled_ctrls) {
+/**
+ * Update the LEDs which depend on the changed state components.
+ */
+static void
+xkb_state_led_update(struct xkb_state *state,
+                     enum xkb_state_component changed)
+{
+    const struct xkb_keymap *keymap = state->keymap;
+    xkb_led_mask_t dirty = 0;
+
+    if (unlikely(!state->leds_valid)) {
+        xkb_state_led_update_all(state);
+        return;
+    }
+
+    changed &= keymap->led_components;
+    while (changed) {
+        dirty |= keymap->led_deps[my_ctz(changed)];
+        changed &= changed - 1;
+    }
+
+    while (dirty) {
+        xkb_led_index_t idx = my_ctz(dirty);
+
+        if (led_is_active(state, &keymap->leds[idx]))
             state->components.leds |= (1u << idx);
-            continue;
-        }
+        else
+            state->components.leds &= ~(1u << idx);
+
+        dirty &= dirty - 1;
     }
 }
 
 /**
- * Calculates the derived state (effective mods/group and LEDs) from an
- * up-to-date xkb_state.
+ * Calculates the effective mods and group from an up-to-date xkb_state.
  */
 static void
-xkb_state_update_derived(struct xkb_state *state)
+xkb_state_update_effective(struct xkb_state *state)
 {
     xkb_layout_index_t wrapped;
 
@@ -711,8 +966,20 @@ xkb_state_update_derived(struct xkb_state *state)
                                     RANGE_WRAP, 0);
     state->components.group =
         (wrapped == XKB_LAYOUT_INVALID ? 0 : wrapped);
+}
 
-    xkb_state_led_update_all(state);
+/**
+ * Calculates the derived state (effective mods/group and LEDs) from an
+ * up-to-date xkb_state, given the state before the update.
+ */
+static void
+xkb_state_update_derived(struct xkb_state *state,
+                         const struct state_components *prev_components)
+{
+    xkb_state_update_effective(state);
+    xkb_state_led_update(state,
+                         get_state_component_changes(prev_components,
+                                                     &state->components));
 }
 
 static enum xkb_state_component
@@ -744,25 +1011,21 @@ get_state_component_changes(const struct state_components *a,
 }
 
 /**
- * Given a particular key event, updates the state structure to reflect the
- * new modifiers.
+ * Applies a key event to the base state and the effective mods and group,
+ * but not to the LEDs.
  */
-XKB_EXPORT enum xkb_state_component
-xkb_state_update_key(struct xkb_state *state, xkb_keycode_t kc,
-                     enum xkb_key_direction direction)
+static void
+update_key(struct xkb_state *state, const struct xkb_key *key,
+           enum xkb_key_direction direction)
 {
     xkb_mod_index_t i;
     xkb_mod_mask_t bit;
-    struct state_components prev_components;
-    const struct xkb_key *key = XkbKey(state->keymap, kc);
 
-    if (!key)
-        return 0;
-
-    prev_components = state->components;
+    state_count(state, STATE_COUNTER_KEY_UPDATES);
 
     state->set_mods = 0;
     state->clear_mods = 0;
+    state->last_mask.valid = false;
 
     xkb_filter_apply_all(state, key, direction);
 
@@ -785,11 +1048,73 @@ xkb_state_update_key(struct xkb_state *state, xkb_keycode_t kc,
         }
     }
 
-    xkb_state_update_derived(state);
+    xkb_state_update_effective(state);
+}
+
+/**
+ * Given a particular key event, updates the state structure to reflect the
+ * new modifiers.
+ */
+XKB_EXPORT enum xkb_state_component
+xkb_state_update_key(struct xkb_state *state, xkb_keycode_t kc,
+                     enum xkb_key_direction direction)
+{
+    struct state_components prev_components;
+    const struct xkb_key *key = XkbKey(state->keymap, kc);
+
+    if (!key)
+        return 0;
+
+    prev_components = state->components;
+
+    update_key(state, key, direction);
+    xkb_state_led_update(state,
+                         get_state_component_changes(&prev_components,
+                                                     &state->components));
 
     return get_state_component_changes(&prev_components, &state->components);
 }
 
+/**
+ * Applies a series of key events.  The LEDs don't affect key processing, so
+ * they are only updated at the end.
+ */
+XKB_EXPORT enum xkb_state_component
+xkb_state_update_keys(struct xkb_state *state, struct xkb_key_event *events,
+                      size_t num_events)
+{
+    struct state_components prev_components, start_components;
+    enum xkb_state_component changed = 0;
+
+    start_components = state->components;
+
+    for (size_t i = 0; i < num_events; i++) {
+        struct xkb_key_event *event = &events[i];
+        const struct xkb_key *key = XkbKey(state->keymap, event->keycode);
+
+        if (!key) {
+            event->keysym = XKB_KEY_NoSymbol;
+            event->utf32 = 0;
+            continue;
+        }
+
+        event->keysym = xkb_state_key_get_one_sym(state, event->keycode);
+        event->utf32 = xkb_state_key_get_utf32(state, event->keycode);
+
+        prev_components = state->components;
+        update_key(state, key, event->direction);
+        changed |= get_state_component_changes(&prev_components,
+                                               &state->components);
+    }
+
+    xkb_state_led_update(state, changed);
+
+    if (state->components.leds != start_components.leds)
+        changed |= XKB_STATE_LEDS;
+
+    return changed;
+}
+
 /**
  * Updates the state from a set of explicit masks as gained from
  * xkb_state_serialize_mods and xkb_state_serialize_groups.  As noted in the
@@ -809,6 +1134,25 @@ xkb_state_update_mask(struct xkb_state *state,
     struct state_components prev_components;
     xkb_mod_mask_t mask;
 
+    if (state->last_mask.valid &&
+        state->last_mask.base_mods == base_mods &&
+        state->last_mask.latched_mods == latched_mods &&
+        state->last_mask.locked_mods == locked_mods &&
+        state->last_mask.base_group == base_group &&
+        state->last_mask.latched_group == latched_group &&
+        state->last_mask.locked_group == locked_group) {
+        state_count(state, STATE_COUNTER_MASK_UPDATES_SKIPPED);
+        return 0;
+    }
+
+    state->last_mask.valid = true;
+    state->last_mask.base_mods = base_mods;
+    state->last_mask.latched_mods = latched_mods;
+    state->last_mask.locked_mods = locked_mods;
+    state->last_mask.base_group = base_group;
+    state->last_mask.latched_group = latched_group;
+    state->last_mask.locked_group = locked_group;
+
     prev_components = state->components;
 
     /* Only include modifiers which exist in the keymap. */
@@ -843,7 +1187,7 @@ xkb_state_update_mask(struct xkb_state *state,
     state->components.latched_group = latched_group;
     state->components.locked_group = locked_group;
 
-    xkb_state_update_derived(state);
+    xkb_state_update_derived(state, &prev_components);
 
     return get_state_component_changes(&prev_components, &state->components);
 }
@@ -858,6 +1202,7 @@ xkb_state_key_get_syms(struct xkb_state *state, xkb_keycode_t kc,
 {
     xkb_layout_index_t layout;
     xkb_level_index_t level;
+    int nsyms;
 
     layout = xkb_state_key_get_layout(state, kc);
     if (layout == XKB_LAYOUT_INVALID)
@@ -867,40 +1212,59 @@ xkb_state_key_get_syms(struct xkb_state *state, xkb_keycode_t kc,
     if (level == XKB_LEVEL_INVALID)
         goto err;
 
-    return xkb_keymap_key_get_syms_by_level(state->keymap, kc, layout, level,
-                                            syms_out);
+    nsyms = xkb_keymap_key_get_syms_by_level(state->keymap, kc, layout, level,
+                                             syms_out);
+    if (nsyms == 0)
+        state_count(state, STATE_COUNTER_NO_SYMBOL_LEVELS);
+    return nsyms;
 
 err:
     *syms_out = NULL;
     return 0;
 }
 
+static xkb_mod_mask_t
+key_get_consumed(struct xkb_state *state, const struct xkb_key *key,
+                 enum xkb_consumed_mode mode);
+
+static inline xkb_mod_mask_t
+mod_index_to_mask(xkb_mod_index_t idx)
+{
+    return idx < XKB_MAX_MODS ? (1u << idx) : 0;
+}
+
 /*
+ * Returns which of the Lock and Control modifiers should transform the
+ * symbols of the key, i.e. those which are active and not consumed.
+ *
  * http://www.x.org/releases/current/doc/kbproto/xkbproto.html#Interpreting_the_Lock_Modifier
+ * http://www.x.org/releases/current/doc/kbproto/xkbproto.html#Interpreting_the_Control_Modifier
  */
-static bool
-should_do_caps_transformation(struct xkb_state *state, xkb_keycode_t kc)
+static xkb_mod_mask_t
+get_transformation_mods(struct xkb_state *state, const struct xkb_key *key)
 {
-    xkb_mod_index_t caps =
-        xkb_keymap_mod_get_index(state->keymap, XKB_MOD_NAME_CAPS);
+    const struct xkb_keymap *keymap = state->keymap;
+    xkb_mod_mask_t mods;
 
-    return
-        xkb_state_mod_index_is_active(state, caps, XKB_STATE_MODS_EFFECTIVE) > 0 &&
-        xkb_state_mod_index_is_consumed(state, kc, caps) == 0;
+    mods = state->components.mods &
+           (mod_index_to_mask(keymap->canonical.caps) |
+            mod_index_to_mask(keymap->canonical.ctrl));
+    if (likely(mods == 0))
+        return 0;
+
+    return mods & ~key_get_consumed(state, key, XKB_CONSUMED_MODE_XKB);
 }
 
-/*
- * http://www.x.org/releases/current/doc/kbproto/xkbproto.html#Interpreting_the_Control_Modifier
- */
-static bool
-should_do_ctrl_transformation(struct xkb_state *state, xkb_keycode_t kc)
+static inline bool
+should_do_caps_transformation(struct xkb_state *state, xkb_mod_mask_t mods)
 {
-    xkb_mod_index_t ctrl =
-        xkb_keymap_mod_get_index(state->keymap, XKB_MOD_NAME_CTRL);
+    return mods & mod_index_to_mask(state->keymap->canonical.caps);
+}
 
-    return
-        xkb_state_mod_index_is_active(state, ctrl, XKB_STATE_MODS_EFFECTIVE) > 0 &&
-        xkb_state_mod_index_is_consumed(state, kc, ctrl) == 0;
+static inline bool
+should_do_ctrl_transformation(struct xkb_state *state, xkb_mod_mask_t mods)
+{
+    return mods & mod_index_to_mask(state->keymap->canonical.ctrl);
 }
 
 /* Verbatim from libX11:src/xkb/XKBBind.c */
@@ -928,17 +1292,22 @@ XkbToControl(char ch)
 XKB_EXPORT xkb_keysym_t
 xkb_state_key_get_one_sym(struct xkb_state *state, xkb_keycode_t kc)
 {
+    const struct xkb_key *key = XkbKey(state->keymap, kc);
     const xkb_keysym_t *syms;
     xkb_keysym_t sym;
     int num_syms;
 
+    if (!key)
+        return XKB_KEY_NoSymbol;
+
     num_syms = xkb_state_key_get_syms(state, kc, &syms);
     if (num_syms != 1)
         return XKB_KEY_NoSymbol;
 
     sym = syms[0];
 
-    if (should_do_caps_transformation(state, kc))
+    if (should_do_caps_transformation(state,
+                                      get_transformation_mods(state, key)))
         sym = xkb_keysym_to_upper(sym);
 
     return sym;
@@ -954,16 +1323,18 @@ xkb_state_key_get_one_sym(struct xkb_state *state, xkb_keycode_t kc)
  * but it is enabled by default, yippee.
  */
 static xkb_keysym_t
-get_one_sym_for_string(struct xkb_state *state, xkb_keycode_t kc)
+get_one_sym_for_string(struct xkb_state *state, const struct xkb_key *key,
+                       xkb_mod_mask_t transformation_mods)
 {
+    xkb_keycode_t kc = key->keycode;
     xkb_level_index_t level;
     xkb_layout_index_t layout, num_layouts;
     const xkb_keysym_t *syms;
     int nsyms;
     xkb_keysym_t sym;
 
-    layout = xkb_state_key_get_layout(state, kc);
-    num_layouts = xkb_keymap_num_layouts_for_key(state->keymap, kc);
+    layout = state_key_get_layout(state, key);
+    num_layouts = key->num_groups;
     level = xkb_state_key_get_level(state, kc, layout);
     if (layout == XKB_LAYOUT_INVALID || num_layouts == 0 ||
         level == XKB_LEVEL_INVALID)
@@ -971,12 +1342,18 @@ get_one_sym_for_string(struct xkb_state *state, xkb_keycode_t kc)
 
     nsyms = xkb_keymap_key_get_syms_by_level(state->keymap, kc,
                                              layout, level, &syms);
-    if (nsyms != 1)
+    if (nsyms != 1) {
+        if (nsyms == 0)
+            state_count(state, STATE_COUNTER_NO_SYMBOL_LEVELS);
         return XKB_KEY_NoSymbol;
+    }
     sym = syms[0];
 
-    if (should_do_ctrl_transformation(state, kc) && sym > 127u) {
+    if (should_do_ctrl_transformation(state, transformation_mods) &&
+        sym > 127u) {
+        state_count(state, STATE_COUNTER_CTRL_FALLBACKS);
         for (xkb_layout_index_t i = 0; i < num_layouts; i++) {
+            state_count(state, STATE_COUNTER_CTRL_FALLBACK_LAYOUTS);
             level = xkb_state_key_get_level(state, kc, i);
             if (level == XKB_LEVEL_INVALID)
                 continue;
@@ -990,25 +1367,121 @@ get_one_sym_for_string(struct xkb_state *state, xkb_keycode_t kc)
         }
     }
 
-    if (should_do_caps_transformation(state, kc)) {
+    if (should_do_caps_transformation(state, transformation_mods)) {
         sym = xkb_keysym_to_upper(sym);
     }
 
     return sym;
 }
 
+/*
+ * Like get_one_sym_for_string(), using the texts precomputed with
+ * XKB_KEYMAP_COMPILE_CACHE_TEXT.  Returns NULL if the key doesn't produce
+ * exactly one keysym or the texts aren't available.
+ */
+static const struct xkb_text *
+get_text_for_string(struct xkb_state *state, const struct xkb_key *key,
+                    xkb_mod_mask_t transformation_mods)
+{
+    const struct xkb_group *group;
+    const struct xkb_level_text *text;
+    xkb_layout_index_t layout;
+    xkb_level_index_t level;
+
+    layout = state_key_get_layout(state, key);
+    if (layout == XKB_LAYOUT_INVALID)
+        return NULL;
+
+    group = &key->groups[layout];
+    if (!group->texts)
+        return NULL;
+
+    level = get_match_for_key_state(state, key, layout).level;
+    if (level >= XkbKeyNumLevels(key, layout) ||
+        group->levels[level].num_syms != 1)
+        return NULL;
+
+    text = &group->texts[level];
+
+    if (should_do_ctrl_transformation(state, transformation_mods) &&
+        group->levels[level].u.sym > 127u) {
+        state_count(state, STATE_COUNTER_CTRL_FALLBACKS);
+        for (xkb_layout_index_t i = 0; i < key->num_groups; i++) {
+            const struct xkb_group *ascii_group = &key->groups[i];
+
+            if (!(key->ascii_groups & (1u << i)))
+                continue;
+
+            state_count(state, STATE_COUNTER_CTRL_FALLBACK_LAYOUTS);
+            level = get_match_for_key_state(state, key, i).level;
+            if (level >= XkbKeyNumLevels(key, i))
+                continue;
+
+            if (ascii_group->levels[level].num_syms == 1 &&
+                ascii_group->levels[level].u.sym <= 127u) {
+                text = &ascii_group->texts[level];
+                break;
+            }
+        }
+    }
+
+    return &text->forms[should_do_caps_transformation(state,
+                                                      transformation_mods)];
+}
+
 XKB_EXPORT int
 xkb_state_key_get_utf8(struct xkb_state *state, xkb_keycode_t kc,
                        char *buffer, size_t size)
 {
+    const struct xkb_key *key = XkbKey(state->keymap, kc);
+    xkb_mod_mask_t transformation_mods;
+    const struct xkb_text *text;
     xkb_keysym_t sym;
     const xkb_keysym_t *syms;
     int nsyms;
     int offset;
     char tmp[7];
 
-    sym = get_one_sym_for_string(state, kc);
+    if (!key)
+        goto err_bad;
+
+    transformation_mods = get_transformation_mods(state, key);
+
+    text = get_text_for_string(state, key, transformation_mods);
+    if (text) {
+        offset = text->utf8_len;
+        if (!text->utf8_valid && offset == 0)
+            goto err_bad;
+        if ((size_t) offset <= size)
+            memcpy(buffer, text->utf8, offset);
+        if ((size_t) offset >= size)
+            goto err_trunc;
+        buffer[offset] = '\0';
+        if (!text->utf8_valid)
+            goto err_bad;
+        goto out;
+    }
+
+    sym = get_one_sym_for_string(state, key, transformation_mods);
     if (sym != XKB_KEY_NoSymbol) {
+        /*
+         * Fast path for the overwhelmingly common case of a single keysym
+         * with a single-byte encoding: skip the copy and validation.
+         */
+        uint32_t cp = xkb_keysym_to_utf32(sym);
+        if (cp != 0 && cp <= 127u) {
+            if (size < 2) {
+                if (size > 0)
+                    buffer[0] = '\0';
+                return 1;
+            }
+            if (should_do_ctrl_transformation(state, transformation_mods))
+                cp = (uint32_t) XkbToControl((char) cp);
+            buffer[0] = (char) cp;
+            buffer[1] = '\0';
+            return 1;
+        }
+
         nsyms = 1; syms = &sym;
     }
     else {
@@ -1035,8 +1508,9 @@ xkb_state_key_get_utf8(struct xkb_state *state, xkb_keycode_t kc,
     if (!is_valid_utf8(buffer, offset))
         goto err_bad;
 
+out:
     if (offset == 1 && (unsigned int) buffer[0] <= 127u &&
-        should_do_ctrl_transformation(state, kc))
+        should_do_ctrl_transformation(state, transformation_mods))
         buffer[0] = XkbToControl(buffer[0]);
 
     return offset;
@@ -1055,13 +1529,28 @@ err_bad:
 XKB_EXPORT uint32_t
 xkb_state_key_get_utf32(struct xkb_state *state, xkb_keycode_t kc)
 {
+    const struct xkb_key *key = XkbKey(state->keymap, kc);
+    xkb_mod_mask_t transformation_mods;
+    const struct xkb_text *text;
     xkb_keysym_t sym;
     uint32_t cp;
 
-    sym = get_one_sym_for_string(state, kc);
-    cp = xkb_keysym_to_utf32(sym);
+    if (!key)
+        return 0;
+
+    transformation_mods = get_transformation_mods(state, key);
 
-    if (cp <= 127u && should_do_ctrl_transformation(state, kc))
+    text = get_text_for_string(state, key, transformation_mods);
+    if (text) {
+        cp = text->utf32;
+    }
+    else {
+        sym = get_one_sym_for_string(state, key, transformation_mods);
+        cp = xkb_keysym_to_utf32(sym);
+    }
+
+    if (cp <= 127u &&
+        should_do_ctrl_transformation(state, transformation_mods))
         cp = (uint32_t) XkbToControl((char) cp);
 
     return cp;
@@ -1113,6 +1602,21 @@ xkb_state_serialize_layout(struct xkb_state *state,
     return ret;
 }
 
+XKB_EXPORT void
+xkb_state_serialize_components(struct xkb_state *state,
+                               struct xkb_state_components *components)
+{
+    components->depressed_mods = state->components.base_mods;
+    components->latched_mods = state->components.latched_mods;
+    components->locked_mods = state->components.locked_mods;
+    components->mods = state->components.mods;
+    components->depressed_layout = state->components.base_group;
+    components->latched_layout = state->components.latched_group;
+    components->locked_layout = state->components.locked_group;
+    components->layout = state->components.group;
+    components->leds = state->components.leds;
+}
+
 /**
  * Gets a modifier mask and returns the resolved effective mask; this
  * is needed because some modifiers can also map to other modifiers, e.g.
@@ -1150,6 +1654,18 @@ xkb_state_mod_index_is_active(struct xkb_state *state,
     return !!(xkb_state_serialize_mods(state, type) & (1u << idx));
 }
 
+static inline bool
+match_masks(uint32_t active, enum xkb_state_match match, uint32_t wanted)
+{
+    if (!(match & XKB_STATE_MATCH_NON_EXCLUSIVE) && (active & ~wanted))
+        return false;
+
+    if (match & XKB_STATE_MATCH_ANY)
+        return active & wanted;
+
+    return (active & wanted) == wanted;
+}
+
 /**
  * Helper function for xkb_state_mod_indices_are_active and
  * xkb_state_mod_names_are_active.
@@ -1160,15 +1676,7 @@ match_mod_masks(struct xkb_state *state,
                 enum xkb_state_match match,
                 xkb_mod_mask_t wanted)
 {
-    xkb_mod_mask_t active = xkb_state_serialize_mods(state, type);
-
-    if (!(match & XKB_STATE_MATCH_NON_EXCLUSIVE) && (active & ~wanted))
-        return false;
-
-    if (match & XKB_STATE_MATCH_ANY)
-        return active & wanted;
-
-    return (active & wanted) == wanted;
+    return match_masks(xkb_state_serialize_mods(state, type), match, wanted);
 }
 
 /**
@@ -1325,30 +1833,196 @@ xkb_state_led_name_is_active(struct xkb_state *state, const char *name)
     return xkb_state_led_index_is_active(state, idx);
 }
 
+enum state_query_kind {
+    STATE_QUERY_MODS,
+    STATE_QUERY_LAYOUTS,
+    STATE_QUERY_LEDS,
+};
+
+struct xkb_state_query {
+    int refcnt;
+    struct xkb_keymap *keymap;
+    enum state_query_kind kind;
+    enum xkb_state_component type;
+    enum xkb_state_match match;
+    /* The mask of the wanted modifiers, layouts or LEDs, by index. */
+    uint32_t wanted;
+};
+
+static struct xkb_state_query *
+state_query_new(struct xkb_keymap *keymap, enum state_query_kind kind,
+                enum xkb_state_component type, enum xkb_state_match match,
+                const char *const *names, size_t num_names)
+{
+    struct xkb_state_query *query;
+    uint32_t wanted = 0;
+    size_t i;
+
+    for (i = 0; i < num_names; i++) {
+        uint32_t idx;
+
+        switch (kind) {
+        case STATE_QUERY_MODS:
+            idx = xkb_keymap_mod_get_index(keymap, names[i]);
+            if (idx == XKB_MOD_INVALID)
+                goto err;
+            break;
+        case STATE_QUERY_LAYOUTS:
+            idx = xkb_keymap_layout_get_index(keymap, names[i]);
+            if (idx == XKB_LAYOUT_INVALID)
+                goto err;
+            break;
+        case STATE_QUERY_LEDS:
+        default:
+            idx = xkb_keymap_led_get_index(keymap, names[i]);
+            if (idx == XKB_LED_INVALID)
+                goto err;
+            break;
+        }
+
+        wanted |= (1u << idx);
+    }
+
+    query = calloc(1, sizeof(*query));
+    if (!query)
+        return NULL;
+
+    query->refcnt = 1;
+    query->keymap = xkb_keymap_ref(keymap);
+    query->kind = kind;
+    query->type = type;
+    query->match = match;
+    query->wanted = wanted;
+    return query;
+
+err:
+    log_err_func(keymap->ctx, "no such name in the keymap: %s\n", names[i]);
+    return NULL;
+}
+
+XKB_EXPORT struct xkb_state_query *
+xkb_state_query_new_mods(struct xkb_keymap *keymap,
+                         enum xkb_state_component type,
+                         enum xkb_state_match match,
+                         const char *const *names, size_t num_names)
+{
+    return state_query_new(keymap, STATE_QUERY_MODS, type, match,
+                           names, num_names);
+}
+
+XKB_EXPORT struct xkb_state_query *
+xkb_state_query_new_layouts(struct xkb_keymap *keymap,
+                            enum xkb_state_component type,
+                            enum xkb_state_match match,
+                            const char *const *names, size_t num_names)
+{
+    return state_query_new(keymap, STATE_QUERY_LAYOUTS, type, match,
+                           names, num_names);
+}
+
+XKB_EXPORT struct xkb_state_query *
+xkb_state_query_new_leds(struct xkb_keymap *keymap,
+                         enum xkb_state_match match,
+                         const char *const *names, size_t num_names)
+{
+    return state_query_new(keymap, STATE_QUERY_LEDS, 0, match,
+                           names, num_names);
+}
+
+XKB_EXPORT struct xkb_state_query *
+xkb_state_query_ref(struct xkb_state_query *query)
+{
+    xkb_atomic_inc(&query->refcnt);
+    return query;
+}
+
+XKB_EXPORT void
+xkb_state_query_unref(struct xkb_state_query *query)
+{
+    if (!query || xkb_atomic_dec(&query->refcnt) > 0)
+        return;
+
+    xkb_keymap_unref(query->keymap);
+    free(query);
+}
+
+/* The layouts which are active in any of the given components, as a mask. */
+static xkb_layout_mask_t
+state_layout_mask(struct xkb_state *state, enum xkb_state_component type)
+{
+    const xkb_layout_index_t num_groups = state->keymap->num_groups;
+    xkb_layout_mask_t mask = 0;
+
+    if (type & XKB_STATE_LAYOUT_EFFECTIVE)
+        mask |= (1u << state->components.group);
+    if ((type & XKB_STATE_LAYOUT_DEPRESSED) &&
+        (xkb_layout_index_t) state->components.base_group < num_groups)
+        mask |= (1u << state->components.base_group);
+    if ((type & XKB_STATE_LAYOUT_LATCHED) &&
+        (xkb_layout_index_t) state->components.latched_group < num_groups)
+        mask |= (1u << state->components.latched_group);
+    if ((type & XKB_STATE_LAYOUT_LOCKED) &&
+        (xkb_layout_index_t) state->components.locked_group < num_groups)
+        mask |= (1u << state->components.locked_group);
+
+    return mask;
+}
+
+XKB_EXPORT int
+xkb_state_query_is_active(struct xkb_state *state,
+                          const struct xkb_state_query *query)
+{
+    uint32_t active;
+
+    if (query->keymap != state->keymap)
+        return -1;
+
+    switch (query->kind) {
+    case STATE_QUERY_MODS:
+        active = xkb_state_serialize_mods(state, query->type);
+        break;
+    case STATE_QUERY_LAYOUTS:
+        active = state_layout_mask(state, query->type);
+        break;
+    case STATE_QUERY_LEDS:
+    default:
+        active = state->components.leds;
+        break;
+    }
+
+    return match_masks(active, query->match, query->wanted);
+}
+
 /**
  * See:
  * - XkbTranslateKeyCode(3), mod_rtrn return value, from libX11.
  * - MyEnhancedXkbTranslateKeyCode(), a modification of the above, from GTK+.
  */
 static xkb_mod_mask_t
-key_get_consumed(struct xkb_state *state, const struct xkb_key *key,
-                 enum xkb_consumed_mode mode)
+key_get_consumed_for(const struct xkb_keymap *keymap,
+                     const struct xkb_key *key, xkb_layout_index_t group,
+                     xkb_mod_mask_t mods, enum xkb_consumed_mode mode)
 {
     const struct xkb_key_type *type;
-    const struct xkb_key_type_entry *matching_entry;
-    xkb_mod_mask_t preserve = 0;
-    xkb_layout_index_t group;
+    struct xkb_key_type_match match;
     xkb_mod_mask_t consumed = 0;
 
-    group = xkb_state_key_get_layout(state, key->keycode);
+    group = key_get_layout(keymap, key, group);
     if (group == XKB_LAYOUT_INVALID)
         return 0;
 
     type = key->groups[group].type;
 
-    matching_entry = get_entry_for_key_state(state, key, group);
-    if (matching_entry)
-        preserve = matching_entry->preserve.mask;
+    if (likely(type->match_index)) {
+        uint8_t m = type->match_index[mods & type->mods.mask];
+
+        if (mode == XKB_CONSUMED_MODE_XKB)
+            return type->matches[m].consumed;
+        if (mode == XKB_CONSUMED_MODE_GTK)
+            return key->groups[group].gtk_consumed[m];
+    }
+
+    match = get_match_for_key(key, group, mods);
 
     switch (mode) {
     case XKB_CONSUMED_MODE_XKB:
@@ -1356,12 +2030,10 @@ key_get_consumed(struct xkb_state *state, const struct xkb_key *key,
         break;
 
     case XKB_CONSUMED_MODE_GTK: {
-        const struct xkb_key_type_entry *no_mods_entry;
         xkb_level_index_t no_mods_leveli;
         const struct xkb_level *no_mods_level, *level;
 
-        no_mods_entry = get_entry_for_mods(type, 0);
-        no_mods_leveli = no_mods_entry ? no_mods_entry->level : 0;
+        no_mods_leveli = get_match_for_mods(type, 0).level;
         no_mods_level = &key->groups[group].levels[no_mods_leveli];
 
         for (unsigned i = 0; i < type->num_entries; i++) {
@@ -1373,14 +2045,22 @@ key_get_consumed(struct xkb_state *state, const struct xkb_key *key,
             if (XkbLevelsSameSyms(level, no_mods_level))
                 continue;
 
-            if (entry == matching_entry || my_popcount(entry->mods.mask) == 1)
+            if (entry == match.entry || my_popcount(entry->mods.mask) == 1)
                 consumed |= entry->mods.mask & ~entry->preserve.mask;
         }
         break;
     }
     }
 
-    return consumed & ~preserve;
+    return consumed & ~match.preserve;
+}
+
+static xkb_mod_mask_t
+key_get_consumed(struct xkb_state *state, const struct xkb_key *key,
+                 enum xkb_consumed_mode mode)
+{
+    return key_get_consumed_for(state->keymap, key, state->components.group,
+                                state->components.mods, mode);
 }
 
 XKB_EXPORT int
@@ -1444,3 +2124,87 @@ xkb_state_key_get_consumed_mods(struct xkb_state *state, xkb_keycode_t kc)
 {
     return xkb_state_key_get_consumed_mods2(state, kc, XKB_CONSUMED_MODE_XKB);
 }
+
+/*
+ * The following functions answer the same queries as their xkb_state
+ * counterparts, from a snapshot of the state instead.  They only read the
+ * keymap, so they can run concurrently with each other.
+ */
+
+XKB_EXPORT xkb_layout_index_t
+xkb_state_components_key_get_layout(struct xkb_keymap *keymap,
+                                    const struct xkb_state_components *components,
+                                    xkb_keycode_t kc)
+{
+    const struct xkb_key *key = XkbKey(keymap, kc);
+
+    if (!key)
+        return XKB_LAYOUT_INVALID;
+
+    return key_get_layout(keymap, key, components->layout);
+}
+
+XKB_EXPORT xkb_level_index_t
+xkb_state_components_key_get_level(struct xkb_keymap *keymap,
+                                   const struct xkb_state_components *components,
+                                   xkb_keycode_t kc,
+                                   xkb_layout_index_t layout)
+{
+    const struct xkb_key *key = XkbKey(keymap, kc);
+
+    if (!key || layout >= key->num_groups)
+        return XKB_LEVEL_INVALID;
+
+    return get_match_for_key(key, layout, components->mods).level;
+}
+
+XKB_EXPORT int
+xkb_state_components_key_get_syms(struct xkb_keymap *keymap,
+                                  const struct xkb_state_components *components,
+                                  xkb_keycode_t kc,
+                                  const xkb_keysym_t **syms_out)
+{
+    xkb_layout_index_t layout;
+    xkb_level_index_t level;
+
+    layout = xkb_state_components_key_get_layout(keymap, components, kc);
+    if (layout == XKB_LAYOUT_INVALID)
+        goto err;
+
+    level = xkb_state_components_key_get_level(keymap, components, kc, layout);
+    if (level == XKB_LEVEL_INVALID)
+        goto err;
+
+    return xkb_keymap_key_get_syms_by_level(keymap, kc, layout, level,
+                                            syms_out);
+
+err:
+    *syms_out = NULL;
+    return 0;
+}
+
+XKB_EXPORT xkb_mod_mask_t
+xkb_state_components_key_get_consumed_mods(struct xkb_keymap *keymap,
+                                           const struct xkb_state_components *components,
+                                           xkb_keycode_t kc,
+                                           enum xkb_consumed_mode mode)
+{
+    const struct xkb_key *key;
+
+    switch (mode) {
+    case XKB_CONSUMED_MODE_XKB:
+    case XKB_CONSUMED_MODE_GTK:
+        break;
+    default:
+        log_err_func(keymap->ctx,
+                     "unrecognized consumed modifiers mode: %d\n", mode);
+        return 0;
+    }
+
+    key = XkbKey(keymap, kc);
+    if (!key)
+        return 0;
+
+    return key_get_consumed_for(keymap, key, components->layout,
+                                components->mods, mode);
+}
@@ -21,6 +21,10 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <time.h>
+
 #include "utils.h"
 
 #ifdef HAVE_MMAP
@@ -28,8 +32,6 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <sys/mman.h>
-#include <sys/stat.h>
-#include <sys/types.h>
 
 bool
 map_file(FILE *file, char **string_out, size_t *size_out)
@@ -109,6 +111,34 @@ unmap_file(char *str, size_t size)
 
 #endif
 
+void
+file_stamp_set(struct file_stamp *stamp, const struct stat *st)
+{
+    stamp->ino = st->st_ino;
+    stamp->size = st->st_size;
+    stamp->mtime = st->st_mtime;
+}
+
+bool
+file_stamp_matches(const struct file_stamp *stamp, const struct stat *st)
+{
+    return stamp->ino == (uint64_t) st->st_ino &&
+           stamp->size == (uint64_t) st->st_size &&
+           stamp->mtime == (int64_t) st->st_mtime;
+}
+
+bool
+mtime_is_settled(int64_t mtime)
+{
+    return mtime < (int64_t) time(NULL) - 1;
+}
+
+bool
+fstat_settled(FILE *file, struct stat *st)
+{
+    return fstat(fileno(file), st) == 0 && mtime_is_settled(st->st_mtime);
+}
+
 // ASCII lower-case map.
 static const unsigned char lower_map[] = {
     0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20,
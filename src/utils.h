@@ -200,12 +200,91 @@ my_popcount(uint32_t x)
     return count;
 }
 
+/* The index of the lowest set bit; x must not be 0. */
+static inline int
+my_ctz(uint32_t x)
+{
+    int index;
+#if defined(HAVE___BUILTIN_CTZ)
+    index = __builtin_ctz(x);
+#else
+    for (index = 0; !(x & 1); index++)
+        x >>= 1;
+#endif
+    return index;
+}
+
+/*
+ * For the data which threads may share.  The loads acquire and the stores
+ * release; without threads they're plain accesses.
+ */
+#if defined(HAVE_PTHREADS)
+# define xkb_atomic_load(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+# define xkb_atomic_store(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+# define xkb_atomic_inc(p) __atomic_add_fetch((p), 1, __ATOMIC_RELAXED)
+# define xkb_atomic_dec(p) __atomic_sub_fetch((p), 1, __ATOMIC_ACQ_REL)
+# define xkb_atomic_add(p, v) __atomic_add_fetch((p), (v), __ATOMIC_RELAXED)
+#else
+# define xkb_atomic_load(p) (*(p))
+# define xkb_atomic_store(p, v) (*(p) = (v))
+# define xkb_atomic_inc(p) (++*(p))
+# define xkb_atomic_dec(p) (--*(p))
+# define xkb_atomic_add(p, v) (*(p) += (v))
+#endif
+
+/* Increments *refcnt unless it is 0, i.e. the object is being freed. */
+static inline bool
+xkb_atomic_ref_if_alive(int *refcnt)
+{
+#if defined(HAVE_PTHREADS)
+    int old = __atomic_load_n(refcnt, __ATOMIC_RELAXED);
+
+    do {
+        if (old == 0)
+            return false;
+    } while (!__atomic_compare_exchange_n(refcnt, &old, old + 1, true,
+                                          __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    return true;
+#else
+    if (*refcnt == 0)
+        return false;
+    ++*refcnt;
+    return true;
+#endif
+}
+
 bool
 map_file(FILE *file, char **string_out, size_t *size_out);
 
 void
 unmap_file(char *string, size_t size);
 
+struct stat;
+
+/* Tells a version of a file from the others, for the caches. */
+struct file_stamp {
+    uint64_t ino;
+    uint64_t size;
+    int64_t mtime;
+};
+
+void
+file_stamp_set(struct file_stamp *stamp, const struct stat *st);
+
+bool
+file_stamp_matches(const struct file_stamp *stamp, const struct stat *st);
+
+/*
+ * A file modified again within the same second may keep the same mtime and
+ * size, so the stamp of a file which was just written can't be trusted.
+ */
+bool
+mtime_is_settled(int64_t mtime);
+
+/* Stats the file, and returns whether its stamp can be trusted. */
+bool
+fstat_settled(FILE *file, struct stat *st);
+
 #define ARRAY_SIZE(arr) ((sizeof(arr) / sizeof(*(arr))))
 
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
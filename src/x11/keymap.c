@@ -1168,7 +1168,8 @@ xkb_x11_keymap_new_from_device(struct xkb_context *ctx,
         !get_indicator_map(keymap, conn, device_id) ||
         !get_compat_map(keymap, conn, device_id) ||
         !get_names(keymap, conn, device_id) ||
-        !get_controls(keymap, conn, device_id)) {
+        !get_controls(keymap, conn, device_id) ||
+        !xkb_keymap_finalize(keymap)) {
         xkb_keymap_unref(keymap);
         return NULL;
     }
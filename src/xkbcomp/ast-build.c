@@ -54,6 +54,7 @@
 #include "xkbcomp-priv.h"
 #include "ast-build.h"
 #include "include.h"
+#include "arena.h"
 
 ParseCommon *
 AppendStmt(ParseCommon *to, ParseCommon *append)
@@ -70,9 +71,10 @@ AppendStmt(ParseCommon *to, ParseCommon *append)
 }
 
 static ExprDef *
-ExprCreate(enum expr_op_type op, enum expr_value_type type, size_t size)
+ExprCreate(struct arena *arena, enum expr_op_type op,
+           enum expr_value_type type, size_t size)
 {
-    ExprDef *expr = malloc(size);
+    ExprDef *expr = arena_alloc(arena, size);
     if (!expr)
         return NULL;
 
@@ -85,12 +87,12 @@ ExprCreate(enum expr_op_type op, enum expr_value_type type, size_t size)
 }
 
 #define EXPR_CREATE(type_, name_, op_, value_type_) \
-    ExprDef *name_ = ExprCreate(op_, value_type_, sizeof(type_)); \
+    ExprDef *name_ = ExprCreate(arena, op_, value_type_, sizeof(type_)); \
     if (!name_) \
         return NULL;
 
 ExprDef *
-ExprCreateString(xkb_atom_t str)
+ExprCreateString(struct arena *arena, xkb_atom_t str)
 {
     EXPR_CREATE(ExprString, expr, EXPR_VALUE, EXPR_TYPE_STRING);
     expr->string.str = str;
@@ -98,7 +100,7 @@ ExprCreateString(xkb_atom_t str)
 }
 
 ExprDef *
-ExprCreateInteger(int ival)
+ExprCreateInteger(struct arena *arena, int ival)
 {
     EXPR_CREATE(ExprInteger, expr, EXPR_VALUE, EXPR_TYPE_INT);
     expr->integer.ival = ival;
@@ -106,7 +108,7 @@ ExprCreateInteger(int ival)
 }
 
 ExprDef *
-ExprCreateBoolean(bool set)
+ExprCreateBoolean(struct arena *arena, bool set)
 {
     EXPR_CREATE(ExprBoolean, expr, EXPR_VALUE, EXPR_TYPE_BOOLEAN);
     expr->boolean.set = set;
@@ -114,7 +116,7 @@ ExprCreateBoolean(bool set)
 }
 
 ExprDef *
-ExprCreateKeyName(xkb_atom_t key_name)
+ExprCreateKeyName(struct arena *arena, xkb_atom_t key_name)
 {
     EXPR_CREATE(ExprKeyName, expr, EXPR_VALUE, EXPR_TYPE_KEYNAME);
     expr->key_name.key_name = key_name;
@@ -122,7 +124,7 @@ ExprCreateKeyName(xkb_atom_t key_name)
 }
 
 ExprDef *
-ExprCreateIdent(xkb_atom_t ident)
+ExprCreateIdent(struct arena *arena, xkb_atom_t ident)
 {
     EXPR_CREATE(ExprIdent, expr, EXPR_IDENT, EXPR_TYPE_UNKNOWN);
     expr->ident.ident = ident;
@@ -130,8 +132,8 @@ ExprCreateIdent(xkb_atom_t ident)
 }
 
 ExprDef *
-ExprCreateUnary(enum expr_op_type op, enum expr_value_type type,
-                ExprDef *child)
+ExprCreateUnary(struct arena *arena, enum expr_op_type op,
+                enum expr_value_type type, ExprDef *child)
 {
     EXPR_CREATE(ExprUnary, expr, op, type);
     expr->unary.child = child;
@@ -139,7 +141,8 @@ ExprCreateUnary(enum expr_op_type op, enum expr_value_type type,
 }
 
 ExprDef *
-ExprCreateBinary(enum expr_op_type op, ExprDef *left, ExprDef *right)
+ExprCreateBinary(struct arena *arena, enum expr_op_type op,
+                 ExprDef *left, ExprDef *right)
 {
     EXPR_CREATE(ExprBinary, expr, op, EXPR_TYPE_UNKNOWN);
 
@@ -155,7 +158,7 @@ ExprCreateBinary(enum expr_op_type op, ExprDef *left, ExprDef *right)
 }
 
 ExprDef *
-ExprCreateFieldRef(xkb_atom_t element, xkb_atom_t field)
+ExprCreateFieldRef(struct arena *arena, xkb_atom_t element, xkb_atom_t field)
 {
     EXPR_CREATE(ExprFieldRef, expr, EXPR_FIELD_REF, EXPR_TYPE_UNKNOWN);
     expr->field_ref.element = element;
@@ -164,7 +167,8 @@ ExprCreateFieldRef(xkb_atom_t element, xkb_atom_t field)
 }
 
 ExprDef *
-ExprCreateArrayRef(xkb_atom_t element, xkb_atom_t field, ExprDef *entry)
+ExprCreateArrayRef(struct arena *arena, xkb_atom_t element, xkb_atom_t field,
+                   ExprDef *entry)
 {
     EXPR_CREATE(ExprArrayRef, expr, EXPR_ARRAY_REF, EXPR_TYPE_UNKNOWN);
     expr->array_ref.element = element;
@@ -174,7 +178,7 @@ ExprCreateArrayRef(xkb_atom_t element, xkb_atom_t field, ExprDef *entry)
 }
 
 ExprDef *
-ExprCreateAction(xkb_atom_t name, ExprDef *args)
+ExprCreateAction(struct arena *arena, xkb_atom_t name, ExprDef *args)
 {
     EXPR_CREATE(ExprAction, expr, EXPR_ACTION_DECL, EXPR_TYPE_UNKNOWN);
     expr->action.name = name;
@@ -183,7 +187,7 @@ ExprCreateAction(xkb_atom_t name, ExprDef *args)
 }
 
 ExprDef *
-ExprCreateKeysymList(xkb_keysym_t sym)
+ExprCreateKeysymList(struct arena *arena, xkb_keysym_t sym)
 {
     EXPR_CREATE(ExprKeysymList, expr, EXPR_KEYSYM_LIST, EXPR_TYPE_SYMBOLS);
 
@@ -191,20 +195,23 @@ ExprCreateKeysymList(xkb_keysym_t sym)
     darray_init(expr->keysym_list.symsMapIndex);
     darray_init(expr->keysym_list.symsNumEntries);
 
-    darray_append(expr->keysym_list.syms, sym);
-    darray_append(expr->keysym_list.symsMapIndex, 0);
-    darray_append(expr->keysym_list.symsNumEntries, 1);
+    arena_darray_append(arena, expr->keysym_list.syms, sym);
+    arena_darray_append(arena, expr->keysym_list.symsMapIndex, 0);
+    arena_darray_append(arena, expr->keysym_list.symsNumEntries, 1);
 
     return expr;
 }
 
 ExprDef *
-ExprCreateMultiKeysymList(ExprDef *expr)
+ExprCreateMultiKeysymList(struct arena *arena, ExprDef *expr)
 {
     unsigned nLevels = darray_size(expr->keysym_list.symsMapIndex);
 
-    darray_resize(expr->keysym_list.symsMapIndex, 1);
-    darray_resize(expr->keysym_list.symsNumEntries, 1);
+    (void) arena;
+
+    /* The items are in the arena, so only shrink these. */
+    darray_size(expr->keysym_list.symsMapIndex) = 1;
+    darray_size(expr->keysym_list.symsNumEntries) = 1;
     darray_item(expr->keysym_list.symsMapIndex, 0) = 0;
     darray_item(expr->keysym_list.symsNumEntries, 0) = nLevels;
 
@@ -212,38 +219,36 @@ ExprCreateMultiKeysymList(ExprDef *expr)
 }
 
 ExprDef *
-ExprAppendKeysymList(ExprDef *expr, xkb_keysym_t sym)
+ExprAppendKeysymList(struct arena *arena, ExprDef *expr, xkb_keysym_t sym)
 {
     unsigned nSyms = darray_size(expr->keysym_list.syms);
 
-    darray_append(expr->keysym_list.symsMapIndex, nSyms);
-    darray_append(expr->keysym_list.symsNumEntries, 1);
-    darray_append(expr->keysym_list.syms, sym);
+    arena_darray_append(arena, expr->keysym_list.symsMapIndex, nSyms);
+    arena_darray_append(arena, expr->keysym_list.symsNumEntries, 1);
+    arena_darray_append(arena, expr->keysym_list.syms, sym);
 
     return expr;
 }
 
 ExprDef *
-ExprAppendMultiKeysymList(ExprDef *expr, ExprDef *append)
+ExprAppendMultiKeysymList(struct arena *arena, ExprDef *expr, ExprDef *append)
 {
-    xkb_keysym_t *syms;
     unsigned nSyms = darray_size(expr->keysym_list.syms);
     unsigned numEntries = darray_size(append->keysym_list.syms);
+    xkb_keysym_t *sym;
 
-    darray_append(expr->keysym_list.symsMapIndex, nSyms);
-    darray_append(expr->keysym_list.symsNumEntries, numEntries);
-    darray_steal(append->keysym_list.syms, &syms, NULL);
-    darray_append_items(expr->keysym_list.syms, syms, numEntries);
-
-    FreeStmt((ParseCommon *) &append);
+    arena_darray_append(arena, expr->keysym_list.symsMapIndex, nSyms);
+    arena_darray_append(arena, expr->keysym_list.symsNumEntries, numEntries);
+    darray_foreach(sym, append->keysym_list.syms)
+        arena_darray_append(arena, expr->keysym_list.syms, *sym);
 
     return expr;
 }
 
 KeycodeDef *
-KeycodeCreate(xkb_atom_t name, int64_t value)
+KeycodeCreate(struct arena *arena, xkb_atom_t name, int64_t value)
 {
-    KeycodeDef *def = malloc(sizeof(*def));
+    KeycodeDef *def = arena_alloc(arena, sizeof(*def));
     if (!def)
         return NULL;
 
@@ -256,9 +261,9 @@ KeycodeCreate(xkb_atom_t name, int64_t value)
 }
 
 KeyAliasDef *
-KeyAliasCreate(xkb_atom_t alias, xkb_atom_t real)
+KeyAliasCreate(struct arena *arena, xkb_atom_t alias, xkb_atom_t real)
 {
-    KeyAliasDef *def = malloc(sizeof(*def));
+    KeyAliasDef *def = arena_alloc(arena, sizeof(*def));
     if (!def)
         return NULL;
 
@@ -271,9 +276,9 @@ KeyAliasCreate(xkb_atom_t alias, xkb_atom_t real)
 }
 
 VModDef *
-VModCreate(xkb_atom_t name, ExprDef *value)
+VModCreate(struct arena *arena, xkb_atom_t name, ExprDef *value)
 {
-    VModDef *def = malloc(sizeof(*def));
+    VModDef *def = arena_alloc(arena, sizeof(*def));
     if (!def)
         return NULL;
 
@@ -286,9 +291,9 @@ VModCreate(xkb_atom_t name, ExprDef *value)
 }
 
 VarDef *
-VarCreate(ExprDef *name, ExprDef *value)
+VarCreate(struct arena *arena, ExprDef *name, ExprDef *value)
 {
-    VarDef *def = malloc(sizeof(*def));
+    VarDef *def = arena_alloc(arena, sizeof(*def));
     if (!def)
         return NULL;
 
@@ -301,29 +306,21 @@ VarCreate(ExprDef *name, ExprDef *value)
 }
 
 VarDef *
-BoolVarCreate(xkb_atom_t ident, bool set)
+BoolVarCreate(struct arena *arena, xkb_atom_t ident, bool set)
 {
     ExprDef *name, *value;
-    VarDef *def;
-    if (!(name = ExprCreateIdent(ident))) {
-        return NULL;
-    }
-    if (!(value = ExprCreateBoolean(set))) {
-        FreeStmt((ParseCommon *) name);
-        return NULL;
-    }
-    if (!(def = VarCreate(name, value))) {
-        FreeStmt((ParseCommon *) name);
-        FreeStmt((ParseCommon *) value);
+
+    if (!(name = ExprCreateIdent(arena, ident)) ||
+        !(value = ExprCreateBoolean(arena, set)))
         return NULL;
-    }
-    return def;
+
+    return VarCreate(arena, name, value);
 }
 
 InterpDef *
-InterpCreate(xkb_keysym_t sym, ExprDef *match)
+InterpCreate(struct arena *arena, xkb_keysym_t sym, ExprDef *match)
 {
-    InterpDef *def = malloc(sizeof(*def));
+    InterpDef *def = arena_alloc(arena, sizeof(*def));
     if (!def)
         return NULL;
 
@@ -337,9 +334,9 @@ InterpCreate(xkb_keysym_t sym, ExprDef *match)
 }
 
 KeyTypeDef *
-KeyTypeCreate(xkb_atom_t name, VarDef *body)
+KeyTypeCreate(struct arena *arena, xkb_atom_t name, VarDef *body)
 {
-    KeyTypeDef *def = malloc(sizeof(*def));
+    KeyTypeDef *def = arena_alloc(arena, sizeof(*def));
     if (!def)
         return NULL;
 
@@ -353,9 +350,9 @@ KeyTypeCreate(xkb_atom_t name, VarDef *body)
 }
 
 SymbolsDef *
-SymbolsCreate(xkb_atom_t keyName, VarDef *symbols)
+SymbolsCreate(struct arena *arena, xkb_atom_t keyName, VarDef *symbols)
 {
-    SymbolsDef *def = malloc(sizeof(*def));
+    SymbolsDef *def = arena_alloc(arena, sizeof(*def));
     if (!def)
         return NULL;
 
@@ -369,9 +366,9 @@ SymbolsCreate(xkb_atom_t keyName, VarDef *symbols)
 }
 
 GroupCompatDef *
-GroupCompatCreate(unsigned group, ExprDef *val)
+GroupCompatCreate(struct arena *arena, unsigned group, ExprDef *val)
 {
-    GroupCompatDef *def = malloc(sizeof(*def));
+    GroupCompatDef *def = arena_alloc(arena, sizeof(*def));
     if (!def)
         return NULL;
 
@@ -385,9 +382,9 @@ GroupCompatCreate(unsigned group, ExprDef *val)
 }
 
 ModMapDef *
-ModMapCreate(xkb_atom_t modifier, ExprDef *keys)
+ModMapCreate(struct arena *arena, xkb_atom_t modifier, ExprDef *keys)
 {
-    ModMapDef *def = malloc(sizeof(*def));
+    ModMapDef *def = arena_alloc(arena, sizeof(*def));
     if (!def)
         return NULL;
 
@@ -401,9 +398,9 @@ ModMapCreate(xkb_atom_t modifier, ExprDef *keys)
 }
 
 LedMapDef *
-LedMapCreate(xkb_atom_t name, VarDef *body)
+LedMapCreate(struct arena *arena, xkb_atom_t name, VarDef *body)
 {
-    LedMapDef *def = malloc(sizeof(*def));
+    LedMapDef *def = arena_alloc(arena, sizeof(*def));
     if (!def)
         return NULL;
 
@@ -417,9 +414,9 @@ LedMapCreate(xkb_atom_t name, VarDef *body)
 }
 
 LedNameDef *
-LedNameCreate(unsigned ndx, ExprDef *name, bool virtual)
+LedNameCreate(struct arena *arena, unsigned ndx, ExprDef *name, bool virtual)
 {
-    LedNameDef *def = malloc(sizeof(*def));
+    LedNameDef *def = arena_alloc(arena, sizeof(*def));
     if (!def)
         return NULL;
 
@@ -433,11 +430,17 @@ LedNameCreate(unsigned ndx, ExprDef *name, bool virtual)
     return def;
 }
 
-static void
-FreeInclude(IncludeStmt *incl);
+static char *
+arena_steal(struct arena *arena, char *s)
+{
+    char *copy = arena_strdup(arena, s);
+    free(s);
+    return copy;
+}
 
 IncludeStmt *
-IncludeCreate(struct xkb_context *ctx, char *str, enum merge_mode merge)
+IncludeCreate(struct xkb_context *ctx, struct arena *arena, char *str,
+              enum merge_mode merge)
 {
     IncludeStmt *incl, *first;
     char *file, *map, *stmt, *tmp, *extra_data;
@@ -446,7 +449,7 @@ IncludeCreate(struct xkb_context *ctx, char *str, enum merge_mode merge)
     incl = first = NULL;
     file = map = NULL;
     tmp = str;
-    stmt = strdup_safe(str);
+    stmt = arena_strdup(arena, str);
     while (tmp && *tmp)
     {
         if (!ParseIncludeMap(&tmp, &file, &map, &nextop, &extra_data))
@@ -466,22 +469,26 @@ IncludeCreate(struct xkb_context *ctx, char *str, enum merge_mode merge)
         }
 
         if (first == NULL) {
-            first = incl = malloc(sizeof(*first));
+            first = incl = arena_alloc(arena, sizeof(*first));
         } else {
-            incl->next_incl = malloc(sizeof(*first));
+            incl->next_incl = arena_alloc(arena, sizeof(*first));
             incl = incl->next_incl;
         }
 
-        if (!incl)
+        if (!incl) {
+            free(file);
+            free(map);
+            free(extra_data);
             break;
+        }
 
         incl->common.type = STMT_INCLUDE;
         incl->common.next = NULL;
         incl->merge = merge;
         incl->stmt = NULL;
-        incl->file = file;
-        incl->map = map;
-        incl->modifier = extra_data;
+        incl->file = arena_steal(arena, file);
+        incl->map = arena_steal(arena, map);
+        incl->modifier = arena_steal(arena, extra_data);
         incl->next_incl = NULL;
 
         if (nextop == '|')
@@ -492,31 +499,27 @@ IncludeCreate(struct xkb_context *ctx, char *str, enum merge_mode merge)
 
     if (first)
         first->stmt = stmt;
-    else
-        free(stmt);
 
     return first;
 
 err:
     log_err(ctx, "Illegal include statement \"%s\"; Ignored\n", stmt);
-    FreeInclude(first);
-    free(stmt);
     return NULL;
 }
 
 XkbFile *
-XkbFileCreate(enum xkb_file_type type, char *name, ParseCommon *defs,
-              enum xkb_map_flags flags)
+XkbFileCreate(struct arena *arena, enum xkb_file_type type, char *name,
+              ParseCommon *defs, enum xkb_map_flags flags)
 {
     XkbFile *file;
 
-    file = calloc(1, sizeof(*file));
+    file = arena_calloc(arena, sizeof(*file));
     if (!file)
         return NULL;
 
     XkbEscapeMapName(name);
     file->file_type = type;
-    file->name = name ? name : strdup("(unnamed)");
+    file->name = name ? name : arena_strdup(arena, "(unnamed)");
     file->defs = defs;
     file->flags = flags;
 
@@ -535,180 +538,41 @@ XkbFileFromComponents(struct xkb_context *ctx,
     IncludeStmt *include = NULL;
     XkbFile *file = NULL;
     ParseCommon *defs = NULL;
+    struct arena *arena;
+
+    arena = arena_new();
+    if (!arena)
+        return NULL;
 
     for (type = FIRST_KEYMAP_FILE_TYPE; type <= LAST_KEYMAP_FILE_TYPE; type++) {
-        include = IncludeCreate(ctx, components[type], MERGE_DEFAULT);
+        include = IncludeCreate(ctx, arena, components[type], MERGE_DEFAULT);
         if (!include)
             goto err;
 
-        file = XkbFileCreate(type, NULL, (ParseCommon *) include, 0);
-        if (!file) {
-            FreeInclude(include);
+        file = XkbFileCreate(arena, type, NULL, (ParseCommon *) include, 0);
+        if (!file)
             goto err;
-        }
 
         defs = AppendStmt(defs, &file->common);
     }
 
-    file = XkbFileCreate(FILE_TYPE_KEYMAP, NULL, defs, 0);
+    file = XkbFileCreate(arena, FILE_TYPE_KEYMAP, NULL, defs, 0);
     if (!file)
         goto err;
 
+    file->arena = arena;
     return file;
 
 err:
-    FreeXkbFile((XkbFile *) defs);
+    arena_free(arena);
     return NULL;
 }
 
-static void
-FreeExpr(ExprDef *expr)
-{
-    if (!expr)
-        return;
-
-    switch (expr->expr.op) {
-    case EXPR_ACTION_LIST:
-    case EXPR_NEGATE:
-    case EXPR_UNARY_PLUS:
-    case EXPR_NOT:
-    case EXPR_INVERT:
-        FreeStmt((ParseCommon *) expr->unary.child);
-        break;
-
-    case EXPR_DIVIDE:
-    case EXPR_ADD:
-    case EXPR_SUBTRACT:
-    case EXPR_MULTIPLY:
-    case EXPR_ASSIGN:
-        FreeStmt((ParseCommon *) expr->binary.left);
-        FreeStmt((ParseCommon *) expr->binary.right);
-        break;
-
-    case EXPR_ACTION_DECL:
-        FreeStmt((ParseCommon *) expr->action.args);
-        break;
-
-    case EXPR_ARRAY_REF:
-        FreeStmt((ParseCommon *) expr->array_ref.entry);
-        break;
-
-    case EXPR_KEYSYM_LIST:
-        darray_free(expr->keysym_list.syms);
-        darray_free(expr->keysym_list.symsMapIndex);
-        darray_free(expr->keysym_list.symsNumEntries);
-        break;
-
-    default:
-        break;
-    }
-}
-
-static void
-FreeInclude(IncludeStmt *incl)
-{
-    IncludeStmt *next;
-
-    while (incl)
-    {
-        next = incl->next_incl;
-
-        free(incl->file);
-        free(incl->map);
-        free(incl->modifier);
-        free(incl->stmt);
-
-        free(incl);
-        incl = next;
-    }
-}
-
-void
-FreeStmt(ParseCommon *stmt)
-{
-    ParseCommon *next;
-
-    while (stmt)
-    {
-        next = stmt->next;
-
-        switch (stmt->type) {
-        case STMT_INCLUDE:
-            FreeInclude((IncludeStmt *) stmt);
-            /* stmt is already free'd here. */
-            stmt = NULL;
-            break;
-        case STMT_EXPR:
-            FreeExpr((ExprDef *) stmt);
-            break;
-        case STMT_VAR:
-            FreeStmt((ParseCommon *) ((VarDef *) stmt)->name);
-            FreeStmt((ParseCommon *) ((VarDef *) stmt)->value);
-            break;
-        case STMT_TYPE:
-            FreeStmt((ParseCommon *) ((KeyTypeDef *) stmt)->body);
-            break;
-        case STMT_INTERP:
-            FreeStmt((ParseCommon *) ((InterpDef *) stmt)->match);
-            FreeStmt((ParseCommon *) ((InterpDef *) stmt)->def);
-            break;
-        case STMT_VMOD:
-            FreeStmt((ParseCommon *) ((VModDef *) stmt)->value);
-            break;
-        case STMT_SYMBOLS:
-            FreeStmt((ParseCommon *) ((SymbolsDef *) stmt)->symbols);
-            break;
-        case STMT_MODMAP:
-            FreeStmt((ParseCommon *) ((ModMapDef *) stmt)->keys);
-            break;
-        case STMT_GROUP_COMPAT:
-            FreeStmt((ParseCommon *) ((GroupCompatDef *) stmt)->def);
-            break;
-        case STMT_LED_MAP:
-            FreeStmt((ParseCommon *) ((LedMapDef *) stmt)->body);
-            break;
-        case STMT_LED_NAME:
-            FreeStmt((ParseCommon *) ((LedNameDef *) stmt)->name);
-            break;
-        default:
-            break;
-        }
-
-        free(stmt);
-        stmt = next;
-    }
-}
-
 void
 FreeXkbFile(XkbFile *file)
 {
-    XkbFile *next;
-
-    while (file)
-    {
-        next = (XkbFile *) file->common.next;
-
-        switch (file->file_type) {
-        case FILE_TYPE_KEYMAP:
-            FreeXkbFile((XkbFile *) file->defs);
-            break;
-
-        case FILE_TYPE_TYPES:
-        case FILE_TYPE_COMPAT:
-        case FILE_TYPE_SYMBOLS:
-        case FILE_TYPE_KEYCODES:
-        case FILE_TYPE_GEOMETRY:
-            FreeStmt(file->defs);
-            break;
-
-        default:
-            break;
-        }
-
-        free(file->name);
-        free(file);
-        file = next;
-    }
+    if (file)
+        arena_free(file->arena);
 }
 
 static const char *xkb_file_type_strings[_FILE_TYPE_NUM_ENTRIES] = {
@@ -221,6 +221,7 @@ typedef struct {
     ExprDef *args;
 } ExprAction;
 
+/* The arrays are in the file's arena; see arena_darray_append(). */
 typedef struct {
     ExprCommon expr;
     darray(xkb_keysym_t) syms;
@@ -335,12 +336,18 @@ enum xkb_map_flags {
     MAP_IS_ALTGR = (1 << 7),
 };
 
+/*
+ * All of a parsed file, down to its strings, is allocated in its arena, and
+ * freed at once with FreeXkbFile().  The maps of a keymap file share the
+ * keymap's arena, and don't own it.
+ */
 typedef struct {
     ParseCommon common;
     enum xkb_file_type file_type;
     char *name;
     ParseCommon *defs;
     enum xkb_map_flags flags;
+    struct arena *arena;
 } XkbFile;
 
 #endif
@@ -427,8 +427,7 @@ HandleIncludeCompatMap(CompatInfo *info, IncludeStmt *include)
     CompatInfo included;
 
     InitCompatInfo(&included, info->ctx, info->actions, &info->mods);
-    included.name = include->stmt;
-    include->stmt = NULL;
+    included.name = strdup_safe(include->stmt);
 
     for (IncludeStmt *stmt = include; stmt; stmt = stmt->next_incl) {
         CompatInfo next_incl;
@@ -452,7 +451,6 @@ HandleIncludeCompatMap(CompatInfo *info, IncludeStmt *include)
         MergeIncludedCompatMaps(&included, &next_incl, stmt->merge);
 
         ClearCompatInfo(&next_incl);
-        FreeXkbFile(file);
     }
 
     MergeIncludedCompatMaps(info, &included, include->merge);
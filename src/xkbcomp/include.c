@@ -47,12 +47,17 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
 #include <errno.h>
 #include <limits.h>
 #include <stdio.h>
+#include <unistd.h>
 
 #include "xkbcomp-priv.h"
 #include "include.h"
+#include "keymap-cache.h"
 
 /**
  * Parse an include statement. Each call returns a file name, along with
@@ -193,6 +198,195 @@ DirectoryForInclude(enum xkb_file_type type)
     return xkb_file_type_include_dirs[type];
 }
 
+/*
+ * The listings of the directories searched for include files, so that a
+ * file missing from the first include paths doesn't cost a failed open in
+ * each of them every time.  A directory which doesn't exist is remembered
+ * too.  The directories are checked again, against their mtime, once per
+ * keymap; see RecheckIncludeDirs().
+ */
+struct include_dir {
+    char *path;
+    /* The generation of the cache in which it was last checked. */
+    unsigned int generation;
+    bool exists;
+    /* Whether names holds the entries of the directory, sorted. */
+    bool listed;
+    uint64_t ino;
+    int64_t mtime;
+    darray(char *) names;
+};
+
+struct include_dir_cache {
+    darray(struct include_dir) dirs;
+    unsigned int generation;
+};
+
+static struct include_dir_cache *
+GetIncludeDirCache(struct xkb_context *ctx)
+{
+    if (!ctx->include_dirs) {
+        ctx->include_dirs = calloc(1, sizeof(*ctx->include_dirs));
+        if (ctx->include_dirs)
+            ctx->include_dirs->generation = 1;
+    }
+
+    return ctx->include_dirs;
+}
+
+static void
+ClearIncludeDir(struct include_dir *dir)
+{
+    char **name;
+
+    darray_foreach(name, dir->names)
+        free(*name);
+    darray_free(dir->names);
+    dir->listed = false;
+}
+
+void
+include_dir_cache_free(struct include_dir_cache *cache)
+{
+    struct include_dir *dir;
+
+    if (!cache)
+        return;
+
+    darray_foreach(dir, cache->dirs) {
+        ClearIncludeDir(dir);
+        free(dir->path);
+    }
+    darray_free(cache->dirs);
+    free(cache);
+}
+
+static int
+CompareNames(const void *a, const void *b)
+{
+    return strcmp(*(char *const *) a, *(char *const *) b);
+}
+
+/* Lists the directory again if it changed. */
+static void
+CheckIncludeDir(struct xkb_context *ctx, struct include_dir *dir)
+{
+    struct stat st;
+    struct dirent *ent;
+    DIR *d;
+
+    ctx->include_dir_checks++;
+
+    if (stat(dir->path, &st) != 0) {
+        ClearIncludeDir(dir);
+        /* Otherwise, it's unknown. */
+        dir->exists = (errno != ENOENT && errno != ENOTDIR);
+        return;
+    }
+
+    if (dir->exists && dir->listed &&
+        dir->ino == (uint64_t) st.st_ino &&
+        dir->mtime == (int64_t) st.st_mtime)
+        return;
+
+    ClearIncludeDir(dir);
+    dir->exists = true;
+    dir->ino = st.st_ino;
+    dir->mtime = st.st_mtime;
+
+    /* Otherwise an entry added in the same second could be missed. */
+    if (!mtime_is_settled(st.st_mtime))
+        return;
+
+    d = opendir(dir->path);
+    if (!d)
+        return;
+
+    while ((ent = readdir(d))) {
+        char *name = strdup(ent->d_name);
+
+        if (!name) {
+            ClearIncludeDir(dir);
+            closedir(d);
+            return;
+        }
+        darray_append(dir->names, name);
+    }
+    closedir(d);
+
+    qsort(dir->names.item, darray_size(dir->names), sizeof(char *),
+          CompareNames);
+    dir->listed = true;
+}
+
+/*
+ * Returns true if the file at path, of which the first dir_len characters
+ * are its directory, is known not to exist.
+ */
+static bool
+IncludeFileIsMissing(struct xkb_context *ctx, const char *path,
+                     size_t dir_len)
+{
+    struct include_dir_cache *cache;
+    struct include_dir *dir = NULL, new_dir = { 0 };
+    const char *name = path + dir_len + 1;
+    bool missing = false;
+
+    if (*name == '\0')
+        return false;
+
+    xkb_context_lock(ctx);
+
+    cache = GetIncludeDirCache(ctx);
+    if (!cache)
+        goto out;
+
+    for (unsigned i = 0; i < darray_size(cache->dirs); i++) {
+        struct include_dir *d = &darray_item(cache->dirs, i);
+
+        if (strncmp(d->path, path, dir_len) == 0 &&
+            d->path[dir_len] == '\0') {
+            dir = d;
+            break;
+        }
+    }
+
+    if (!dir) {
+        new_dir.path = strndup(path, dir_len);
+        if (!new_dir.path)
+            goto out;
+        darray_append(cache->dirs, new_dir);
+        dir = &darray_item(cache->dirs, darray_size(cache->dirs) - 1);
+    }
+
+    if (dir->generation != cache->generation) {
+        CheckIncludeDir(ctx, dir);
+        dir->generation = cache->generation;
+    }
+
+    if (!dir->exists)
+        missing = true;
+    else if (dir->listed)
+        missing = !bsearch(&name, dir->names.item, darray_size(dir->names),
+                           sizeof(char *), CompareNames);
+
+    if (missing)
+        ctx->include_opens_avoided++;
+
+out:
+    xkb_context_unlock(ctx);
+    return missing;
+}
+
+void
+RecheckIncludeDirs(struct xkb_context *ctx)
+{
+    xkb_context_lock(ctx);
+    if (ctx->include_dirs)
+        ctx->include_dirs->generation++;
+    xkb_context_unlock(ctx);
+}
+
 FILE *
 FindFileInXkbPath(struct xkb_context *ctx, const char *name,
                   enum xkb_file_type type, char **pathRtrn)
@@ -231,7 +425,13 @@ FindFileInXkbPath(struct xkb_context *ctx, const char *name,
             continue;
         }
 
+        if (IncludeFileIsMissing(ctx, buf, strrchr(buf, '/') - buf)) {
+            keymap_cache_note_file(ctx, buf, NULL);
+            continue;
+        }
+
         file = fopen(buf, "r");
+        keymap_cache_note_file(ctx, buf, file);
         if (file)
             break;
     }
@@ -270,19 +470,310 @@ FindFileInXkbPath(struct xkb_context *ctx, const char *name,
     return file;
 }
 
+/*
+ * Parsed files are cached on the context, keyed by their path and map, and
+ * valid as long as the file is unchanged.  The ASTs are shared by all the
+ * include statements which name them, so they must not be modified.
+ */
+struct parsed_file {
+    char *path;
+    char *map;
+    struct file_stamp stamp;
+    XkbFile *file;
+};
+
+struct indexed_file {
+    char *path;
+    struct file_stamp stamp;
+    /* Empty if the file can't be indexed. */
+    darray_map_location maps;
+};
+
+struct parsed_file_cache {
+    darray(struct parsed_file) files;
+    /*
+     * Files which can't be cached, or were replaced after changing.  They
+     * may still be in use by an including file, so keep them until no
+     * compile is in progress.
+     */
+    darray(XkbFile *) retired;
+    /* The maps in each file, so that the others needn't be parsed. */
+    darray(struct indexed_file) indexes;
+};
+
+static bool
+parsed_file_matches(const struct parsed_file *parsed, const char *path,
+                    const char *map)
+{
+    if (!streq(parsed->path, path))
+        return false;
+    if (!parsed->map || !map)
+        return parsed->map == map;
+    return streq(parsed->map, map);
+}
+
+static bool
+parsed_file_is_current(const struct parsed_file *parsed, const struct stat *st)
+{
+    return parsed->file && file_stamp_matches(&parsed->stamp, st);
+}
+
+static struct parsed_file *
+FindParsedFile(struct parsed_file_cache *cache, const char *path,
+               const char *map)
+{
+    struct parsed_file *parsed;
+
+    darray_foreach(parsed, cache->files)
+        if (parsed_file_matches(parsed, path, map))
+            return parsed;
+
+    return NULL;
+}
+
+/*
+ * Puts a newly parsed file in the cache, in place of entry if not NULL.
+ * Without st, the file is not cacheable and is only kept alive.
+ */
+static void
+StoreParsedFile(struct parsed_file_cache *cache, struct parsed_file *entry,
+                const char *path, const char *map, const struct stat *st,
+                XkbFile *xkb_file)
+{
+    struct parsed_file new_entry = { 0 };
+
+    if (entry && entry->file) {
+        darray_append(cache->retired, entry->file);
+        entry->file = NULL;
+    }
+
+    if (st && !entry) {
+        new_entry.path = strdup(path);
+        new_entry.map = strdup_safe(map);
+        if (new_entry.path && (new_entry.map || !map)) {
+            darray_append(cache->files, new_entry);
+            entry = &darray_item(cache->files, darray_size(cache->files) - 1);
+        }
+        else {
+            free(new_entry.path);
+            free(new_entry.map);
+        }
+    }
+
+    if (!st || !entry) {
+        darray_append(cache->retired, xkb_file);
+        return;
+    }
+
+    file_stamp_set(&entry->stamp, st);
+    entry->file = xkb_file;
+}
+
+static const darray_map_location *
+LookupMapIndex(const struct parsed_file_cache *cache, const char *path,
+               const struct stat *st)
+{
+    const struct indexed_file *indexed;
+
+    darray_foreach(indexed, cache->indexes)
+        if (streq(indexed->path, path) &&
+            file_stamp_matches(&indexed->stamp, st))
+            return &indexed->maps;
+
+    return NULL;
+}
+
+/*
+ * Puts the index of a file in the cache, taking ownership of maps.  Returns
+ * NULL if it couldn't, in which case maps is left to the caller.
+ */
+static const darray_map_location *
+StoreMapIndex(struct parsed_file_cache *cache, const char *path,
+              const struct stat *st, darray_map_location *maps)
+{
+    struct indexed_file *indexed, new_indexed = { 0 };
+
+    darray_foreach(indexed, cache->indexes) {
+        if (streq(indexed->path, path)) {
+            darray_free(indexed->maps);
+            new_indexed.path = indexed->path;
+            *indexed = new_indexed;
+            break;
+        }
+    }
+
+    if (!new_indexed.path) {
+        new_indexed.path = strdup(path);
+        if (!new_indexed.path)
+            return NULL;
+        darray_append(cache->indexes, new_indexed);
+        indexed = &darray_item(cache->indexes, darray_size(cache->indexes) - 1);
+    }
+
+    file_stamp_set(&indexed->stamp, st);
+    indexed->maps = *maps;
+    return &indexed->maps;
+}
+
+static const darray_map_location *
+GetMapIndex(struct parsed_file_cache *cache, const char *path,
+            const struct stat *st, const char *string, size_t size,
+            darray_map_location *uncached)
+{
+    const darray_map_location *index;
+    darray_map_location maps = darray_new();
+
+    /* Not cacheable. */
+    if (!st) {
+        XkbIndexMaps(string, size, uncached);
+        return uncached;
+    }
+
+    index = LookupMapIndex(cache, path, st);
+    if (index)
+        return index;
+
+    XkbIndexMaps(string, size, &maps);
+    index = StoreMapIndex(cache, path, st, &maps);
+    if (!index) {
+        *uncached = maps;
+        return uncached;
+    }
+
+    return index;
+}
+
+static struct parsed_file_cache *
+GetParsedFileCache(struct xkb_context *ctx)
+{
+    if (!ctx->parsed_files)
+        ctx->parsed_files = calloc(1, sizeof(*ctx->parsed_files));
+
+    return ctx->parsed_files;
+}
+
+static XkbFile *
+ParseIncludeFile(struct xkb_context *ctx, FILE *file, const char *path,
+                 IncludeStmt *stmt)
+{
+    struct parsed_file_cache *cache;
+    struct parsed_file *entry;
+    darray_map_location uncached = darray_new();
+    const darray_map_location *index;
+    XkbFile *xkb_file = NULL;
+    struct stat st;
+    bool cacheable;
+    char *string;
+    size_t size;
+
+    cacheable = fstat_settled(file, &st);
+
+    xkb_context_lock(ctx);
+    cache = GetParsedFileCache(ctx);
+    entry = cache ? FindParsedFile(cache, path, stmt->map) : NULL;
+    if (entry && cacheable && parsed_file_is_current(entry, &st)) {
+        ctx->parsed_file_hits++;
+        xkb_file = entry->file;
+    }
+    else if (cache) {
+        ctx->parsed_file_misses++;
+    }
+    xkb_context_unlock(ctx);
+
+    if (!cache || xkb_file)
+        return xkb_file;
+
+    if (!map_file(file, &string, &size)) {
+        log_err(ctx, "Couldn't read XKB file %s: %s\n",
+                stmt->file, strerror(errno));
+        return NULL;
+    }
+
+    xkb_context_lock(ctx);
+    index = GetMapIndex(cache, path, cacheable ? &st : NULL,
+                        string, size, &uncached);
+    /* Another thread may replace it while this one parses. */
+    if (ctx->thread_safe && index != &uncached) {
+        darray_copy(uncached, *index);
+        index = &uncached;
+    }
+    xkb_context_unlock(ctx);
+
+    xkb_file = XkbParseIndexedString(ctx, string, size, index,
+                                     stmt->file, stmt->map);
+    darray_free(uncached);
+    unmap_file(string, size);
+    if (!xkb_file)
+        return NULL;
+
+    /* Another thread may have changed the cache in the meantime. */
+    xkb_context_lock(ctx);
+    entry = FindParsedFile(cache, path, stmt->map);
+    StoreParsedFile(cache, entry, path, stmt->map,
+                    cacheable ? &st : NULL, xkb_file);
+    xkb_context_unlock(ctx);
+    return xkb_file;
+}
+
+void
+parsed_file_cache_free_retired(struct parsed_file_cache *cache)
+{
+    XkbFile **file;
+
+    if (!cache)
+        return;
+
+    darray_foreach(file, cache->retired)
+        FreeXkbFile(*file);
+    darray_free(cache->retired);
+}
+
+void
+parsed_file_cache_free(struct parsed_file_cache *cache)
+{
+    struct parsed_file *parsed;
+    struct indexed_file *indexed;
+
+    if (!cache)
+        return;
+
+    darray_foreach(parsed, cache->files) {
+        free(parsed->path);
+        free(parsed->map);
+        FreeXkbFile(parsed->file);
+    }
+    darray_free(cache->files);
+
+    parsed_file_cache_free_retired(cache);
+
+    darray_foreach(indexed, cache->indexes) {
+        free(indexed->path);
+        darray_free(indexed->maps);
+    }
+    darray_free(cache->indexes);
+
+    free(cache);
+}
+
+/*
+ * The returned file is owned by the context's cache, and is shared with the
+ * other includes of the same map; don't free or modify it.
+ */
 XkbFile *
 ProcessIncludeFile(struct xkb_context *ctx, IncludeStmt *stmt,
                    enum xkb_file_type file_type)
 {
     FILE *file;
     XkbFile *xkb_file;
+    char *path;
 
-    file = FindFileInXkbPath(ctx, stmt->file, file_type, NULL);
+    file = FindFileInXkbPath(ctx, stmt->file, file_type, &path);
     if (!file)
         return false;
 
-    xkb_file = XkbParseFile(ctx, file, stmt->file, stmt->map);
+    xkb_file = ParseIncludeFile(ctx, file, path, stmt);
     fclose(file);
+    free(path);
     if (!xkb_file) {
         if (stmt->map)
             log_err(ctx, "Couldn't process include statement for '%s(%s)'\n",
@@ -299,7 +790,6 @@ ProcessIncludeFile(struct xkb_context *ctx, IncludeStmt *stmt,
                 "Include file \"%s\" ignored\n",
                 xkb_file_type_to_string(file_type),
                 xkb_file_type_to_string(xkb_file->file_type), stmt->file);
-        FreeXkbFile(xkb_file);
         return NULL;
     }
 
@@ -307,3 +797,357 @@ ProcessIncludeFile(struct xkb_context *ctx, IncludeStmt *stmt,
 
     return xkb_file;
 }
+
+#ifdef HAVE_PTHREADS
+
+/*
+ * Parsing the files included by a keymap on worker threads, to fill the
+ * cache before the keymap is compiled as usual.
+ *
+ * The workers don't modify the context: each has a context of its own,
+ * which only shares the include paths, the atom table, made for that, and
+ * the include directory cache, under a lock.  Their log function only
+ * notes that something was logged, and such a file is left for the compiler to parse
+ * again, so that the messages are the same as without the workers.  The
+ * cache is only read while they run, and the calling thread adds their
+ * results to it at the end.
+ */
+
+#define MAX_PREFETCH_THREADS 8
+
+struct prefetch_job {
+    enum xkb_file_type type;
+    /* Borrowed from the AST with the include statement. */
+    const char *file;
+    const char *map;
+
+    /* The result, if the file was parsed. */
+    char *path;
+    struct stat st;
+    XkbFile *xkb_file;
+    /* The index of the file, and whether it was missing from the cache. */
+    darray_map_location maps;
+    bool indexed;
+};
+
+struct prefetch {
+    struct parsed_file_cache *cache;
+    /* For the caches, if the context has no lock of its own. */
+    pthread_mutex_t cache_lock;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    darray(struct prefetch_job) jobs;
+    /* The next job to run, and the number of jobs running. */
+    unsigned int next;
+    unsigned int running;
+};
+
+struct prefetch_worker {
+    /* Must be first, see prefetch_log(). */
+    struct xkb_context ctx;
+    struct prefetch *prefetch;
+    pthread_t thread;
+    bool logged;
+};
+
+ATTR_PRINTF(3, 0) static void
+prefetch_log(struct xkb_context *ctx, enum xkb_log_level level,
+             const char *fmt, va_list args)
+{
+    struct prefetch_worker *worker = (struct prefetch_worker *) ctx;
+
+    worker->logged = true;
+}
+
+static bool
+prefetch_job_matches(const struct prefetch_job *job, enum xkb_file_type type,
+                     const IncludeStmt *include)
+{
+    if (job->type != type || !streq(job->file, include->file))
+        return false;
+    if (!job->map || !include->map)
+        return job->map == include->map;
+    return streq(job->map, include->map);
+}
+
+/* Adds the files included by xkb_file which aren't queued already. */
+static void
+prefetch_add_includes(struct prefetch *prefetch, enum xkb_file_type type,
+                      const XkbFile *xkb_file)
+{
+    const ParseCommon *stmt;
+    const IncludeStmt *include;
+    const struct prefetch_job *job;
+
+    for (stmt = xkb_file->defs; stmt; stmt = stmt->next) {
+        if (stmt->type != STMT_INCLUDE)
+            continue;
+
+        for (include = (const IncludeStmt *) stmt; include;
+             include = include->next_incl) {
+            struct prefetch_job new_job = {
+                .type = type,
+                .file = include->file,
+                .map = include->map,
+            };
+            bool queued = false;
+
+            darray_foreach(job, prefetch->jobs) {
+                if (prefetch_job_matches(job, type, include)) {
+                    queued = true;
+                    break;
+                }
+            }
+
+            if (!queued)
+                darray_append(prefetch->jobs, new_job);
+        }
+    }
+}
+
+/*
+ * Returns the AST of the job's file, parsed or from the cache, for its
+ * includes to be queued.
+ */
+static const XkbFile *
+prefetch_run_job(struct prefetch_worker *worker, struct prefetch_job *job)
+{
+    struct xkb_context *ctx = &worker->ctx;
+    struct parsed_file_cache *cache = worker->prefetch->cache;
+    darray_map_location maps = darray_new();
+    const darray_map_location *index;
+    const struct parsed_file *entry;
+    XkbFile *xkb_file = NULL;
+    struct stat st;
+    bool indexed = false;
+    char *path, *string;
+    size_t size;
+    FILE *file;
+
+    file = FindFileInXkbPath(ctx, job->file, job->type, &path);
+    if (!file)
+        return NULL;
+
+    /* The compiler wouldn't use the cache for it either. */
+    if (!fstat_settled(file, &st))
+        goto out;
+
+    /* With XKB_CONTEXT_THREAD_SAFE, other keymaps may be using the cache. */
+    xkb_context_lock(ctx);
+    entry = FindParsedFile(cache, path, job->map);
+    index = LookupMapIndex(cache, path, &st);
+    if (entry && parsed_file_is_current(entry, &st))
+        xkb_file = entry->file;
+    else if (index)
+        darray_copy(maps, *index);
+    else
+        indexed = true;
+    xkb_context_unlock(ctx);
+
+    if (xkb_file || !map_file(file, &string, &size))
+        goto out;
+
+    if (indexed)
+        XkbIndexMaps(string, size, &maps);
+
+    worker->logged = false;
+    xkb_file = XkbParseIndexedString(ctx, string, size, &maps,
+                                     job->file, job->map);
+    unmap_file(string, size);
+
+    if (xkb_file && worker->logged) {
+        FreeXkbFile(xkb_file);
+        xkb_file = NULL;
+    }
+
+    if (xkb_file) {
+        job->path = path;
+        job->st = st;
+        job->xkb_file = xkb_file;
+        job->indexed = indexed;
+        job->maps = maps;
+        darray_init(maps);
+        path = NULL;
+    }
+    darray_free(maps);
+
+out:
+    free(path);
+    fclose(file);
+    return xkb_file;
+}
+
+static void *
+prefetch_worker_run(void *data)
+{
+    struct prefetch_worker *worker = data;
+    struct prefetch *prefetch = worker->prefetch;
+
+    pthread_mutex_lock(&prefetch->lock);
+
+    for (;;) {
+        struct prefetch_job job;
+        const XkbFile *xkb_file;
+        unsigned int i;
+
+        /* Running jobs may queue more. */
+        while (prefetch->next == darray_size(prefetch->jobs) &&
+               prefetch->running > 0)
+            pthread_cond_wait(&prefetch->cond, &prefetch->lock);
+
+        if (prefetch->next == darray_size(prefetch->jobs))
+            break;
+
+        i = prefetch->next++;
+        job = darray_item(prefetch->jobs, i);
+        prefetch->running++;
+        pthread_mutex_unlock(&prefetch->lock);
+
+        xkb_file = prefetch_run_job(worker, &job);
+
+        pthread_mutex_lock(&prefetch->lock);
+        darray_item(prefetch->jobs, i) = job;
+        if (xkb_file && xkb_file->file_type == job.type)
+            prefetch_add_includes(prefetch, job.type, xkb_file);
+        prefetch->running--;
+        pthread_cond_broadcast(&prefetch->cond);
+    }
+
+    pthread_mutex_unlock(&prefetch->lock);
+    return NULL;
+}
+
+/*
+ * Parses the files included by the sections of a keymap, and those they
+ * include in turn, on one thread per CPU.  Everything is best effort: the
+ * compiler parses what's missing from the cache afterwards.
+ */
+void
+PrefetchIncludeFiles(struct xkb_context *ctx, XkbFile *const *files)
+{
+    struct prefetch prefetch = { 0 };
+    struct prefetch_worker *workers;
+    struct prefetch_job *job;
+    struct include_dir_cache *include_dirs;
+    long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned int num_workers, num_threads;
+    enum xkb_file_type type;
+
+    xkb_context_lock(ctx);
+    prefetch.cache = GetParsedFileCache(ctx);
+    /* Not allocated by the workers, which would each have their own. */
+    include_dirs = GetIncludeDirCache(ctx);
+    if (!include_dirs)
+        prefetch.cache = NULL;
+    xkb_context_unlock(ctx);
+    if (!prefetch.cache)
+        return;
+
+    for (type = FIRST_KEYMAP_FILE_TYPE; type <= LAST_KEYMAP_FILE_TYPE; type++)
+        if (files[type])
+            prefetch_add_includes(&prefetch, type, files[type]);
+
+    /* With a single CPU, the threads would only get in each other's way. */
+    num_workers = MIN(MAX(num_cpus, 1), MAX_PREFETCH_THREADS);
+    num_workers = MIN(num_workers, darray_size(prefetch.jobs));
+    if (num_workers < 2)
+        goto out;
+
+    workers = calloc(num_workers, sizeof(*workers));
+    if (!workers)
+        goto out;
+
+    pthread_mutex_init(&prefetch.cache_lock, NULL);
+    pthread_mutex_init(&prefetch.lock, NULL);
+    pthread_cond_init(&prefetch.cond, NULL);
+
+    /*
+     * Not copied from the context, whose counters and reference count other
+     * threads may be changing.  The scratch is the worker's own, since the
+     * keymap_cache_deps of the calling thread's are in use.
+     */
+    for (unsigned int i = 0; i < num_workers; i++) {
+        struct xkb_context *worker_ctx = &workers[i].ctx;
+
+        worker_ctx->refcnt = 1;
+        worker_ctx->log_fn = prefetch_log;
+        worker_ctx->log_level = ctx->log_level;
+        worker_ctx->log_verbosity = ctx->log_verbosity;
+        worker_ctx->includes = ctx->includes;
+        worker_ctx->failed_includes = ctx->failed_includes;
+        worker_ctx->atom_table = ctx->atom_table;
+        worker_ctx->lock = ctx->lock ? ctx->lock : &prefetch.cache_lock;
+        worker_ctx->include_dirs = include_dirs;
+        workers[i].prefetch = &prefetch;
+    }
+
+    /* The calling thread is the first worker. */
+    for (num_threads = 1; num_threads < num_workers; num_threads++)
+        if (pthread_create(&workers[num_threads].thread, NULL,
+                           prefetch_worker_run, &workers[num_threads]) != 0)
+            break;
+
+    prefetch_worker_run(&workers[0]);
+
+    for (unsigned int i = 1; i < num_threads; i++)
+        pthread_join(workers[i].thread, NULL);
+
+    pthread_cond_destroy(&prefetch.cond);
+    pthread_mutex_destroy(&prefetch.lock);
+    pthread_mutex_destroy(&prefetch.cache_lock);
+
+    xkb_context_lock(ctx);
+
+    for (unsigned int i = 0; i < num_threads; i++) {
+        ctx->include_dir_checks += workers[i].ctx.include_dir_checks;
+        ctx->include_opens_avoided += workers[i].ctx.include_opens_avoided;
+        ctx->ast_allocs += workers[i].ctx.ast_allocs;
+        ctx->ast_chunks += workers[i].ctx.ast_chunks;
+    }
+    free(workers);
+
+    /* In the order of the jobs, which doesn't depend on the threads. */
+    darray_foreach(job, prefetch.jobs) {
+        struct parsed_file *entry;
+
+        if (!job->xkb_file)
+            continue;
+
+        ctx->parsed_file_misses++;
+
+        entry = FindParsedFile(prefetch.cache, job->path, job->map);
+        if (!entry || !parsed_file_is_current(entry, &job->st)) {
+            StoreParsedFile(prefetch.cache, entry, job->path, job->map,
+                            &job->st, job->xkb_file);
+            job->xkb_file = NULL;
+        }
+
+        /* For the other maps of the file. */
+        if (!job->indexed ||
+            LookupMapIndex(prefetch.cache, job->path, &job->st) ||
+            !StoreMapIndex(prefetch.cache, job->path, &job->st, &job->maps))
+            darray_free(job->maps);
+
+        free(job->path);
+    }
+
+    xkb_context_unlock(ctx);
+
+    /*
+     * Another keymap cached the same files in the meantime.  These are
+     * only freed now, as the files and maps of the jobs point into them.
+     */
+    darray_foreach(job, prefetch.jobs)
+        FreeXkbFile(job->xkb_file);
+out:
+    darray_free(prefetch.jobs);
+}
+
+#else
+
+void
+PrefetchIncludeFiles(struct xkb_context *ctx, XkbFile *const *files)
+{
+}
+
+#endif
@@ -31,6 +31,13 @@ bool
 ParseIncludeMap(char **str_inout, char **file_rtrn, char **map_rtrn,
                 char *nextop_rtrn, char **extra_data);
 
+/*
+ * Makes the next lookups check the include directories for changes again;
+ * called once per keymap.
+ */
+void
+RecheckIncludeDirs(struct xkb_context *ctx);
+
 FILE *
 FindFileInXkbPath(struct xkb_context *ctx, const char *name,
                   enum xkb_file_type type, char **pathRtrn);
@@ -39,4 +46,7 @@ XkbFile *
 ProcessIncludeFile(struct xkb_context *ctx, IncludeStmt *stmt,
                    enum xkb_file_type file_type);
 
+void
+PrefetchIncludeFiles(struct xkb_context *ctx, XkbFile *const *files);
+
 #endif
@@ -335,8 +335,7 @@ HandleIncludeKeycodes(KeyNamesInfo *info, IncludeStmt *include)
     KeyNamesInfo included;
 
     InitKeyNamesInfo(&included, info->ctx);
-    included.name = include->stmt;
-    include->stmt = NULL;
+    included.name = strdup_safe(include->stmt);
 
     for (IncludeStmt *stmt = include; stmt; stmt = stmt->next_incl) {
         KeyNamesInfo next_incl;
@@ -356,7 +355,6 @@ HandleIncludeKeycodes(KeyNamesInfo *info, IncludeStmt *include)
         MergeIncludedKeycodes(&included, &next_incl, stmt->merge);
 
         ClearKeyNamesInfo(&next_incl);
-        FreeXkbFile(file);
     }
 
     MergeIncludedKeycodes(info, &included, include->merge);
@@ -28,6 +28,7 @@
  */
 
 #include "xkbcomp-priv.h"
+#include "include.h"
 
 static void
 ComputeEffectiveMask(struct xkb_keymap *keymap, struct xkb_mods *mods)
@@ -274,6 +275,15 @@ CompileKeymap(XkbFile *file, struct xkb_keymap *keymap, enum merge_mode merge)
     if (!ok)
         return false;
 
+    /*
+     * The sections are compiled in order, since each depends on the
+     * previous ones, but the files they include can be parsed up front.
+     */
+    xkb_context_begin_compile(ctx);
+
+    if (keymap->flags & XKB_KEYMAP_COMPILE_PARALLEL)
+        PrefetchIncludeFiles(ctx, files);
+
     /* Compile sections. */
     for (type = FIRST_KEYMAP_FILE_TYPE;
          type <= LAST_KEYMAP_FILE_TYPE;
@@ -285,9 +295,19 @@ CompileKeymap(XkbFile *file, struct xkb_keymap *keymap, enum merge_mode merge)
         if (!ok) {
             log_err(ctx, "Failed to compile %s\n",
                     xkb_file_type_to_string(type));
-            return false;
+            break;
         }
     }
 
-    return UpdateDerivedKeymapFields(keymap);
+    xkb_context_end_compile(ctx);
+    if (!ok)
+        return false;
+
+    if (!UpdateDerivedKeymapFields(keymap))
+        return false;
+
+    if (!xkb_keymap_build_texts(keymap))
+        return false;
+
+    return xkb_keymap_finalize(keymap);
 }
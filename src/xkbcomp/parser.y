@@ -35,10 +35,13 @@
 #include "xkbcomp/ast-build.h"
 #include "xkbcomp/parser-priv.h"
 #include "scanner-utils.h"
+#include "arena.h"
 
 struct parser_param {
     struct xkb_context *ctx;
     struct scanner *scanner;
+    /* Where the AST of the current map is allocated. */
+    struct arena *arena;
     XkbFile *rtrn;
     bool more_maps;
 };
@@ -216,13 +219,7 @@ resolve_keysym(const char *name, xkb_keysym_t *sym_rtrn)
 %type <file>    XkbFile XkbMapConfigList XkbMapConfig
 %type <file>    XkbCompositeMap
 
-%destructor { FreeStmt((ParseCommon *) $$); }
-    <any> <expr> <var> <vmod> <interp> <keyType> <syms> <modMask> <groupCompat>
-    <ledMap> <ledName> <keyCode> <keyAlias>
-/* The destructor also runs on the start symbol when the parser *succeeds*.
- * The `if` here catches this case. */
-%destructor { if (!param->rtrn) FreeXkbFile($$); } <file>
-%destructor { free($$); } <str>
+/* The AST nodes and strings are in the arena, and are freed along with it. */
 
 %%
 
@@ -249,7 +246,7 @@ XkbFile         :       XkbCompositeMap
 XkbCompositeMap :       OptFlags XkbCompositeType OptMapName OBRACE
                             XkbMapConfigList
                         CBRACE SEMI
-                        { $$ = XkbFileCreate($2, $3, (ParseCommon *) $5, $1); }
+                        { $$ = XkbFileCreate(param->arena, $2, $3, (ParseCommon *) $5, $1); }
                 ;
 
 XkbCompositeType:       XKB_KEYMAP      { $$ = FILE_TYPE_KEYMAP; }
@@ -274,12 +271,10 @@ XkbMapConfig    :       OptFlags FileType OptMapName OBRACE
                         CBRACE SEMI
                         {
                             if ($2 == FILE_TYPE_GEOMETRY) {
-                                free($3);
-                                FreeStmt($5);
                                 $$ = NULL;
                             }
                             else {
-                                $$ = XkbFileCreate($2, $3, $5, $1);
+                                $$ = XkbFileCreate(param->arena, $2, $3, $5, $1);
                             }
                         }
                 ;
@@ -374,25 +369,24 @@ Decl            :       OptMergeMode VarDecl
                 |       OptMergeMode DoodadDecl         { $$ = NULL; }
                 |       MergeMode STRING
                         {
-                            $$ = (ParseCommon *) IncludeCreate(param->ctx, $2, $1);
-                            free($2);
+                            $$ = (ParseCommon *) IncludeCreate(param->ctx, param->arena, $2, $1);
                         }
                 ;
 
 VarDecl         :       Lhs EQUALS Expr SEMI
-                        { $$ = VarCreate($1, $3); }
+                        { $$ = VarCreate(param->arena, $1, $3); }
                 |       Ident SEMI
-                        { $$ = BoolVarCreate($1, true); }
+                        { $$ = BoolVarCreate(param->arena, $1, true); }
                 |       EXCLAM Ident SEMI
-                        { $$ = BoolVarCreate($2, false); }
+                        { $$ = BoolVarCreate(param->arena, $2, false); }
                 ;
 
 KeyNameDecl     :       KEYNAME EQUALS KeyCode SEMI
-                        { $$ = KeycodeCreate($1, $3); }
+                        { $$ = KeycodeCreate(param->arena, $1, $3); }
                 ;
 
 KeyAliasDecl    :       ALIAS KEYNAME EQUALS KEYNAME SEMI
-                        { $$ = KeyAliasCreate($2, $4); }
+                        { $$ = KeyAliasCreate(param->arena, $2, $4); }
                 ;
 
 VModDecl        :       VIRTUAL_MODS VModDefList SEMI
@@ -407,9 +401,9 @@ VModDefList     :       VModDefList COMMA VModDef
                 ;
 
 VModDef         :       Ident
-                        { $$ = VModCreate($1, NULL); }
+                        { $$ = VModCreate(param->arena, $1, NULL); }
                 |       Ident EQUALS Expr
-                        { $$ = VModCreate($1, $3); }
+                        { $$ = VModCreate(param->arena, $1, $3); }
                 ;
 
 InterpretDecl   :       INTERPRET InterpretMatch OBRACE
@@ -419,9 +413,9 @@ InterpretDecl   :       INTERPRET InterpretMatch OBRACE
                 ;
 
 InterpretMatch  :       KeySym PLUS Expr
-                        { $$ = InterpCreate($1, $3); }
+                        { $$ = InterpCreate(param->arena, $1, $3); }
                 |       KeySym
-                        { $$ = InterpCreate($1, NULL); }
+                        { $$ = InterpCreate(param->arena, $1, NULL); }
                 ;
 
 VarDeclList     :       VarDeclList VarDecl
@@ -434,13 +428,13 @@ VarDeclList     :       VarDeclList VarDecl
 KeyTypeDecl     :       TYPE String OBRACE
                             VarDeclList
                         CBRACE SEMI
-                        { $$ = KeyTypeCreate($2, $4); }
+                        { $$ = KeyTypeCreate(param->arena, $2, $4); }
                 ;
 
 SymbolsDecl     :       KEY KEYNAME OBRACE
                             SymbolsBody
                         CBRACE SEMI
-                        { $$ = SymbolsCreate($2, $4); }
+                        { $$ = SymbolsCreate(param->arena, $2, $4); }
                 ;
 
 SymbolsBody     :       SymbolsBody COMMA SymbolsVarDecl
@@ -451,35 +445,35 @@ SymbolsBody     :       SymbolsBody COMMA SymbolsVarDecl
                 |       { $$ = NULL; }
                 ;
 
-SymbolsVarDecl  :       Lhs EQUALS Expr         { $$ = VarCreate($1, $3); }
-                |       Lhs EQUALS ArrayInit    { $$ = VarCreate($1, $3); }
-                |       Ident                   { $$ = BoolVarCreate($1, true); }
-                |       EXCLAM Ident            { $$ = BoolVarCreate($2, false); }
-                |       ArrayInit               { $$ = VarCreate(NULL, $1); }
+SymbolsVarDecl  :       Lhs EQUALS Expr         { $$ = VarCreate(param->arena, $1, $3); }
+                |       Lhs EQUALS ArrayInit    { $$ = VarCreate(param->arena, $1, $3); }
+                |       Ident                   { $$ = BoolVarCreate(param->arena, $1, true); }
+                |       EXCLAM Ident            { $$ = BoolVarCreate(param->arena, $2, false); }
+                |       ArrayInit               { $$ = VarCreate(param->arena, NULL, $1); }
                 ;
 
 ArrayInit       :       OBRACKET OptKeySymList CBRACKET
                         { $$ = $2; }
                 |       OBRACKET ActionList CBRACKET
-                        { $$ = ExprCreateUnary(EXPR_ACTION_LIST, EXPR_TYPE_ACTION, $2); }
+                        { $$ = ExprCreateUnary(param->arena, EXPR_ACTION_LIST, EXPR_TYPE_ACTION, $2); }
                 ;
 
 GroupCompatDecl :       GROUP Integer EQUALS Expr SEMI
-                        { $$ = GroupCompatCreate($2, $4); }
+                        { $$ = GroupCompatCreate(param->arena, $2, $4); }
                 ;
 
 ModMapDecl      :       MODIFIER_MAP Ident OBRACE ExprList CBRACE SEMI
-                        { $$ = ModMapCreate($2, $4); }
+                        { $$ = ModMapCreate(param->arena, $2, $4); }
                 ;
 
 LedMapDecl:             INDICATOR String OBRACE VarDeclList CBRACE SEMI
-                        { $$ = LedMapCreate($2, $4); }
+                        { $$ = LedMapCreate(param->arena, $2, $4); }
                 ;
 
 LedNameDecl:            INDICATOR Integer EQUALS Expr SEMI
-                        { $$ = LedNameCreate($2, $4, false); }
+                        { $$ = LedNameCreate(param->arena, $2, $4, false); }
                 |       VIRTUAL INDICATOR Integer EQUALS Expr SEMI
-                        { $$ = LedNameCreate($3, $5, true); }
+                        { $$ = LedNameCreate(param->arena, $3, $5, true); }
                 ;
 
 ShapeDecl       :       SHAPE String OBRACE OutlineList CBRACE SEMI
@@ -499,11 +493,11 @@ SectionBody     :       SectionBody SectionBodyItem     { $$ = NULL;}
 SectionBodyItem :       ROW OBRACE RowBody CBRACE SEMI
                         { $$ = NULL; }
                 |       VarDecl
-                        { FreeStmt((ParseCommon *) $1); $$ = NULL; }
+                        { $$ = NULL; }
                 |       DoodadDecl
                         { $$ = NULL; }
                 |       LedMapDecl
-                        { FreeStmt((ParseCommon *) $1); $$ = NULL; }
+                        { $$ = NULL; }
                 |       OverlayDecl
                         { $$ = NULL; }
                 ;
@@ -514,7 +508,7 @@ RowBody         :       RowBody RowBodyItem     { $$ = NULL;}
 
 RowBodyItem     :       KEYS OBRACE Keys CBRACE SEMI { $$ = NULL; }
                 |       VarDecl
-                        { FreeStmt((ParseCommon *) $1); $$ = NULL; }
+                        { $$ = NULL; }
                 ;
 
 Keys            :       Keys COMMA Key          { $$ = NULL; }
@@ -524,7 +518,7 @@ Keys            :       Keys COMMA Key          { $$ = NULL; }
 Key             :       KEYNAME
                         { $$ = NULL; }
                 |       OBRACE ExprList CBRACE
-                        { FreeStmt((ParseCommon *) $2); $$ = NULL; }
+                        { $$ = NULL; }
                 ;
 
 OverlayDecl     :       OVERLAY String OBRACE OverlayKeyList CBRACE SEMI
@@ -549,7 +543,7 @@ OutlineInList   :       OBRACE CoordList CBRACE
                 |       Ident EQUALS OBRACE CoordList CBRACE
                         { (void) $4; $$ = NULL; }
                 |       Ident EQUALS Expr
-                        { FreeStmt((ParseCommon *) $3); $$ = NULL; }
+                        { $$ = NULL; }
                 ;
 
 CoordList       :       CoordList COMMA Coord
@@ -563,7 +557,7 @@ Coord           :       OBRACKET SignedNumber COMMA SignedNumber CBRACKET
                 ;
 
 DoodadDecl      :       DoodadType String OBRACE VarDeclList CBRACE SEMI
-                        { FreeStmt((ParseCommon *) $4); $$ = NULL; }
+                        { $$ = NULL; }
                 ;
 
 DoodadType      :       TEXT    { $$ = 0; }
@@ -630,31 +624,31 @@ ExprList        :       ExprList COMMA Expr
                 ;
 
 Expr            :       Expr DIVIDE Expr
-                        { $$ = ExprCreateBinary(EXPR_DIVIDE, $1, $3); }
+                        { $$ = ExprCreateBinary(param->arena, EXPR_DIVIDE, $1, $3); }
                 |       Expr PLUS Expr
-                        { $$ = ExprCreateBinary(EXPR_ADD, $1, $3); }
+                        { $$ = ExprCreateBinary(param->arena, EXPR_ADD, $1, $3); }
                 |       Expr MINUS Expr
-                        { $$ = ExprCreateBinary(EXPR_SUBTRACT, $1, $3); }
+                        { $$ = ExprCreateBinary(param->arena, EXPR_SUBTRACT, $1, $3); }
                 |       Expr TIMES Expr
-                        { $$ = ExprCreateBinary(EXPR_MULTIPLY, $1, $3); }
+                        { $$ = ExprCreateBinary(param->arena, EXPR_MULTIPLY, $1, $3); }
                 |       Lhs EQUALS Expr
-                        { $$ = ExprCreateBinary(EXPR_ASSIGN, $1, $3); }
+                        { $$ = ExprCreateBinary(param->arena, EXPR_ASSIGN, $1, $3); }
                 |       Term
                         { $$ = $1; }
                 ;
 
 Term            :       MINUS Term
-                        { $$ = ExprCreateUnary(EXPR_NEGATE, $2->expr.value_type, $2); }
+                        { $$ = ExprCreateUnary(param->arena, EXPR_NEGATE, $2->expr.value_type, $2); }
                 |       PLUS Term
-                        { $$ = ExprCreateUnary(EXPR_UNARY_PLUS, $2->expr.value_type, $2); }
+                        { $$ = ExprCreateUnary(param->arena, EXPR_UNARY_PLUS, $2->expr.value_type, $2); }
                 |       EXCLAM Term
-                        { $$ = ExprCreateUnary(EXPR_NOT, EXPR_TYPE_BOOLEAN, $2); }
+                        { $$ = ExprCreateUnary(param->arena, EXPR_NOT, EXPR_TYPE_BOOLEAN, $2); }
                 |       INVERT Term
-                        { $$ = ExprCreateUnary(EXPR_INVERT, $2->expr.value_type, $2); }
+                        { $$ = ExprCreateUnary(param->arena, EXPR_INVERT, $2->expr.value_type, $2); }
                 |       Lhs
                         { $$ = $1;  }
                 |       FieldSpec OPAREN OptExprList CPAREN %prec OPAREN
-                        { $$ = ExprCreateAction($1, $3); }
+                        { $$ = ExprCreateAction(param->arena, $1, $3); }
                 |       Terminal
                         { $$ = $1;  }
                 |       OPAREN Expr CPAREN
@@ -669,27 +663,27 @@ ActionList      :       ActionList COMMA Action
                 ;
 
 Action          :       FieldSpec OPAREN OptExprList CPAREN
-                        { $$ = ExprCreateAction($1, $3); }
+                        { $$ = ExprCreateAction(param->arena, $1, $3); }
                 ;
 
 Lhs             :       FieldSpec
-                        { $$ = ExprCreateIdent($1); }
+                        { $$ = ExprCreateIdent(param->arena, $1); }
                 |       FieldSpec DOT FieldSpec
-                        { $$ = ExprCreateFieldRef($1, $3); }
+                        { $$ = ExprCreateFieldRef(param->arena, $1, $3); }
                 |       FieldSpec OBRACKET Expr CBRACKET
-                        { $$ = ExprCreateArrayRef(XKB_ATOM_NONE, $1, $3); }
+                        { $$ = ExprCreateArrayRef(param->arena, XKB_ATOM_NONE, $1, $3); }
                 |       FieldSpec DOT FieldSpec OBRACKET Expr CBRACKET
-                        { $$ = ExprCreateArrayRef($1, $3, $5); }
+                        { $$ = ExprCreateArrayRef(param->arena, $1, $3, $5); }
                 ;
 
 Terminal        :       String
-                        { $$ = ExprCreateString($1); }
+                        { $$ = ExprCreateString(param->arena, $1); }
                 |       Integer
-                        { $$ = ExprCreateInteger($1); }
+                        { $$ = ExprCreateInteger(param->arena, $1); }
                 |       Float
                         { $$ = NULL; }
                 |       KEYNAME
-                        { $$ = ExprCreateKeyName($1); }
+                        { $$ = ExprCreateKeyName(param->arena, $1); }
                 ;
 
 OptKeySymList   :       KeySymList      { $$ = $1; }
@@ -697,13 +691,13 @@ OptKeySymList   :       KeySymList      { $$ = $1; }
                 ;
 
 KeySymList      :       KeySymList COMMA KeySym
-                        { $$ = ExprAppendKeysymList($1, $3); }
+                        { $$ = ExprAppendKeysymList(param->arena, $1, $3); }
                 |       KeySymList COMMA KeySyms
-                        { $$ = ExprAppendMultiKeysymList($1, $3); }
+                        { $$ = ExprAppendMultiKeysymList(param->arena, $1, $3); }
                 |       KeySym
-                        { $$ = ExprCreateKeysymList($1); }
+                        { $$ = ExprCreateKeysymList(param->arena, $1); }
                 |       KeySyms
-                        { $$ = ExprCreateMultiKeysymList($1); }
+                        { $$ = ExprCreateMultiKeysymList(param->arena, $1); }
                 ;
 
 KeySyms         :       OBRACE KeySymList CBRACE
@@ -714,7 +708,6 @@ KeySym          :       IDENT
                         {
                             if (!resolve_keysym($1, &$$))
                                 parser_warn(param, "unrecognized keysym \"%s\"", $1);
-                            free($1);
                         }
                 |       SECTION { $$ = XKB_KEY_section; }
                 |       Integer
@@ -754,11 +747,11 @@ Integer         :       INTEGER { $$ = $1; }
 KeyCode         :       INTEGER { $$ = $1; }
                 ;
 
-Ident           :       IDENT   { $$ = xkb_atom_steal(param->ctx, $1); }
+Ident           :       IDENT   { $$ = xkb_atom_intern(param->ctx, $1, strlen($1)); }
                 |       DEFAULT { $$ = xkb_atom_intern_literal(param->ctx, "default"); }
                 ;
 
-String          :       STRING  { $$ = xkb_atom_steal(param->ctx, $1); }
+String          :       STRING  { $$ = xkb_atom_intern(param->ctx, $1, strlen($1)); }
                 ;
 
 OptMapName      :       MapName { $$ = $1; }
@@ -788,9 +781,30 @@ parse(struct xkb_context *ctx, struct scanner *scanner, const char *map)
      * default map. If we find a map marked as default, we return it
      * immediately. If there are no maps marked as default, we return
      * the first map in the file.
+     *
+     * Each map gets its own arena, which it owns once returned.
      */
 
-    while ((ret = yyparse(&param)) == 0 && param.more_maps) {
+    for (;;) {
+        param.arena = arena_new();
+        if (!param.arena) {
+            ret = -1;
+            break;
+        }
+        /* For the strings of the tokens. */
+        scanner->priv = param.arena;
+
+        ret = yyparse(&param);
+        xkb_context_lock(ctx);
+        ctx->ast_allocs += arena_num_allocs(param.arena);
+        ctx->ast_chunks += arena_num_chunks(param.arena);
+        xkb_context_unlock(ctx);
+        if (ret != 0 || !param.more_maps)
+            break;
+
+        param.rtrn->arena = param.arena;
+        param.arena = NULL;
+
         if (map) {
             if (streq_not_null(map, param.rtrn->name))
                 return param.rtrn;
@@ -812,6 +826,8 @@ parse(struct xkb_context *ctx, struct scanner *scanner, const char *map)
         param.rtrn = NULL;
     }
 
+    arena_free(param.arena);
+
     if (ret != 0) {
         FreeXkbFile(first);
         return NULL;
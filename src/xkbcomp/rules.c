@@ -47,6 +47,9 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
+#include <sys/types.h>
+#include <sys/stat.h>
+
 #include "xkbcomp-priv.h"
 #include "rules.h"
 #include "include.h"
@@ -223,9 +226,15 @@ enum mlvo_match_type {
     MLVO_MATCH_GROUP,
 };
 
+struct rule_value {
+    struct sval sval;
+    enum mlvo_match_type match_type;
+    /* With MLVO_MATCH_GROUP, the group as defined at the rule, or -1. */
+    int group;
+};
+
 struct rule {
-    struct sval mlvo_value_at_pos[_MLVO_NUM_ENTRIES];
-    enum mlvo_match_type match_type_at_pos[_MLVO_NUM_ENTRIES];
+    struct rule_value mlvo_value_at_pos[_MLVO_NUM_ENTRIES];
     unsigned int num_mlvo_values;
     struct sval kccgst_value_at_pos[_KCCGST_NUM_ENTRIES];
     unsigned int num_kccgst_values;
@@ -233,22 +242,65 @@ struct rule {
 };
 
 /*
- * This is the main object used to match a given RMLVO against a rules
- * file and aggragate the results in a KcCGST. It goes through a simple
- * matching state machine, with tokens as transitions (see
- * matcher_match()).
+ * A mapping line and the valid rules below it.  Each rule is stored as its
+ * num_mlvo values followed by its num_kccgst values, from first_value on.
  */
-struct matcher {
-    struct xkb_context *ctx;
-    /* Input.*/
-    struct rule_names rmlvo;
+struct rule_set {
+    struct mapping mapping;
+    unsigned int first_value;
+    unsigned int num_rules;
+};
+
+/*
+ * A rules file, parsed once and then matched against any RMLVO without
+ * going through the scanner again.  The values point into the text of the
+ * file, which is kept along.  These are cached on the context, keyed by
+ * the path and valid as long as the file is unchanged.
+ */
+struct compiled_rules {
+    char *path;
+    struct file_stamp stamp;
+    char *string;
+    darray(struct group) groups;
+    darray(struct rule_set) rule_sets;
+    darray(struct rule_value) values;
+    /* The file has a syntax error, so no components are returned. */
+    bool failed;
+};
+
+struct rules_cache {
+    darray(struct compiled_rules *) files;
+    /*
+     * Replaced files, which another thread may still be matching, until
+     * no compile is in progress.
+     */
+    darray(struct compiled_rules *) retired;
+};
+
+/*
+ * This is used to parse a rules file into its compiled form. It goes
+ * through a simple state machine, with tokens as transitions (see
+ * parser_parse()).
+ */
+struct rules_parser {
     union lvalue val;
     struct scanner scanner;
-    darray(struct group) groups;
+    struct compiled_rules *rules;
     /* Current mapping. */
     struct mapping mapping;
     /* Current rule. */
     struct rule rule;
+};
+
+/*
+ * This is the main object used to match a given RMLVO against a compiled
+ * rules file and aggragate the results in a KcCGST (see matcher_match()).
+ */
+struct matcher {
+    struct xkb_context *ctx;
+    /* Input.*/
+    struct rule_names rmlvo;
+    const struct compiled_rules *rules;
     /* Output. */
     darray_char kccgst[_KCCGST_NUM_ENTRIES];
 };
@@ -291,13 +343,15 @@ split_comma_separated_mlvo(const char *s)
 
 static struct matcher *
 matcher_new(struct xkb_context *ctx,
-            const struct xkb_rule_names *rmlvo)
+            const struct xkb_rule_names *rmlvo,
+            const struct compiled_rules *rules)
 {
     struct matcher *m = calloc(1, sizeof(*m));
     if (!m)
         return NULL;
 
     m->ctx = ctx;
+    m->rules = rules;
     m->rmlvo.model.sval.start = rmlvo->model;
     m->rmlvo.model.sval.len = strlen_safe(rmlvo->model);
     m->rmlvo.layouts = split_comma_separated_mlvo(rmlvo->layout);
@@ -310,49 +364,63 @@ matcher_new(struct xkb_context *ctx,
 static void
 matcher_free(struct matcher *m)
 {
-    struct group *group;
     if (!m)
         return;
     darray_free(m->rmlvo.layouts);
     darray_free(m->rmlvo.variants);
     darray_free(m->rmlvo.options);
-    darray_foreach(group, m->groups)
-        darray_free(group->elements);
     for (int i = 0; i < _KCCGST_NUM_ENTRIES; i++)
         darray_free(m->kccgst[i]);
-    darray_free(m->groups);
     free(m);
 }
 
-#define matcher_err(matcher, fmt, ...) \
-    scanner_err(&(matcher)->scanner, fmt, ## __VA_ARGS__)
+static void
+compiled_rules_free(struct compiled_rules *rules)
+{
+    struct group *group;
+
+    if (!rules)
+        return;
+    darray_foreach(group, rules->groups)
+        darray_free(group->elements);
+    darray_free(rules->groups);
+    darray_free(rules->rule_sets);
+    darray_free(rules->values);
+    free(rules->string);
+    free(rules->path);
+    free(rules);
+}
+
+#define parser_err(parser, fmt, ...) \
+    scanner_err(&(parser)->scanner, fmt, ## __VA_ARGS__)
 
 static void
-matcher_group_start_new(struct matcher *m, struct sval name)
+parser_group_start_new(struct rules_parser *p, struct sval name)
 {
     struct group group = { .name = name, .elements = darray_new() };
-    darray_append(m->groups, group);
+    darray_append(p->rules->groups, group);
 }
 
 static void
-matcher_group_add_element(struct matcher *m, struct sval element)
+parser_group_add_element(struct rules_parser *p, struct sval element)
 {
-    darray_append(darray_item(m->groups, darray_size(m->groups) - 1).elements,
+    darray_append(darray_item(p->rules->groups,
+                              darray_size(p->rules->groups) - 1).elements,
                   element);
 }
 
 static void
-matcher_mapping_start_new(struct matcher *m)
+parser_mapping_start_new(struct rules_parser *p)
 {
     for (unsigned i = 0; i < _MLVO_NUM_ENTRIES; i++)
-        m->mapping.mlvo_at_pos[i] = -1;
+        p->mapping.mlvo_at_pos[i] = -1;
     for (unsigned i = 0; i < _KCCGST_NUM_ENTRIES; i++)
-        m->mapping.kccgst_at_pos[i] = -1;
-    m->mapping.layout_idx = m->mapping.variant_idx = XKB_LAYOUT_INVALID;
-    m->mapping.num_mlvo = m->mapping.num_kccgst = 0;
-    m->mapping.defined_mlvo_mask = 0;
-    m->mapping.defined_kccgst_mask = 0;
-    m->mapping.skip = false;
+        p->mapping.kccgst_at_pos[i] = -1;
+    p->mapping.layout_idx = p->mapping.variant_idx = XKB_LAYOUT_INVALID;
+    p->mapping.num_mlvo = p->mapping.num_kccgst = 0;
+    p->mapping.defined_mlvo_mask = 0;
+    p->mapping.defined_kccgst_mask = 0;
+    p->mapping.skip = false;
 }
 
 static int
@@ -372,7 +440,7 @@ extract_layout_index(const char *s, size_t max_len, xkb_layout_index_t *out)
 }
 
 static void
-matcher_mapping_set_mlvo(struct matcher *m, struct sval ident)
+parser_mapping_set_mlvo(struct rules_parser *p, struct sval ident)
 {
     enum rules_mlvo mlvo;
     struct sval mlvo_sval;
@@ -386,16 +454,16 @@ matcher_mapping_set_mlvo(struct matcher *m, struct sval ident)
 
     /* Not found. */
     if (mlvo >= _MLVO_NUM_ENTRIES) {
-        matcher_err(m, "invalid mapping: %.*s is not a valid value here; ignoring rule set",
-                    ident.len, ident.start);
-        m->mapping.skip = true;
+        parser_err(p, "invalid mapping: %.*s is not a valid value here; ignoring rule set",
+                   ident.len, ident.start);
+        p->mapping.skip = true;
         return;
     }
 
-    if (m->mapping.defined_mlvo_mask & (1u << mlvo)) {
-        matcher_err(m, "invalid mapping: %.*s appears twice on the same line; ignoring rule set",
-                    mlvo_sval.len, mlvo_sval.start);
-        m->mapping.skip = true;
+    if (p->mapping.defined_mlvo_mask & (1u << mlvo)) {
+        parser_err(p, "invalid mapping: %.*s appears twice on the same line; ignoring rule set",
+                   mlvo_sval.len, mlvo_sval.start);
+        p->mapping.skip = true;
         return;
     }
 
@@ -405,33 +473,33 @@ matcher_mapping_set_mlvo(struct matcher *m, struct sval ident)
         int consumed = extract_layout_index(ident.start + mlvo_sval.len,
                                             ident.len - mlvo_sval.len, &idx);
         if ((int) (ident.len - mlvo_sval.len) != consumed) {
-            matcher_err(m, "invalid mapping: \"%.*s\" may only be followed by a valid group index; ignoring rule set",
-                        mlvo_sval.len, mlvo_sval.start);
-            m->mapping.skip = true;
+            parser_err(p, "invalid mapping: \"%.*s\" may only be followed by a valid group index; ignoring rule set",
+                       mlvo_sval.len, mlvo_sval.start);
+            p->mapping.skip = true;
             return;
         }
 
         if (mlvo == MLVO_LAYOUT) {
-            m->mapping.layout_idx = idx;
+            p->mapping.layout_idx = idx;
         }
         else if (mlvo == MLVO_VARIANT) {
-            m->mapping.variant_idx = idx;
+            p->mapping.variant_idx = idx;
         }
         else {
-            matcher_err(m, "invalid mapping: \"%.*s\" cannot be followed by a group index; ignoring rule set",
-                        mlvo_sval.len, mlvo_sval.start);
-            m->mapping.skip = true;
+            parser_err(p, "invalid mapping: \"%.*s\" cannot be followed by a group index; ignoring rule set",
+                       mlvo_sval.len, mlvo_sval.start);
+            p->mapping.skip = true;
             return;
         }
     }
 
-    m->mapping.mlvo_at_pos[m->mapping.num_mlvo] = mlvo;
-    m->mapping.defined_mlvo_mask |= 1u << mlvo;
-    m->mapping.num_mlvo++;
+    p->mapping.mlvo_at_pos[p->mapping.num_mlvo] = mlvo;
+    p->mapping.defined_mlvo_mask |= 1u << mlvo;
+    p->mapping.num_mlvo++;
 }
 
 static void
-matcher_mapping_set_kccgst(struct matcher *m, struct sval ident)
+parser_mapping_set_kccgst(struct rules_parser *p, struct sval ident)
 {
     enum rules_kccgst kccgst;
     struct sval kccgst_sval;
@@ -445,147 +513,133 @@ matcher_mapping_set_kccgst(struct matcher *m, struct sval ident)
 
     /* Not found. */
     if (kccgst >= _KCCGST_NUM_ENTRIES) {
-        matcher_err(m, "invalid mapping: %.*s is not a valid value here; ignoring rule set",
-                    ident.len, ident.start);
-        m->mapping.skip = true;
+        parser_err(p, "invalid mapping: %.*s is not a valid value here; ignoring rule set",
+                   ident.len, ident.start);
+        p->mapping.skip = true;
         return;
     }
 
-    if (m->mapping.defined_kccgst_mask & (1u << kccgst)) {
-        matcher_err(m, "invalid mapping: %.*s appears twice on the same line; ignoring rule set",
-                    kccgst_sval.len, kccgst_sval.start);
-        m->mapping.skip = true;
+    if (p->mapping.defined_kccgst_mask & (1u << kccgst)) {
+        parser_err(p, "invalid mapping: %.*s appears twice on the same line; ignoring rule set",
+                   kccgst_sval.len, kccgst_sval.start);
+        p->mapping.skip = true;
         return;
     }
 
-    m->mapping.kccgst_at_pos[m->mapping.num_kccgst] = kccgst;
-    m->mapping.defined_kccgst_mask |= 1u << kccgst;
-    m->mapping.num_kccgst++;
+    p->mapping.kccgst_at_pos[p->mapping.num_kccgst] = kccgst;
+    p->mapping.defined_kccgst_mask |= 1u << kccgst;
+    p->mapping.num_kccgst++;
 }
 
+/*
+ * Whether the mapping applies to the RMLVO is only known when matching,
+ * see matcher_mapping_applies().
+ */
 static void
-matcher_mapping_verify(struct matcher *m)
+parser_mapping_verify(struct rules_parser *p)
 {
-    if (m->mapping.num_mlvo == 0) {
-        matcher_err(m, "invalid mapping: must have at least one value on the left hand side; ignoring rule set");
-        goto skip;
-    }
+    struct rule_set set = { 0 };
 
-    if (m->mapping.num_kccgst == 0) {
-        matcher_err(m, "invalid mapping: must have at least one value on the right hand side; ignoring rule set");
-        goto skip;
-    }
-
-    /*
-     * This following is very stupid, but this is how it works.
-     * See the "Notes" section in the overview above.
-     */
-
-    if (m->mapping.defined_mlvo_mask & (1u << MLVO_LAYOUT)) {
-        if (m->mapping.layout_idx == XKB_LAYOUT_INVALID) {
-            if (darray_size(m->rmlvo.layouts) > 1)
-                goto skip;
-        }
-        else {
-            if (darray_size(m->rmlvo.layouts) == 1 ||
-                m->mapping.layout_idx >= darray_size(m->rmlvo.layouts))
-                goto skip;
-        }
+    if (p->mapping.num_mlvo == 0) {
+        parser_err(p, "invalid mapping: must have at least one value on the left hand side; ignoring rule set");
+        p->mapping.skip = true;
+        return;
     }
 
-    if (m->mapping.defined_mlvo_mask & (1u << MLVO_VARIANT)) {
-        if (m->mapping.variant_idx == XKB_LAYOUT_INVALID) {
-            if (darray_size(m->rmlvo.variants) > 1)
-                goto skip;
-        }
-        else {
-            if (darray_size(m->rmlvo.variants) == 1 ||
-                m->mapping.variant_idx >= darray_size(m->rmlvo.variants))
-                goto skip;
-        }
+    if (p->mapping.num_kccgst == 0) {
+        parser_err(p, "invalid mapping: must have at least one value on the right hand side; ignoring rule set");
+        p->mapping.skip = true;
+        return;
     }
 
-    return;
-
-skip:
-    m->mapping.skip = true;
+    set.mapping = p->mapping;
+    set.first_value = darray_size(p->rules->values);
+    darray_append(p->rules->rule_sets, set);
 }
 
 static void
-matcher_rule_start_new(struct matcher *m)
+parser_rule_start_new(struct rules_parser *p)
 {
-    memset(&m->rule, 0, sizeof(m->rule));
-    m->rule.skip = m->mapping.skip;
+    memset(&p->rule, 0, sizeof(p->rule));
+    p->rule.skip = p->mapping.skip;
 }
 
 static void
-matcher_rule_set_mlvo_common(struct matcher *m, struct sval ident,
-                             enum mlvo_match_type match_type)
+parser_rule_set_mlvo_common(struct rules_parser *p, struct sval ident,
+                            enum mlvo_match_type match_type)
 {
-    if (m->rule.num_mlvo_values + 1 > m->mapping.num_mlvo) {
-        matcher_err(m, "invalid rule: has more values than the mapping line; ignoring rule");
-        m->rule.skip = true;
+    struct rule_value *value;
+
+    if (p->rule.num_mlvo_values + 1 > p->mapping.num_mlvo) {
+        parser_err(p, "invalid rule: has more values than the mapping line; ignoring rule");
+        p->rule.skip = true;
         return;
     }
-    m->rule.match_type_at_pos[m->rule.num_mlvo_values] = match_type;
-    m->rule.mlvo_value_at_pos[m->rule.num_mlvo_values] = ident;
-    m->rule.num_mlvo_values++;
+    value = &p->rule.mlvo_value_at_pos[p->rule.num_mlvo_values];
+    value->match_type = match_type;
+    value->sval = ident;
+    value->group = -1;
+    p->rule.num_mlvo_values++;
 }
 
 static void
-matcher_rule_set_mlvo_wildcard(struct matcher *m)
+parser_rule_set_mlvo_wildcard(struct rules_parser *p)
 {
     struct sval dummy = { NULL, 0 };
-    matcher_rule_set_mlvo_common(m, dummy, MLVO_MATCH_WILDCARD);
+    parser_rule_set_mlvo_common(p, dummy, MLVO_MATCH_WILDCARD);
 }
 
 static void
-matcher_rule_set_mlvo_group(struct matcher *m, struct sval ident)
+parser_rule_set_mlvo_group(struct rules_parser *p, struct sval ident)
 {
-    matcher_rule_set_mlvo_common(m, ident, MLVO_MATCH_GROUP);
+    struct group *group;
+
+    parser_rule_set_mlvo_common(p, ident, MLVO_MATCH_GROUP);
+    if (p->rule.skip)
+        return;
+
+    /*
+     * rules/evdev intentionally uses some undeclared group names in rules
+     * (e.g. commented group definitions which may be uncommented if
+     * needed). These just never match.
+     */
+    darray_foreach(group, p->rules->groups) {
+        if (svaleq(group->name, ident)) {
+            p->rule.mlvo_value_at_pos[p->rule.num_mlvo_values - 1].group =
+                group - p->rules->groups.item;
+            break;
+        }
+    }
 }
 
 static void
-matcher_rule_set_mlvo(struct matcher *m, struct sval ident)
+parser_rule_set_mlvo(struct rules_parser *p, struct sval ident)
 {
-    matcher_rule_set_mlvo_common(m, ident, MLVO_MATCH_NORMAL);
+    parser_rule_set_mlvo_common(p, ident, MLVO_MATCH_NORMAL);
 }
 
 static void
-matcher_rule_set_kccgst(struct matcher *m, struct sval ident)
+parser_rule_set_kccgst(struct rules_parser *p, struct sval ident)
 {
-    if (m->rule.num_kccgst_values + 1 > m->mapping.num_kccgst) {
-        matcher_err(m, "invalid rule: has more values than the mapping line; ignoring rule");
-        m->rule.skip = true;
+    if (p->rule.num_kccgst_values + 1 > p->mapping.num_kccgst) {
+        parser_err(p, "invalid rule: has more values than the mapping line; ignoring rule");
+        p->rule.skip = true;
         return;
     }
-    m->rule.kccgst_value_at_pos[m->rule.num_kccgst_values] = ident;
-    m->rule.num_kccgst_values++;
+    p->rule.kccgst_value_at_pos[p->rule.num_kccgst_values] = ident;
+    p->rule.num_kccgst_values++;
 }
 
 static bool
-match_group(struct matcher *m, struct sval group_name, struct sval to)
+match_group(struct matcher *m, int group_idx, struct sval to)
 {
-    struct group *group;
-    struct sval *element;
-    bool found = false;
+    const struct group *group;
+    const struct sval *element;
 
-    darray_foreach(group, m->groups) {
-        if (svaleq(group->name, group_name)) {
-            found = true;
-            break;
-        }
-    }
-
-    if (!found) {
-        /*
-         * rules/evdev intentionally uses some undeclared group names
-         * in rules (e.g. commented group definitions which may be
-         * uncommented if needed). So we continue silently.
-         */
+    if (group_idx < 0)
         return false;
-    }
 
+    group = &darray_item(m->rules->groups, group_idx);
     darray_foreach(element, group->elements)
         if (svaleq(to, *element))
             return true;
@@ -594,21 +648,20 @@ match_group(struct matcher *m, struct sval group_name, struct sval to)
 }
 
 static bool
-match_value(struct matcher *m, struct sval val, struct sval to,
-            enum mlvo_match_type match_type)
+match_value(struct matcher *m, const struct rule_value *val, struct sval to)
 {
-    if (match_type == MLVO_MATCH_WILDCARD)
+    if (val->match_type == MLVO_MATCH_WILDCARD)
         return true;
-    if (match_type == MLVO_MATCH_GROUP)
-        return match_group(m, val, to);
-    return svaleq(val, to);
+    if (val->match_type == MLVO_MATCH_GROUP)
+        return match_group(m, val->group, to);
+    return svaleq(val->sval, to);
 }
 
 static bool
-match_value_and_mark(struct matcher *m, struct sval val,
-                     struct matched_sval *to, enum mlvo_match_type match_type)
+match_value_and_mark(struct matcher *m, const struct rule_value *val,
+                     struct matched_sval *to)
 {
-    bool matched = match_value(m, val, to->sval, match_type);
+    bool matched = match_value(m, val, to->sval);
     if (matched)
         to->matched = true;
     return matched;
@@ -616,16 +669,14 @@ match_value_and_mark(struct matcher *m, struct sval val,
 
 /*
  * This function performs %-expansion on @value (see overview above),
- * and appends the result to @to.
+ * and puts the result in @expanded.  Without @rmlvo, it only checks the
+ * syntax, and reports errors to @scanner if not NULL.
  */
 static bool
-append_expanded_kccgst_value(struct matcher *m, darray_char *to,
-                             struct sval value)
+expand_kccgst_value(struct rule_names *rmlvo, struct scanner *scanner,
+                    struct sval value, darray_char *expanded)
 {
     const char *s = value.start;
-    darray_char expanded = darray_new();
-    char ch;
-    bool expanded_plus, to_plus;
 
     /*
      * Some ugly hand-lexing here, but going through the scanner is more
@@ -640,7 +691,7 @@ append_expanded_kccgst_value(struct matcher *m, darray_char *to,
         /* Check if that's a start of an expansion. */
         if (s[i] != '%') {
             /* Just a normal character. */
-            darray_appends_nullterminate(expanded, &s[i++], 1);
+            darray_appends_nullterminate(*expanded, &s[i++], 1);
             continue;
         }
         if (++i >= value.len) goto error;
@@ -669,7 +720,8 @@ append_expanded_kccgst_value(struct matcher *m, darray_char *to,
             int consumed;
 
             if (mlv != MLVO_LAYOUT && mlv != MLVO_VARIANT) {
-                matcher_err(m, "invalid index in %%-expansion; may only index layout or variant");
+                if (scanner)
+                    scanner_err(scanner, "invalid index in %%-expansion; may only index layout or variant");
                 goto error;
             }
 
@@ -684,29 +736,32 @@ append_expanded_kccgst_value(struct matcher *m, darray_char *to,
             if (s[i++] != sfx) goto error;
         }
 
+        if (!rmlvo)
+            continue;
+
         /* Get the expanded value. */
         expanded_value = NULL;
 
         if (mlv == MLVO_LAYOUT) {
             if (idx != XKB_LAYOUT_INVALID &&
-                idx < darray_size(m->rmlvo.layouts) &&
-                darray_size(m->rmlvo.layouts) > 1)
-                expanded_value = &darray_item(m->rmlvo.layouts, idx);
+                idx < darray_size(rmlvo->layouts) &&
+                darray_size(rmlvo->layouts) > 1)
+                expanded_value = &darray_item(rmlvo->layouts, idx);
             else if (idx == XKB_LAYOUT_INVALID &&
-                     darray_size(m->rmlvo.layouts) == 1)
-                expanded_value = &darray_item(m->rmlvo.layouts, 0);
+                     darray_size(rmlvo->layouts) == 1)
+                expanded_value = &darray_item(rmlvo->layouts, 0);
         }
         else if (mlv == MLVO_VARIANT) {
             if (idx != XKB_LAYOUT_INVALID &&
-                idx < darray_size(m->rmlvo.variants) &&
-                darray_size(m->rmlvo.variants) > 1)
-                expanded_value = &darray_item(m->rmlvo.variants, idx);
+                idx < darray_size(rmlvo->variants) &&
+                darray_size(rmlvo->variants) > 1)
+                expanded_value = &darray_item(rmlvo->variants, idx);
             else if (idx == XKB_LAYOUT_INVALID &&
-                     darray_size(m->rmlvo.variants) == 1)
-                expanded_value = &darray_item(m->rmlvo.variants, 0);
+                     darray_size(rmlvo->variants) == 1)
+                expanded_value = &darray_item(rmlvo->variants, 0);
         }
         else if (mlv == MLVO_MODEL) {
-            expanded_value = &m->rmlvo.model;
+            expanded_value = &rmlvo->model;
         }
 
         /* If we didn't get one, skip silently. */
@@ -714,15 +769,40 @@ append_expanded_kccgst_value(struct matcher *m, darray_char *to,
             continue;
 
         if (pfx != 0)
-            darray_appends_nullterminate(expanded, &pfx, 1);
-        darray_appends_nullterminate(expanded,
+            darray_appends_nullterminate(*expanded, &pfx, 1);
+        darray_appends_nullterminate(*expanded,
                                      expanded_value->sval.start,
                                      expanded_value->sval.len);
         if (sfx != 0)
-            darray_appends_nullterminate(expanded, &sfx, 1);
+            darray_appends_nullterminate(*expanded, &sfx, 1);
         expanded_value->matched = true;
     }
 
+    return true;
+
+error:
+    if (scanner)
+        scanner_err(scanner, "invalid %%-expansion in value; not used");
+    return false;
+}
+
+/*
+ * Appends the expansion of @value to @to.  An invalid value was already
+ * reported by parser_rule_verify(), so it is just not used.
+ */
+static void
+append_expanded_kccgst_value(struct matcher *m, darray_char *to,
+                             struct sval value)
+{
+    darray_char expanded = darray_new();
+    char ch;
+    bool expanded_plus, to_plus;
+
+    if (!expand_kccgst_value(&m->rmlvo, NULL, value, &expanded)) {
+        darray_free(expanded);
+        return;
+    }
+
     /*
      * Appending  bar to  foo ->  foo (not an error if this happens)
      * Appending +bar to  foo ->  foo+bar
@@ -741,97 +821,64 @@ append_expanded_kccgst_value(struct matcher *m, darray_char *to,
         darray_prepends_nullterminate(*to, expanded.item, expanded.size);
 
     darray_free(expanded);
-    return true;
-
-error:
-    darray_free(expanded);
-    matcher_err(m, "invalid %%-expansion in value; not used");
-    return false;
 }
 
 static void
-matcher_rule_verify(struct matcher *m)
+parser_rule_verify(struct rules_parser *p)
 {
-    if (m->rule.num_mlvo_values != m->mapping.num_mlvo ||
-        m->rule.num_kccgst_values != m->mapping.num_kccgst) {
-        matcher_err(m, "invalid rule: must have same number of values as mapping line; ignoring rule");
-        m->rule.skip = true;
+    darray_char expanded = darray_new();
+
+    if (p->rule.num_mlvo_values != p->mapping.num_mlvo ||
+        p->rule.num_kccgst_values != p->mapping.num_kccgst) {
+        parser_err(p, "invalid rule: must have same number of values as mapping line; ignoring rule");
+        p->rule.skip = true;
+        return;
     }
+
+    for (unsigned i = 0; i < p->rule.num_kccgst_values; i++) {
+        expand_kccgst_value(NULL, &p->scanner, p->rule.kccgst_value_at_pos[i],
+                            &expanded);
+        darray_resize(expanded, 0);
+    }
+    darray_free(expanded);
 }
 
+/* Adds the rule to the rule set of the current mapping. */
 static void
-matcher_rule_apply_if_matches(struct matcher *m)
+parser_rule_add(struct rules_parser *p)
 {
-    for (unsigned i = 0; i < m->mapping.num_mlvo; i++) {
-        enum rules_mlvo mlvo = m->mapping.mlvo_at_pos[i];
-        struct sval value = m->rule.mlvo_value_at_pos[i];
-        enum mlvo_match_type match_type = m->rule.match_type_at_pos[i];
-        struct matched_sval *to;
-        bool matched = false;
-
-        if (mlvo == MLVO_MODEL) {
-            to = &m->rmlvo.model;
-            matched = match_value_and_mark(m, value, to, match_type);
-        }
-        else if (mlvo == MLVO_LAYOUT) {
-            xkb_layout_index_t idx = m->mapping.layout_idx;
-            idx = (idx == XKB_LAYOUT_INVALID ? 0 : idx);
-            to = &darray_item(m->rmlvo.layouts, idx);
-            matched = match_value_and_mark(m, value, to, match_type);
-        }
-        else if (mlvo == MLVO_VARIANT) {
-            xkb_layout_index_t idx = m->mapping.layout_idx;
-            idx = (idx == XKB_LAYOUT_INVALID ? 0 : idx);
-            to = &darray_item(m->rmlvo.variants, idx);
-            matched = match_value_and_mark(m, value, to, match_type);
-        }
-        else if (mlvo == MLVO_OPTION) {
-            darray_foreach(to, m->rmlvo.options) {
-                matched = match_value_and_mark(m, value, to, match_type);
-                if (matched)
-                    break;
-            }
-        }
-
-        if (!matched)
-            return;
+    struct compiled_rules *rules = p->rules;
+    struct rule_set *set;
+
+    for (unsigned i = 0; i < p->rule.num_mlvo_values; i++)
+        darray_append(rules->values, p->rule.mlvo_value_at_pos[i]);
+
+    for (unsigned i = 0; i < p->rule.num_kccgst_values; i++) {
+        struct rule_value value = {
+            .sval = p->rule.kccgst_value_at_pos[i],
+            .match_type = MLVO_MATCH_NORMAL,
+            .group = -1,
+        };
+        darray_append(rules->values, value);
     }
 
-    for (unsigned i = 0; i < m->mapping.num_kccgst; i++) {
-        enum rules_kccgst kccgst = m->mapping.kccgst_at_pos[i];
-        struct sval value = m->rule.kccgst_value_at_pos[i];
-        append_expanded_kccgst_value(m, &m->kccgst[kccgst], value);
-    }
-
-    /*
-     * If a rule matches in a rule set, the rest of the set should be
-     * skipped. However, rule sets matching against options may contain
-     * several legitimate rules, so they are processed entirely.
-     */
-    if (!(m->mapping.defined_mlvo_mask & (1 << MLVO_OPTION)))
-        m->mapping.skip = true;
+    set = &darray_item(rules->rule_sets, darray_size(rules->rule_sets) - 1);
+    set->num_rules++;
 }
 
 static enum rules_token
-gettok(struct matcher *m)
+gettok(struct rules_parser *p)
 {
-    return lex(&m->scanner, &m->val);
+    return lex(&p->scanner, &p->val);
 }
 
 static bool
-matcher_match(struct matcher *m, const char *string, size_t len,
-              const char *file_name, struct xkb_component_names *out)
+parser_parse(struct rules_parser *p)
 {
     enum rules_token tok;
-    struct matched_sval *mval;
-
-    if (!m)
-        return false;
-
-    scanner_init(&m->scanner, m->ctx, string, len, file_name, NULL);
 
 initial:
-    switch (tok = gettok(m)) {
+    switch (tok = gettok(p)) {
     case TOK_BANG:
         goto bang;
     case TOK_END_OF_LINE:
@@ -843,20 +890,20 @@ initial:
     }
 
 bang:
-    switch (tok = gettok(m)) {
+    switch (tok = gettok(p)) {
     case TOK_GROUP_NAME:
-        matcher_group_start_new(m, m->val.string);
+        parser_group_start_new(p, p->val.string);
         goto group_name;
     case TOK_IDENTIFIER:
-        matcher_mapping_start_new(m);
-        matcher_mapping_set_mlvo(m, m->val.string);
+        parser_mapping_start_new(p);
+        parser_mapping_set_mlvo(p, p->val.string);
         goto mapping_mlvo;
     default:
         goto unexpected;
     }
 
 group_name:
-    switch (tok = gettok(m)) {
+    switch (tok = gettok(p)) {
     case TOK_EQUALS:
         goto group_element;
     default:
@@ -864,9 +911,9 @@ group_name:
     }
 
 group_element:
-    switch (tok = gettok(m)) {
+    switch (tok = gettok(p)) {
     case TOK_IDENTIFIER:
-        matcher_group_add_element(m, m->val.string);
+        parser_group_add_element(p, p->val.string);
         goto group_element;
     case TOK_END_OF_LINE:
         goto initial;
@@ -875,10 +922,10 @@ group_element:
     }
 
 mapping_mlvo:
-    switch (tok = gettok(m)) {
+    switch (tok = gettok(p)) {
     case TOK_IDENTIFIER:
-        if (!m->mapping.skip)
-            matcher_mapping_set_mlvo(m, m->val.string);
+        if (!p->mapping.skip)
+            parser_mapping_set_mlvo(p, p->val.string);
         goto mapping_mlvo;
     case TOK_EQUALS:
         goto mapping_kccgst;
@@ -887,21 +934,21 @@ mapping_mlvo:
     }
 
 mapping_kccgst:
-    switch (tok = gettok(m)) {
+    switch (tok = gettok(p)) {
     case TOK_IDENTIFIER:
-        if (!m->mapping.skip)
-            matcher_mapping_set_kccgst(m, m->val.string);
+        if (!p->mapping.skip)
+            parser_mapping_set_kccgst(p, p->val.string);
         goto mapping_kccgst;
     case TOK_END_OF_LINE:
-        if (!m->mapping.skip)
-            matcher_mapping_verify(m);
+        if (!p->mapping.skip)
+            parser_mapping_verify(p);
         goto rule_mlvo_first;
     default:
         goto unexpected;
     }
 
 rule_mlvo_first:
-    switch (tok = gettok(m)) {
+    switch (tok = gettok(p)) {
     case TOK_BANG:
         goto bang;
     case TOK_END_OF_LINE:
@@ -909,25 +956,25 @@ rule_mlvo_first:
     case TOK_END_OF_FILE:
         goto finish;
     default:
-        matcher_rule_start_new(m);
+        parser_rule_start_new(p);
         goto rule_mlvo_no_tok;
     }
 
 rule_mlvo:
-    tok = gettok(m);
+    tok = gettok(p);
 rule_mlvo_no_tok:
     switch (tok) {
     case TOK_IDENTIFIER:
-        if (!m->rule.skip)
-            matcher_rule_set_mlvo(m, m->val.string);
+        if (!p->rule.skip)
+            parser_rule_set_mlvo(p, p->val.string);
         goto rule_mlvo;
     case TOK_STAR:
-        if (!m->rule.skip)
-            matcher_rule_set_mlvo_wildcard(m);
+        if (!p->rule.skip)
+            parser_rule_set_mlvo_wildcard(p);
         goto rule_mlvo;
     case TOK_GROUP_NAME:
-        if (!m->rule.skip)
-            matcher_rule_set_mlvo_group(m, m->val.string);
+        if (!p->rule.skip)
+            parser_rule_set_mlvo_group(p, p->val.string);
         goto rule_mlvo;
     case TOK_EQUALS:
         goto rule_kccgst;
@@ -936,16 +983,16 @@ rule_mlvo_no_tok:
     }
 
 rule_kccgst:
-    switch (tok = gettok(m)) {
+    switch (tok = gettok(p)) {
     case TOK_IDENTIFIER:
-        if (!m->rule.skip)
-            matcher_rule_set_kccgst(m, m->val.string);
+        if (!p->rule.skip)
+            parser_rule_set_kccgst(p, p->val.string);
         goto rule_kccgst;
     case TOK_END_OF_LINE:
-        if (!m->rule.skip)
-            matcher_rule_verify(m);
-        if (!m->rule.skip)
-            matcher_rule_apply_if_matches(m);
+        if (!p->rule.skip)
+            parser_rule_verify(p);
+        if (!p->rule.skip)
+            parser_rule_add(p);
         goto rule_mlvo_first;
     default:
         goto unexpected;
@@ -960,12 +1007,168 @@ unexpected:
     }
 
 finish:
+    return true;
+
+state_error:
+    parser_err(p, "unexpected token");
+error:
+    return false;
+}
+
+static struct compiled_rules *
+compile_rules(struct xkb_context *ctx, const char *string, size_t size,
+              const char *path)
+{
+    struct compiled_rules *rules;
+    struct rules_parser *p;
+
+    rules = calloc(1, sizeof(*rules));
+    p = calloc(1, sizeof(*p));
+    if (!rules || !p)
+        goto err;
+
+    rules->path = strdup(path);
+    rules->string = malloc(size + 1);
+    if (!rules->path || !rules->string)
+        goto err;
+    memcpy(rules->string, string, size);
+    rules->string[size] = '\0';
+
+    p->rules = rules;
+    scanner_init(&p->scanner, ctx, rules->string, size, path, NULL);
+    rules->failed = !parser_parse(p);
+
+    free(p);
+    return rules;
+
+err:
+    free(p);
+    compiled_rules_free(rules);
+    return NULL;
+}
+
+/*
+ * This following is very stupid, but this is how it works.
+ * See the "Notes" section in the overview above.
+ */
+static bool
+matcher_mapping_applies(struct matcher *m, const struct mapping *mapping)
+{
+    if (mapping->defined_mlvo_mask & (1u << MLVO_LAYOUT)) {
+        if (mapping->layout_idx == XKB_LAYOUT_INVALID) {
+            if (darray_size(m->rmlvo.layouts) > 1)
+                return false;
+        }
+        else {
+            if (darray_size(m->rmlvo.layouts) == 1 ||
+                mapping->layout_idx >= darray_size(m->rmlvo.layouts))
+                return false;
+        }
+    }
+
+    if (mapping->defined_mlvo_mask & (1u << MLVO_VARIANT)) {
+        if (mapping->variant_idx == XKB_LAYOUT_INVALID) {
+            if (darray_size(m->rmlvo.variants) > 1)
+                return false;
+        }
+        else {
+            if (darray_size(m->rmlvo.variants) == 1 ||
+                mapping->variant_idx >= darray_size(m->rmlvo.variants))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+static bool
+matcher_rule_apply_if_matches(struct matcher *m, const struct mapping *mapping,
+                              const struct rule_value *values)
+{
+    for (unsigned i = 0; i < mapping->num_mlvo; i++) {
+        enum rules_mlvo mlvo = mapping->mlvo_at_pos[i];
+        const struct rule_value *value = &values[i];
+        struct matched_sval *to;
+        bool matched = false;
+
+        if (mlvo == MLVO_MODEL) {
+            to = &m->rmlvo.model;
+            matched = match_value_and_mark(m, value, to);
+        }
+        else if (mlvo == MLVO_LAYOUT) {
+            xkb_layout_index_t idx = mapping->layout_idx;
+            idx = (idx == XKB_LAYOUT_INVALID ? 0 : idx);
+            to = &darray_item(m->rmlvo.layouts, idx);
+            matched = match_value_and_mark(m, value, to);
+        }
+        else if (mlvo == MLVO_VARIANT) {
+            xkb_layout_index_t idx = mapping->layout_idx;
+            idx = (idx == XKB_LAYOUT_INVALID ? 0 : idx);
+            to = &darray_item(m->rmlvo.variants, idx);
+            matched = match_value_and_mark(m, value, to);
+        }
+        else if (mlvo == MLVO_OPTION) {
+            darray_foreach(to, m->rmlvo.options) {
+                matched = match_value_and_mark(m, value, to);
+                if (matched)
+                    break;
+            }
+        }
+
+        if (!matched)
+            return false;
+    }
+
+    for (unsigned i = 0; i < mapping->num_kccgst; i++) {
+        enum rules_kccgst kccgst = mapping->kccgst_at_pos[i];
+        struct sval value = values[mapping->num_mlvo + i].sval;
+        append_expanded_kccgst_value(m, &m->kccgst[kccgst], value);
+    }
+
+    return true;
+}
+
+static bool
+matcher_match(struct matcher *m, struct xkb_component_names *out)
+{
+    const struct rule_set *set;
+    struct matched_sval *mval;
+
+    if (!m || m->rules->failed)
+        return false;
+
+    darray_foreach(set, m->rules->rule_sets) {
+        unsigned int rule_size = set->mapping.num_mlvo +
+                                 set->mapping.num_kccgst;
+
+        if (!matcher_mapping_applies(m, &set->mapping))
+            continue;
+
+        for (unsigned i = 0; i < set->num_rules; i++) {
+            const struct rule_value *values =
+                &darray_item(m->rules->values,
+                             set->first_value + i * rule_size);
+
+            if (!matcher_rule_apply_if_matches(m, &set->mapping, values))
+                continue;
+
+            /*
+             * If a rule matches in a rule set, the rest of the set should
+             * be skipped. However, rule sets matching against options may
+             * contain several legitimate rules, so they are processed
+             * entirely.
+             */
+            if (!(set->mapping.defined_mlvo_mask & (1 << MLVO_OPTION)))
+                break;
+        }
+    }
+
     if (darray_empty(m->kccgst[KCCGST_KEYCODES]) ||
         darray_empty(m->kccgst[KCCGST_TYPES]) ||
         darray_empty(m->kccgst[KCCGST_COMPAT]) ||
         /* darray_empty(m->kccgst[KCCGST_GEOMETRY]) || */
         darray_empty(m->kccgst[KCCGST_SYMBOLS]))
-        goto error;
+        return false;
 
     darray_steal(m->kccgst[KCCGST_KEYCODES], &out->keycodes, NULL);
     darray_steal(m->kccgst[KCCGST_TYPES], &out->types, NULL);
@@ -992,11 +1195,129 @@ finish:
                     mval->sval.len, mval->sval.start);
 
     return true;
+}
 
-state_error:
-    matcher_err(m, "unexpected token");
-error:
-    return false;
+static struct compiled_rules **
+FindCompiledRules(struct rules_cache *cache, const char *path)
+{
+    struct compiled_rules **rules;
+
+    darray_foreach(rules, cache->files)
+        if (streq((*rules)->path, path))
+            return rules;
+
+    return NULL;
+}
+
+/* Puts newly compiled rules in the cache, replacing those of the path. */
+static void
+StoreCompiledRules(struct rules_cache *cache, struct compiled_rules *rules,
+                   const struct stat *st)
+{
+    struct compiled_rules **entry = FindCompiledRules(cache, rules->path);
+
+    file_stamp_set(&rules->stamp, st);
+
+    if (entry) {
+        darray_append(cache->retired, *entry);
+        *entry = rules;
+    }
+    else {
+        darray_append(cache->files, rules);
+    }
+}
+
+static struct rules_cache *
+GetRulesCache(struct xkb_context *ctx)
+{
+    if (!ctx->compiled_rules)
+        ctx->compiled_rules = calloc(1, sizeof(*ctx->compiled_rules));
+
+    return ctx->compiled_rules;
+}
+
+/*
+ * Returns the compiled rules of the file, from the cache if it is
+ * unchanged.  If *owned is set, they couldn't be cached, and are left to
+ * the caller to free.
+ */
+static struct compiled_rules *
+GetCompiledRules(struct xkb_context *ctx, FILE *file, const char *path,
+                 bool *owned)
+{
+    struct rules_cache *cache;
+    struct compiled_rules **entry, *rules = NULL;
+    struct stat st;
+    bool cacheable;
+    char *string;
+    size_t size;
+
+    *owned = false;
+    cacheable = fstat_settled(file, &st);
+
+    xkb_context_lock(ctx);
+    cache = GetRulesCache(ctx);
+    entry = cache ? FindCompiledRules(cache, path) : NULL;
+    if (entry && cacheable && file_stamp_matches(&(*entry)->stamp, &st)) {
+        ctx->rules_cache_hits++;
+        rules = *entry;
+    }
+    else {
+        ctx->rules_cache_misses++;
+    }
+    xkb_context_unlock(ctx);
+
+    if (rules)
+        return rules;
+
+    if (!map_file(file, &string, &size)) {
+        log_err(ctx, "Couldn't read rules file \"%s\": %s\n",
+                path, strerror(errno));
+        return NULL;
+    }
+
+    rules = compile_rules(ctx, string, size, path);
+    unmap_file(string, size);
+    if (!rules)
+        return NULL;
+
+    if (!cache || !cacheable) {
+        *owned = true;
+        return rules;
+    }
+
+    xkb_context_lock(ctx);
+    StoreCompiledRules(cache, rules, &st);
+    xkb_context_unlock(ctx);
+    return rules;
+}
+
+void
+rules_cache_free_retired(struct rules_cache *cache)
+{
+    struct compiled_rules **rules;
+
+    if (!cache)
+        return;
+
+    darray_foreach(rules, cache->retired)
+        compiled_rules_free(*rules);
+    darray_free(cache->retired);
+}
+
+void
+rules_cache_free(struct rules_cache *cache)
+{
+    struct compiled_rules **rules;
+
+    if (!cache)
+        return;
+
+    darray_foreach(rules, cache->files)
+        compiled_rules_free(*rules);
+    darray_free(cache->files);
+    rules_cache_free_retired(cache);
+    free(cache);
 }
 
 bool
@@ -1007,29 +1328,33 @@ xkb_components_from_rules(struct xkb_context *ctx,
     bool ret = false;
     FILE *file;
     char *path;
-    char *string;
-    size_t size;
+    struct compiled_rules *rules;
     struct matcher *matcher;
+    bool owned;
+
+    /* Once per keymap, which is then compiled from the components. */
+    RecheckIncludeDirs(ctx);
 
     file = FindFileInXkbPath(ctx, rmlvo->rules, FILE_TYPE_RULES, &path);
     if (!file)
         goto err_out;
 
-    ret = map_file(file, &string, &size);
-    if (!ret) {
-        log_err(ctx, "Couldn't read rules file \"%s\": %s\n",
-                path, strerror(errno));
-        goto err_file;
-    }
+    xkb_context_begin_compile(ctx);
 
-    matcher = matcher_new(ctx, rmlvo);
-    ret = matcher_match(matcher, string, size, path, out);
+    rules = GetCompiledRules(ctx, file, path, &owned);
+    if (!rules)
+        goto err_compile;
+
+    matcher = matcher_new(ctx, rmlvo, rules);
+    ret = matcher_match(matcher, out);
     if (!ret)
         log_err(ctx, "No components returned from XKB rules \"%s\"\n", path);
     matcher_free(matcher);
 
-    unmap_file(string, size);
-err_file:
+    if (owned)
+        compiled_rules_free(rules);
+err_compile:
+    xkb_context_end_compile(ctx);
     free(path);
     fclose(file);
 err_out:
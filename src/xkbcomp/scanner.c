@@ -24,6 +24,7 @@
 #include "xkbcomp-priv.h"
 #include "parser-priv.h"
 #include "scanner-utils.h"
+#include "arena.h"
 
 static bool
 number(struct scanner *s, int64_t *out, int *out_tok)
@@ -107,7 +108,7 @@ skip_more_whitespace_and_comments:
             scanner_err(s, "unterminated string literal");
             return ERROR_TOK;
         }
-        yylval->str = strdup(s->buf);
+        yylval->str = arena_strdup(s->priv, s->buf);
         if (!yylval->str)
             return ERROR_TOK;
         return STRING;
@@ -158,7 +159,7 @@ skip_more_whitespace_and_comments:
         tok = keyword_to_token(s->buf, s->buf_pos - 1);
         if (tok != -1) return tok;
 
-        yylval->str = strdup(s->buf);
+        yylval->str = arena_strdup(s->priv, s->buf);
         if (!yylval->str)
             return ERROR_TOK;
         return IDENT;
@@ -177,12 +178,223 @@ skip_more_whitespace_and_comments:
     return ERROR_TOK;
 }
 
+/* Skip spaces and comments, like the lexer. */
+static void
+index_skip_space(struct scanner *s)
+{
+    for (;;) {
+        while (is_space(peek(s))) next(s);
+        if (!lit(s, "//") && !chr(s, '#'))
+            return;
+        skip_to_eol(s);
+    }
+}
+
+static int
+index_keyword(struct scanner *s)
+{
+    if (!is_alpha(peek(s)) && peek(s) != '_')
+        return -1;
+
+    s->buf_pos = 0;
+    while (is_alnum(peek(s)) || peek(s) == '_')
+        buf_append(s, next(s));
+    if (!buf_append(s, '\0'))
+        return -1;
+
+    return keyword_to_token(s->buf, s->buf_pos - 1);
+}
+
+static const bool index_special[256] = {
+    ['/'] = true, ['#'] = true, ['"'] = true, ['<'] = true,
+    ['{'] = true, ['}'] = true,
+};
+
+/*
+ * Skip the body of a map, up to and including the closing brace.  This is
+ * most of the file, so it only looks at the characters which matter, and
+ * doesn't keep track of the line and column.
+ */
+static bool
+index_skip_body(struct scanner *s)
+{
+    const char *p = s->s + s->pos, *end = s->s + s->len;
+    unsigned depth = 1;
+
+    while (p < end) {
+        /* Most characters don't matter. */
+        while (!index_special[(unsigned char) *p])
+            if (++p >= end)
+                return false;
+
+        switch (*p++) {
+        case '/':
+            if (p >= end || *p != '/')
+                break;
+            /* fallthrough */
+        case '#':
+            p = memchr(p, '\n', end - p);
+            if (!p)
+                p = end;
+            break;
+        case '\"':
+            /* As in the lexer, a backslash can't escape the quote. */
+            while (p < end && *p != '\"' && *p != '\n')
+                p += (*p == '\\' && p + 1 < end && p[1] == '\\') ? 2 : 1;
+            if (p >= end || *p++ != '\"')
+                return false;
+            break;
+        case '<':
+            while (p < end && is_graph(*p) && *p != '>')
+                p++;
+            if (p >= end || *p++ != '>')
+                return false;
+            break;
+        case '{':
+            depth++;
+            break;
+        case '}':
+            if (--depth == 0) {
+                s->pos = p - s->s;
+                return true;
+            }
+            break;
+        }
+    }
+
+    return false;
+}
+
+static bool
+index_map(struct scanner *s, struct xkb_map_location *loc)
+{
+    int tok;
+
+    loc->offset = s->pos;
+
+    /* Flags, then the map type. */
+    for (;;) {
+        tok = index_keyword(s);
+        if (tok == DEFAULT)
+            loc->is_default = true;
+        else if (tok == XKB_KEYCODES || tok == XKB_TYPES ||
+                 tok == XKB_COMPATMAP || tok == XKB_SYMBOLS)
+            break;
+        else if (tok != PARTIAL && tok != HIDDEN &&
+                 tok != ALPHANUMERIC_KEYS && tok != MODIFIER_KEYS &&
+                 tok != KEYPAD_KEYS && tok != FUNCTION_KEYS &&
+                 tok != ALTERNATE_GROUP)
+            return false;
+        index_skip_space(s);
+    }
+    index_skip_space(s);
+
+    if (chr(s, '\"')) {
+        loc->has_name = true;
+        loc->name_offset = s->pos;
+        while (!eof(s) && !eol(s) && peek(s) != '\"' && peek(s) != '\\')
+            next(s);
+        loc->name_len = s->pos - loc->name_offset;
+        if (!chr(s, '\"'))
+            return false;
+        index_skip_space(s);
+    }
+
+    if (!chr(s, '{') || !index_skip_body(s))
+        return false;
+    index_skip_space(s);
+    if (!chr(s, ';'))
+        return false;
+
+    loc->len = s->pos - loc->offset;
+    return true;
+}
+
+/*
+ * Find the maps in a file, without parsing them, so that only the one
+ * which is needed gets parsed.  Only files made of plain keycodes, types,
+ * compat and symbols maps are indexed; anything else, or anything which
+ * doesn't look right, is left to the parser.
+ */
+bool
+XkbIndexMaps(const char *string, size_t len, darray_map_location *index)
+{
+    struct scanner scanner;
+
+    scanner_init(&scanner, NULL, string, len, NULL, NULL);
+
+    index_skip_space(&scanner);
+    while (!eof(&scanner)) {
+        struct xkb_map_location loc = { 0 };
+
+        if (!index_map(&scanner, &loc)) {
+            darray_free(*index);
+            return false;
+        }
+
+        darray_append(*index, loc);
+        index_skip_space(&scanner);
+    }
+
+    return !darray_empty(*index);
+}
+
+static const struct xkb_map_location *
+find_map(const char *string, const darray_map_location *index,
+         const char *map)
+{
+    const struct xkb_map_location *loc;
+
+    darray_foreach(loc, *index) {
+        if (map) {
+            if (loc->has_name && loc->name_len == strlen(map) &&
+                memcmp(string + loc->name_offset, map, loc->name_len) == 0)
+                return loc;
+        }
+        else if (loc->is_default) {
+            return loc;
+        }
+    }
+
+    if (map)
+        return NULL;
+    return &darray_item(*index, 0);
+}
+
 XkbFile *
 XkbParseString(struct xkb_context *ctx, const char *string, size_t len,
                const char *file_name, const char *map)
+{
+    return XkbParseIndexedString(ctx, string, len, NULL, file_name, map);
+}
+
+XkbFile *
+XkbParseIndexedString(struct xkb_context *ctx, const char *string, size_t len,
+                      const darray_map_location *index,
+                      const char *file_name, const char *map)
 {
     struct scanner scanner;
-    scanner_init(&scanner, ctx, string, len, file_name, NULL);
+    const struct xkb_map_location *loc = NULL;
+    const char *nl;
+
+    if (index && !darray_empty(*index))
+        loc = find_map(string, index, map);
+
+    if (!loc) {
+        scanner_init(&scanner, ctx, string, len, file_name, NULL);
+        return parse(ctx, &scanner, map);
+    }
+
+    /* Parse just this map, as if it were the whole file. */
+    scanner_init(&scanner, ctx, string, loc->offset + loc->len, file_name,
+                 NULL);
+    while ((nl = memchr(string + scanner.pos, '\n',
+                        loc->offset - scanner.pos))) {
+        scanner.pos = nl - string + 1;
+        scanner.line++;
+    }
+    scanner.column = loc->offset - scanner.pos + 1;
+    scanner.pos = loc->offset;
     return parse(ctx, &scanner, map);
 }
 
@@ -552,8 +552,7 @@ HandleIncludeSymbols(SymbolsInfo *info, IncludeStmt *include)
     SymbolsInfo included;
 
     InitSymbolsInfo(&included, info->keymap, info->actions, &info->mods);
-    included.name = include->stmt;
-    include->stmt = NULL;
+    included.name = strdup_safe(include->stmt);
 
     for (IncludeStmt *stmt = include; stmt; stmt = stmt->next_incl) {
         SymbolsInfo next_incl;
@@ -587,7 +586,6 @@ HandleIncludeSymbols(SymbolsInfo *info, IncludeStmt *include)
         MergeIncludedSymbols(&included, &next_incl, stmt->merge);
 
         ClearSymbolsInfo(&next_incl);
-        FreeXkbFile(file);
     }
 
     MergeIncludedSymbols(info, &included, include->merge);
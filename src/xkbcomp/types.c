@@ -209,8 +209,7 @@ HandleIncludeKeyTypes(KeyTypesInfo *info, IncludeStmt *include)
     KeyTypesInfo included;
 
     InitKeyTypesInfo(&included, info->ctx, &info->mods);
-    included.name = include->stmt;
-    include->stmt = NULL;
+    included.name = strdup_safe(include->stmt);
 
     for (IncludeStmt *stmt = include; stmt; stmt = stmt->next_incl) {
         KeyTypesInfo next_incl;
@@ -230,7 +229,6 @@ HandleIncludeKeyTypes(KeyTypesInfo *info, IncludeStmt *include)
         MergeIncludedKeyTypes(&included, &next_incl, stmt->merge);
 
         ClearKeyTypesInfo(&next_incl);
-        FreeXkbFile(file);
     }
 
     MergeIncludedKeyTypes(info, &included, include->merge);
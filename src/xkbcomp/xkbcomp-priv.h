@@ -49,6 +49,26 @@ XkbParseString(struct xkb_context *ctx,
                const char *string, size_t len,
                const char *file_name, const char *map);
 
+/* Where a map is in a file which has several; see XkbIndexMaps(). */
+struct xkb_map_location {
+    size_t offset;
+    size_t len;
+    size_t name_offset;
+    size_t name_len;
+    bool has_name;
+    bool is_default;
+};
+typedef darray(struct xkb_map_location) darray_map_location;
+
+bool
+XkbIndexMaps(const char *string, size_t len, darray_map_location *index);
+
+XkbFile *
+XkbParseIndexedString(struct xkb_context *ctx,
+                      const char *string, size_t len,
+                      const darray_map_location *index,
+                      const char *file_name, const char *map);
+
 void
 FreeXkbFile(XkbFile *file);
 
@@ -29,6 +29,7 @@
 
 #include "xkbcomp-priv.h"
 #include "rules.h"
+#include "include.h"
 
 static bool
 compile_keymap_file(struct xkb_keymap *keymap, XkbFile *file)
@@ -103,6 +104,8 @@ text_v1_keymap_new_from_string(struct xkb_keymap *keymap,
     bool ok;
     XkbFile *xkb_file;
 
+    RecheckIncludeDirs(keymap->ctx);
+
     xkb_file = XkbParseString(keymap->ctx, string, len, "(input string)", NULL);
     if (!xkb_file) {
         log_err(keymap->ctx, "Failed to parse input xkb string\n");
@@ -120,6 +123,8 @@ text_v1_keymap_new_from_file(struct xkb_keymap *keymap, FILE *file)
     bool ok;
     XkbFile *xkb_file;
 
+    RecheckIncludeDirs(keymap->ctx);
+
     xkb_file = XkbParseFile(keymap->ctx, file, "(unknown file)", NULL);
     if (!xkb_file) {
         log_err(keymap->ctx, "Failed to parse input xkb file\n");
@@ -0,0 +1,192 @@
+/*
+ * Copyright © 2026 libxkbcommon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "test.h"
+#include "evdev-scancodes.h"
+
+#define DATA_PATH "keymaps/stringcomp.data"
+
+static struct xkb_keymap *
+load_binary(struct xkb_context *ctx, const char *buffer, size_t length)
+{
+    return xkb_keymap_new_from_buffer(ctx, buffer, length,
+                                      XKB_KEYMAP_FORMAT_BINARY_V1,
+                                      XKB_KEYMAP_COMPILE_NO_FLAGS);
+}
+
+static void
+test_round_trip(struct xkb_context *ctx)
+{
+    struct xkb_keymap *keymap, *loaded;
+    char *original, *dump, *binary, *binary2;
+    size_t length, length2;
+    FILE *file;
+
+    original = test_read_file(DATA_PATH);
+    assert(original);
+    keymap = test_compile_string(ctx, original);
+    assert(keymap);
+
+    binary = xkb_keymap_get_as_buffer(keymap, XKB_KEYMAP_FORMAT_BINARY_V1,
+                                      &length);
+    assert(binary);
+    xkb_keymap_unref(keymap);
+
+    /* The loaded keymap dumps to the same text, and to the same binary. */
+    loaded = load_binary(ctx, binary, length);
+    assert(loaded);
+    dump = xkb_keymap_get_as_string(loaded, XKB_KEYMAP_FORMAT_TEXT_V1);
+    assert(dump);
+    assert(streq(original, dump));
+    free(dump);
+
+    binary2 = xkb_keymap_get_as_buffer(loaded, XKB_KEYMAP_USE_ORIGINAL_FORMAT,
+                                       &length2);
+    assert(binary2);
+    assert(length2 == length && memcmp(binary, binary2, length) == 0);
+    free(binary2);
+
+    /* The text formats work through the buffer function too. */
+    dump = xkb_keymap_get_as_buffer(loaded, XKB_KEYMAP_FORMAT_TEXT_V1,
+                                    &length2);
+    assert(dump);
+    assert(length2 == strlen(original) && streq(original, dump));
+    free(dump);
+    xkb_keymap_unref(loaded);
+
+    /* From a file, which is mapped. */
+    file = tmpfile();
+    assert(file);
+    assert(fwrite(binary, 1, length, file) == length);
+    assert(fflush(file) == 0);
+    rewind(file);
+    loaded = xkb_keymap_new_from_file(ctx, file, XKB_KEYMAP_FORMAT_BINARY_V1,
+                                      XKB_KEYMAP_COMPILE_CACHE_TEXT);
+    assert(loaded);
+    fclose(file);
+    dump = xkb_keymap_get_as_string(loaded, XKB_KEYMAP_FORMAT_TEXT_V1);
+    assert(dump);
+    assert(streq(original, dump));
+    free(dump);
+
+    /* Not supported by the string functions. */
+    assert(!xkb_keymap_get_as_string(loaded, XKB_KEYMAP_USE_ORIGINAL_FORMAT));
+    assert(!xkb_keymap_new_from_string(ctx, binary,
+                                       XKB_KEYMAP_FORMAT_BINARY_V1, 0));
+    xkb_keymap_unref(loaded);
+
+    free(binary);
+    free(original);
+}
+
+static void
+test_rules_keymap(struct xkb_context *ctx)
+{
+    struct xkb_keymap *keymap, *loaded;
+    char *binary;
+    size_t length;
+
+    keymap = test_compile_rules(ctx, NULL, NULL,
+                                "ru,ca,de,us", ",multix,neo,intl", NULL);
+    assert(keymap);
+    binary = xkb_keymap_get_as_buffer(keymap, XKB_KEYMAP_FORMAT_BINARY_V1,
+                                      &length);
+    assert(binary);
+    xkb_keymap_unref(keymap);
+
+    loaded = load_binary(ctx, binary, length);
+    assert(loaded);
+    assert(xkb_keymap_num_layouts(loaded) == 4);
+    assert(test_key_seq(loaded,
+                        KEY_Q,          BOTH,  XKB_KEY_Cyrillic_shorti,  NEXT,
+                        KEY_LEFTSHIFT,  DOWN,  XKB_KEY_Shift_L,          NEXT,
+                        KEY_Q,          BOTH,  XKB_KEY_Cyrillic_SHORTI,  NEXT,
+                        KEY_LEFTSHIFT,  UP,    XKB_KEY_Shift_L,          NEXT,
+                        KEY_1,          BOTH,  XKB_KEY_1,                FINISH));
+    xkb_keymap_unref(loaded);
+    free(binary);
+}
+
+static void
+test_invalid(struct xkb_context *ctx)
+{
+    struct xkb_keymap *keymap;
+    char *binary, *copy;
+    size_t length;
+
+    keymap = test_compile_file(ctx, DATA_PATH);
+    assert(keymap);
+    binary = xkb_keymap_get_as_buffer(keymap, XKB_KEYMAP_FORMAT_BINARY_V1,
+                                      &length);
+    assert(binary);
+    xkb_keymap_unref(keymap);
+
+    xkb_context_set_log_level(ctx, XKB_LOG_LEVEL_CRITICAL);
+
+    /* Truncated. */
+    for (size_t i = 0; i < 256; i++)
+        assert(!load_binary(ctx, binary, i));
+    assert(!load_binary(ctx, binary, length - 1));
+
+    /* Text isn't binary, and binary isn't text. */
+    assert(!load_binary(ctx, "xkb_keymap {};", strlen("xkb_keymap {};")));
+    assert(!xkb_keymap_new_from_buffer(ctx, binary, length,
+                                       XKB_KEYMAP_FORMAT_TEXT_V1, 0));
+
+    /* Random damage must be detected or harmless, never crash. */
+    copy = malloc(length);
+    assert(copy);
+    srand(0);
+    for (int i = 0; i < 2000; i++) {
+        memcpy(copy, binary, length);
+        for (int j = 0; j < 4; j++)
+            copy[rand() % length] = (char) rand();
+        keymap = load_binary(ctx, copy, length);
+        xkb_keymap_unref(keymap);
+    }
+    free(copy);
+
+    xkb_context_set_log_level(ctx, XKB_LOG_LEVEL_ERROR);
+    free(binary);
+}
+
+int
+main(void)
+{
+    struct xkb_context *ctx = test_get_context(0);
+
+    assert(ctx);
+
+    test_round_trip(ctx);
+    test_rules_keymap(ctx);
+    test_invalid(ctx);
+
+    xkb_context_unref(ctx);
+
+    return 0;
+}
@@ -238,6 +238,10 @@ test_get_context(enum test_context_flags test_flags)
     else {
         ctx_flags |= XKB_CONTEXT_NO_ENVIRONMENT_NAMES;
     }
+    if (test_flags & CONTEXT_SHARE_KEYMAPS)
+        ctx_flags |= XKB_CONTEXT_SHARE_KEYMAPS;
+    if (test_flags & CONTEXT_THREAD_SAFE)
+        ctx_flags |= XKB_CONTEXT_THREAD_SAFE;
 
     ctx = xkb_context_new(ctx_flags);
     if (!ctx)
@@ -23,8 +23,328 @@
  * Author: Daniel Stone <daniel@fooishbar.org>
  */
 
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <utime.h>
+
 #include "test.h"
 #include "context.h"
+#include "xkbcomp/xkbcomp-priv.h"
+#include "xkbcomp/rules.h"
+
+static void
+test_parsed_file_cache(void)
+{
+    struct xkb_context *ctx = test_get_context(0);
+    struct xkb_keymap *keymap;
+    unsigned int misses;
+    char *dump, *dump2;
+
+    assert(ctx);
+
+    /* The layouts share some includes, e.g. latin in us and de. */
+    keymap = test_compile_rules(ctx, "evdev", "pc104", "us,ru,il,de",
+                                ",,,neo", NULL);
+    assert(keymap);
+    assert(ctx->parsed_file_misses > 0 && ctx->parsed_file_hits > 0);
+    dump = xkb_keymap_get_as_string(keymap, XKB_KEYMAP_FORMAT_TEXT_V1);
+    assert(dump);
+    xkb_keymap_unref(keymap);
+
+    /* Nothing is parsed again, and the shared ASTs weren't modified. */
+    misses = ctx->parsed_file_misses;
+    keymap = test_compile_rules(ctx, "evdev", "pc104", "us,ru,il,de",
+                                ",,,neo", NULL);
+    assert(keymap);
+    assert(ctx->parsed_file_misses == misses);
+    dump2 = xkb_keymap_get_as_string(keymap, XKB_KEYMAP_FORMAT_TEXT_V1);
+    assert(dump2);
+    assert(streq(dump, dump2));
+    xkb_keymap_unref(keymap);
+
+    free(dump);
+    free(dump2);
+    xkb_context_unref(ctx);
+}
+
+#define INCLUDE_ROOT_TEMPLATE "/tmp/xkbcommon-test-include-XXXXXX"
+
+/* A temporary include path, with the directory of a type and its "test". */
+struct include_root {
+    char dir[sizeof(INCLUDE_ROOT_TEMPLATE)];
+    char *type_dir;
+    char *path;
+};
+
+static void
+setup_include_root(struct include_root *root, struct xkb_context *ctx,
+                   const char *type_dir)
+{
+    memcpy(root->dir, INCLUDE_ROOT_TEMPLATE, sizeof(root->dir));
+    assert(mkdtemp(root->dir));
+    assert(asprintf(&root->type_dir, "%s/%s", root->dir, type_dir) >= 0);
+    assert(mkdir(root->type_dir, 0700) == 0);
+    assert(asprintf(&root->path, "%s/test", root->type_dir) >= 0);
+    assert(xkb_context_include_path_append(ctx, root->dir));
+}
+
+static void
+teardown_include_root(struct include_root *root)
+{
+    unlink(root->path);
+    rmdir(root->type_dir);
+    rmdir(root->dir);
+    free(root->path);
+    free(root->type_dir);
+}
+
+static void
+write_file(const char *path, const char *contents, time_t mtime)
+{
+    struct utimbuf times = { mtime, mtime };
+    FILE *file = fopen(path, "w");
+
+    assert(file);
+    assert(fputs(contents, file) >= 0);
+    assert(fclose(file) == 0);
+    if (mtime)
+        assert(utime(path, &times) == 0);
+}
+
+static void
+write_symbols(const char *path, const char *keysym, time_t mtime)
+{
+    char *contents;
+
+    assert(asprintf(&contents, "xkb_symbols { key <A> { [ %s ] }; };\n",
+                    keysym) >= 0);
+    write_file(path, contents, mtime);
+    free(contents);
+}
+
+static xkb_keysym_t
+compile_include(struct xkb_context *ctx, const char *include)
+{
+    struct xkb_keymap *keymap;
+    const xkb_keysym_t *syms;
+    xkb_keysym_t sym;
+    char *string;
+
+    assert(asprintf(&string,
+                    "xkb_keymap {\n"
+                    "  xkb_keycodes { <A> = 38; };\n"
+                    "  xkb_types { include \"basic\" };\n"
+                    "  xkb_compat { };\n"
+                    "  xkb_symbols { include \"%s\" };\n"
+                    "};\n", include) >= 0);
+    keymap = test_compile_string(ctx, string);
+    free(string);
+    assert(keymap);
+    assert(xkb_keymap_key_get_syms_by_level(keymap, 38, 0, 0, &syms) == 1);
+    sym = syms[0];
+    xkb_keymap_unref(keymap);
+
+    return sym;
+}
+
+static void
+test_parsed_file_cache_invalidation(void)
+{
+    struct xkb_context *ctx = test_get_context(0);
+    struct include_root root;
+    unsigned int misses;
+    time_t now = time(NULL);
+
+    assert(ctx);
+    setup_include_root(&root, ctx, "symbols");
+
+    write_symbols(root.path, "a", now - 100);
+    assert(compile_include(ctx, "test") == XKB_KEY_a);
+    misses = ctx->parsed_file_misses;
+    assert(compile_include(ctx, "test") == XKB_KEY_a);
+    assert(ctx->parsed_file_misses == misses);
+
+    /* Changed, with the same size. */
+    write_symbols(root.path, "b", now - 50);
+    assert(compile_include(ctx, "test") == XKB_KEY_b);
+    assert(ctx->parsed_file_misses == misses + 1);
+
+    /* Just modified, so it can't be trusted yet. */
+    write_symbols(root.path, "c", 0);
+    assert(compile_include(ctx, "test") == XKB_KEY_c);
+    assert(compile_include(ctx, "test") == XKB_KEY_c);
+    assert(ctx->parsed_file_misses == misses + 3);
+
+    xkb_context_unref(ctx);
+    teardown_include_root(&root);
+}
+
+static void
+test_map_index(void)
+{
+    struct xkb_context *ctx = test_get_context(0);
+    struct include_root root;
+    time_t now = time(NULL);
+
+    assert(ctx);
+    setup_include_root(&root, ctx, "symbols");
+
+    /* Braces in comments, strings and key names don't count. */
+    write_file(root.path,
+               "// A comment with a brace {\n"
+               "xkb_symbols \"first\" {\n"
+               "    name[Group1] = \"Brace }\";\n"
+               "    key <A> { [ a ] };\n"
+               "};\n"
+               "partial default alphanumeric_keys\n"
+               "xkb_symbols \"second\" { key <A> { [ b ] }; };\n"
+               "# Another comment }\n"
+               "xkb_symbols \"third\" { key <A> { [ c ] }; };\n",
+               now - 100);
+    assert(compile_include(ctx, "test") == XKB_KEY_b);
+    assert(compile_include(ctx, "test(first)") == XKB_KEY_a);
+    assert(compile_include(ctx, "test(third)") == XKB_KEY_c);
+
+    /* The index is redone when the file changes. */
+    write_file(root.path,
+               "xkb_symbols \"third\" { key <A> { [ z ] }; };\n"
+               "xkb_symbols \"first\" { key <A> { [ y ] }; };\n",
+               now - 50);
+    assert(compile_include(ctx, "test") == XKB_KEY_z);
+    assert(compile_include(ctx, "test(first)") == XKB_KEY_y);
+
+    xkb_context_unref(ctx);
+    teardown_include_root(&root);
+}
+
+static void
+test_include_dir_cache(void)
+{
+    struct xkb_context *ctx;
+    struct include_root root, root2;
+    char *data_path;
+    unsigned int checks, avoided;
+    time_t now = time(NULL);
+    struct utimbuf times = { now - 100, now - 100 };
+
+    /* The first directories are searched before the test data. */
+    ctx = xkb_context_new(XKB_CONTEXT_NO_DEFAULT_INCLUDES |
+                          XKB_CONTEXT_NO_ENVIRONMENT_NAMES);
+    assert(ctx);
+    setup_include_root(&root, ctx, "symbols");
+    setup_include_root(&root2, ctx, "symbols");
+    data_path = test_get_path("");
+    assert(xkb_context_include_path_append(ctx, data_path));
+    free(data_path);
+
+    assert(utime(root.type_dir, &times) == 0);
+    write_symbols(root2.path, "a", now - 100);
+
+    /* Not in the first symbols directory, and no types directories. */
+    assert(compile_include(ctx, "test") == XKB_KEY_a);
+    assert(ctx->include_opens_avoided >= 3);
+
+    /* The directories are checked again for the next keymap. */
+    checks = ctx->include_dir_checks;
+    avoided = ctx->include_opens_avoided;
+    assert(compile_include(ctx, "test") == XKB_KEY_a);
+    assert(ctx->include_dir_checks > checks);
+    assert(ctx->include_opens_avoided >= avoided + 3);
+
+    /* Added to the directory, which is listed again. */
+    write_symbols(root.path, "b", now - 50);
+    times.actime = times.modtime = now - 50;
+    assert(utime(root.type_dir, &times) == 0);
+    assert(compile_include(ctx, "test") == XKB_KEY_b);
+
+    /* Removed again. */
+    unlink(root.path);
+    times.actime = times.modtime = now - 25;
+    assert(utime(root.type_dir, &times) == 0);
+    assert(compile_include(ctx, "test") == XKB_KEY_a);
+
+    /* Just modified, so the listing can't be trusted yet. */
+    write_symbols(root.path, "c", now - 10);
+    assert(compile_include(ctx, "test") == XKB_KEY_c);
+
+    xkb_context_unref(ctx);
+    teardown_include_root(&root);
+    teardown_include_root(&root2);
+}
+
+static void
+write_rules(const char *path, const char *symbols, time_t mtime)
+{
+    char *contents;
+
+    assert(asprintf(&contents,
+                    "! model = keycodes types compat symbols\n"
+                    "  *     = evdev    basic complete %s\n",
+                    symbols) >= 0);
+    write_file(path, contents, mtime);
+    free(contents);
+}
+
+static char *
+get_symbols(struct xkb_context *ctx, const char *rules)
+{
+    const struct xkb_rule_names rmlvo = { rules, "pc105", "", "", "" };
+    struct xkb_component_names kccgst;
+
+    assert(xkb_components_from_rules(ctx, &rmlvo, &kccgst));
+    free(kccgst.keycodes);
+    free(kccgst.types);
+    free(kccgst.compat);
+    return kccgst.symbols;
+}
+
+static void
+test_rules_cache(void)
+{
+    struct xkb_context *ctx = test_get_context(0);
+    struct include_root root;
+    char *symbols;
+    unsigned int misses;
+    time_t now = time(NULL);
+
+    assert(ctx);
+    setup_include_root(&root, ctx, "rules");
+
+    write_rules(root.path, "a", now - 100);
+    symbols = get_symbols(ctx, "test");
+    assert(streq(symbols, "a"));
+    free(symbols);
+    misses = ctx->rules_cache_misses;
+    symbols = get_symbols(ctx, "test");
+    assert(streq(symbols, "a"));
+    free(symbols);
+    assert(ctx->rules_cache_misses == misses && ctx->rules_cache_hits > 0);
+
+    /* Changed, with the same size. */
+    write_rules(root.path, "b", now - 50);
+    symbols = get_symbols(ctx, "test");
+    assert(streq(symbols, "b"));
+    free(symbols);
+    assert(ctx->rules_cache_misses == misses + 1);
+
+    /* Just modified, so it can't be trusted yet. */
+    write_rules(root.path, "c", 0);
+    symbols = get_symbols(ctx, "test");
+    assert(streq(symbols, "c"));
+    free(symbols);
+    symbols = get_symbols(ctx, "test");
+    assert(streq(symbols, "c"));
+    free(symbols);
+    assert(ctx->rules_cache_misses == misses + 3);
+
+    xkb_context_unref(ctx);
+    teardown_include_root(&root);
+}
 
 int
 main(void)
@@ -48,5 +368,11 @@ main(void)
 
     xkb_context_unref(context);
 
+    test_parsed_file_cache();
+    test_parsed_file_cache_invalidation();
+    test_map_index();
+    test_include_dir_cache();
+    test_rules_cache();
+
     return 0;
 }
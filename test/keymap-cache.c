@@ -0,0 +1,236 @@
+/*
+ * Copyright © 2026 libxkbcommon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <dirent.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <utime.h>
+
+#include "test.h"
+#include "evdev-scancodes.h"
+
+#pragma GCC diagnostic ignored "-Wmissing-format-attribute"
+
+static int hits, stores;
+
+ATTR_PRINTF(3, 0) static void
+log_fn(struct xkb_context *ctx, enum xkb_log_level level,
+       const char *fmt, va_list args)
+{
+    char buf[1024];
+
+    vsnprintf(buf, sizeof(buf), fmt, args);
+
+    if (strstr(buf, "Using cached keymap"))
+        hits++;
+    else if (strstr(buf, "Cached keymap in"))
+        stores++;
+}
+
+static char *
+path_join(const char *dir, const char *name)
+{
+    char *path;
+
+    assert(asprintf(&path, "%s/%s", dir, name) >= 0);
+    return path;
+}
+
+static xkb_keysym_t
+compile_and_get_sym(struct xkb_context *ctx)
+{
+    struct xkb_rule_names rmlvo = { "evdev", "pc104", "us", NULL, NULL };
+    struct xkb_keymap *keymap;
+    struct xkb_state *state;
+    xkb_keysym_t sym;
+
+    keymap = xkb_keymap_new_from_names(ctx, &rmlvo, 0);
+    assert(keymap);
+    state = xkb_state_new(keymap);
+    assert(state);
+
+    sym = xkb_state_key_get_one_sym(state, KEY_A + EVDEV_OFFSET);
+
+    xkb_state_unref(state);
+    xkb_keymap_unref(keymap);
+    return sym;
+}
+
+static char *
+compile_and_dump(struct xkb_context *ctx)
+{
+    struct xkb_rule_names rmlvo = { "evdev", "pc104", "us", NULL, NULL };
+    struct xkb_keymap *keymap;
+    char *dump;
+
+    keymap = xkb_keymap_new_from_names(ctx, &rmlvo, 0);
+    assert(keymap);
+    dump = xkb_keymap_get_as_string(keymap, XKB_KEYMAP_USE_ORIGINAL_FORMAT);
+    assert(dump);
+
+    xkb_keymap_unref(keymap);
+    return dump;
+}
+
+static void
+write_file(const char *path, const char *contents, time_t mtime)
+{
+    FILE *file = fopen(path, "w");
+    struct utimbuf times = { mtime, mtime };
+
+    assert(file);
+    fputs(contents, file);
+    assert(fclose(file) == 0);
+    if (mtime)
+        assert(utime(path, &times) == 0);
+}
+
+static void
+remove_dir(const char *path)
+{
+    DIR *dir = opendir(path);
+    struct dirent *ent;
+
+    assert(dir);
+    while ((ent = readdir(dir))) {
+        char *entry;
+
+        if (streq(ent->d_name, ".") || streq(ent->d_name, ".."))
+            continue;
+
+        entry = path_join(path, ent->d_name);
+        if (unlink(entry) != 0)
+            remove_dir(entry);
+        free(entry);
+    }
+    closedir(dir);
+    assert(rmdir(path) == 0);
+}
+
+int
+main(void)
+{
+    char tmpl[] = "/tmp/xkbcommon-keymap-cache-XXXXXX";
+    char *tmp, *cache_dir, *overlay, *symbols_dir, *us, *data;
+    char *compiled, *cached;
+    struct xkb_context *ctx;
+    time_t past = time(NULL) - 60;
+    int prev_hits, prev_stores;
+
+    tmp = mkdtemp(tmpl);
+    assert(tmp);
+
+    cache_dir = path_join(tmp, "cache");
+    overlay = path_join(tmp, "overlay");
+    symbols_dir = path_join(overlay, "symbols");
+    us = path_join(symbols_dir, "us");
+    assert(mkdir(cache_dir, 0700) == 0);
+    assert(mkdir(overlay, 0700) == 0);
+    assert(mkdir(symbols_dir, 0700) == 0);
+
+    ctx = xkb_context_new(XKB_CONTEXT_NO_DEFAULT_INCLUDES |
+                          XKB_CONTEXT_NO_ENVIRONMENT_NAMES);
+    assert(ctx);
+    xkb_context_set_log_fn(ctx, log_fn);
+    xkb_context_set_log_level(ctx, XKB_LOG_LEVEL_DEBUG);
+
+    /* Files in the overlay take precedence over the test data. */
+    data = test_get_path("");
+    assert(xkb_context_include_path_append(ctx, overlay));
+    assert(xkb_context_include_path_append(ctx, data));
+
+    assert(!xkb_context_set_keymap_cache_dir(ctx, us));
+    assert(xkb_context_set_keymap_cache_dir(ctx, cache_dir));
+
+    /* Cold: compiled and stored. */
+    assert(compile_and_get_sym(ctx) == XKB_KEY_a);
+    assert(hits == 0 && stores == 1);
+
+    /* Warm. */
+    assert(compile_and_get_sym(ctx) == XKB_KEY_a);
+    assert(hits == 1 && stores == 1);
+
+    /*
+     * A file appears earlier in the include paths.  It was just written,
+     * so the keymap isn't stored, as a later change could go unnoticed.
+     */
+    write_file(us, "default xkb_symbols \"basic\" {\n"
+                   "    key <AC01> { [ b, B ] };\n"
+                   "};\n", 0);
+    assert(compile_and_get_sym(ctx) == XKB_KEY_b);
+    assert(hits == 1 && stores == 1);
+
+    write_file(us, "default xkb_symbols \"basic\" {\n"
+                   "    key <AC01> { [ c, C ] };\n"
+                   "};\n", past);
+    assert(compile_and_get_sym(ctx) == XKB_KEY_c);
+    assert(hits == 1 && stores == 2);
+    assert(compile_and_get_sym(ctx) == XKB_KEY_c);
+    assert(hits == 2 && stores == 2);
+
+    /* The file changes. */
+    write_file(us, "default xkb_symbols \"basic\" {\n"
+                   "    key <AC01> { [ d, D ] };\n"
+                   "};\n", past + 1);
+    assert(compile_and_get_sym(ctx) == XKB_KEY_d);
+    assert(hits == 2 && stores == 3);
+
+    /* The file goes away. */
+    assert(unlink(us) == 0);
+    prev_hits = hits;
+    prev_stores = stores;
+    assert(compile_and_get_sym(ctx) == XKB_KEY_a);
+    assert(hits == prev_hits && stores == prev_stores + 1);
+    assert(compile_and_get_sym(ctx) == XKB_KEY_a);
+    assert(hits == prev_hits + 1);
+
+    /* Disabled. */
+    assert(xkb_context_set_keymap_cache_dir(ctx, NULL));
+    assert(compile_and_get_sym(ctx) == XKB_KEY_a);
+    assert(hits == prev_hits + 1);
+
+    /* A cached keymap is dumped like the one it was compiled from. */
+    compiled = compile_and_dump(ctx);
+    assert(xkb_context_set_keymap_cache_dir(ctx, cache_dir));
+    cached = compile_and_dump(ctx);
+    assert(hits == prev_hits + 2);
+    assert(streq(cached, compiled));
+
+    xkb_context_unref(ctx);
+    remove_dir(tmp);
+    free(cache_dir);
+    free(overlay);
+    free(symbols_dir);
+    free(us);
+    free(data);
+    free(compiled);
+    free(cached);
+
+    return 0;
+}
@@ -36,6 +36,7 @@ main(void)
     struct xkb_keymap *keymap;
     xkb_keycode_t kc;
     const char *keyname;
+    const xkb_keysym_t *syms;
 
     assert(context);
 
@@ -58,5 +59,21 @@ main(void)
     assert(streq(keyname, "COMP"));
 
     xkb_keymap_unref(keymap);
+
+    /* Several keysyms in a level. */
+    keymap = test_compile_string(context,
+        "xkb_keymap {\n"
+        "  xkb_keycodes { <A> = 38; };\n"
+        "  xkb_types { include \"basic\" };\n"
+        "  xkb_compat { };\n"
+        "  xkb_symbols { key <A> { [ {a, b}, {c, d, e} ] }; };\n"
+        "};\n");
+    assert(keymap);
+    assert(xkb_keymap_key_get_syms_by_level(keymap, 38, 0, 0, &syms) == 2);
+    assert(syms[0] == XKB_KEY_a && syms[1] == XKB_KEY_b);
+    assert(xkb_keymap_key_get_syms_by_level(keymap, 38, 0, 1, &syms) == 3);
+    assert(syms[0] == XKB_KEY_c && syms[2] == XKB_KEY_e);
+    xkb_keymap_unref(keymap);
+
     xkb_context_unref(context);
 }
@@ -21,9 +21,15 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
+#ifdef HAVE_PTHREADS
+#include <pthread.h>
+#endif
+
 #include "evdev-scancodes.h"
 #include "test.h"
 
+#pragma GCC diagnostic ignored "-Wmissing-format-attribute"
+
 static int
 test_rmlvo_va(struct xkb_context *context, const char *rules,
               const char *model, const char *layout,
@@ -105,6 +111,241 @@ test_rmlvo_env(struct xkb_context *ctx, const char *rules, const char *model,
     return ret;
 }
 
+static void
+test_shared_keymaps(void)
+{
+    struct xkb_context *ctx = test_get_context(CONTEXT_SHARE_KEYMAPS);
+    struct xkb_rule_names us = { .rules = "evdev", .layout = "us" };
+    struct xkb_rule_names us_full = {
+        .rules = "evdev", .model = "pc105", .layout = "us",
+    };
+    struct xkb_rule_names de = { .rules = "evdev", .layout = "de" };
+    struct xkb_keymap *keymap, *again, *other;
+    char *path;
+
+    assert(ctx);
+
+    keymap = xkb_keymap_new_from_names(ctx, &us, 0);
+    assert(keymap);
+
+    /* Same names once the defaults are applied. */
+    again = xkb_keymap_new_from_names(ctx, &us_full, 0);
+    assert(again == keymap);
+    xkb_keymap_unref(again);
+
+    /* Other names or flags. */
+    other = xkb_keymap_new_from_names(ctx, &de, 0);
+    assert(other && other != keymap);
+    xkb_keymap_unref(other);
+    other = xkb_keymap_new_from_names(ctx, &us,
+                                      XKB_KEYMAP_COMPILE_CACHE_TEXT);
+    assert(other && other != keymap);
+    xkb_keymap_unref(other);
+
+    /* Still shared after another reference is dropped. */
+    again = xkb_keymap_new_from_names(ctx, &us, 0);
+    assert(again == keymap);
+    xkb_keymap_unref(again);
+
+    /* Not after the include paths changed. */
+    path = test_get_path("");
+    assert(xkb_context_include_path_append(ctx, path));
+    free(path);
+    other = xkb_keymap_new_from_names(ctx, &us, 0);
+    assert(other && other != keymap);
+    xkb_keymap_unref(keymap);
+    again = xkb_keymap_new_from_names(ctx, &us, 0);
+    assert(again == other);
+    xkb_keymap_unref(again);
+
+    /* Not after the keymap was modified. */
+    assert(xkb_keymap_key_set_repeats(other, KEY_A + EVDEV_OFFSET, 0));
+    again = xkb_keymap_new_from_names(ctx, &us, 0);
+    assert(again && again != other);
+    assert(xkb_keymap_key_repeats(again, KEY_A + EVDEV_OFFSET));
+    assert(!xkb_keymap_key_repeats(other, KEY_A + EVDEV_OFFSET));
+    xkb_keymap_unref(again);
+    xkb_keymap_unref(other);
+
+    xkb_context_unref(ctx);
+
+    /* Not without the flag. */
+    ctx = test_get_context(0);
+    assert(ctx);
+    keymap = xkb_keymap_new_from_names(ctx, &us, 0);
+    again = xkb_keymap_new_from_names(ctx, &us, 0);
+    assert(keymap && again && again != keymap);
+    xkb_keymap_unref(keymap);
+    xkb_keymap_unref(again);
+    xkb_context_unref(ctx);
+}
+
+struct captured_log {
+    char text[8192];
+};
+
+ATTR_PRINTF(3, 0) static void
+capture_log_fn(struct xkb_context *ctx, enum xkb_log_level level,
+               const char *fmt, va_list args)
+{
+    struct captured_log *log = xkb_context_get_user_data(ctx);
+    size_t len = strlen(log->text);
+
+    vsnprintf(log->text + len, sizeof(log->text) - len, fmt, args);
+}
+
+static struct xkb_keymap *
+compile_logged(const struct xkb_rule_names *rmlvo,
+               enum xkb_keymap_compile_flags flags, struct captured_log *log)
+{
+    struct xkb_context *ctx = test_get_context(0);
+    struct xkb_keymap *keymap;
+
+    assert(ctx);
+    log->text[0] = '\0';
+    xkb_context_set_user_data(ctx, log);
+    xkb_context_set_log_fn(ctx, capture_log_fn);
+    xkb_context_set_log_level(ctx, XKB_LOG_LEVEL_WARNING);
+    xkb_context_set_log_verbosity(ctx, 10);
+
+    keymap = xkb_keymap_new_from_names(ctx, rmlvo, flags);
+    xkb_context_unref(ctx);
+    return keymap;
+}
+
+/* The same keymap and log messages as without the flag, in a new context. */
+static void
+test_parallel(const char *rules, const char *model, const char *layout,
+              const char *variant, const char *options)
+{
+    const struct xkb_rule_names rmlvo = {
+        rules, model, layout, variant, options,
+    };
+    static struct captured_log serial_log, parallel_log;
+    struct xkb_keymap *serial, *parallel;
+    char *serial_dump, *parallel_dump;
+    size_t serial_len, parallel_len;
+
+    serial = compile_logged(&rmlvo, 0, &serial_log);
+    parallel = compile_logged(&rmlvo, XKB_KEYMAP_COMPILE_PARALLEL,
+                              &parallel_log);
+    assert(streq(serial_log.text, parallel_log.text));
+
+    if (!serial) {
+        assert(!parallel);
+        return;
+    }
+    assert(parallel);
+
+    serial_dump = xkb_keymap_get_as_string(serial, XKB_KEYMAP_FORMAT_TEXT_V1);
+    parallel_dump = xkb_keymap_get_as_string(parallel,
+                                             XKB_KEYMAP_FORMAT_TEXT_V1);
+    assert(serial_dump && parallel_dump);
+    assert(streq(serial_dump, parallel_dump));
+    free(serial_dump);
+    free(parallel_dump);
+
+    serial_dump = xkb_keymap_get_as_buffer(serial, XKB_KEYMAP_FORMAT_BINARY_V1,
+                                           &serial_len);
+    parallel_dump = xkb_keymap_get_as_buffer(parallel,
+                                             XKB_KEYMAP_FORMAT_BINARY_V1,
+                                             &parallel_len);
+    assert(serial_dump && parallel_dump);
+    assert(serial_len == parallel_len &&
+           memcmp(serial_dump, parallel_dump, serial_len) == 0);
+    free(serial_dump);
+    free(parallel_dump);
+
+    xkb_keymap_unref(serial);
+    xkb_keymap_unref(parallel);
+}
+
+#ifdef HAVE_PTHREADS
+#define THREAD_SAFE_ITERATIONS 4
+
+struct thread_safe_job {
+    struct xkb_context *ctx;
+    struct xkb_rule_names rmlvo;
+    enum xkb_keymap_compile_flags flags;
+    /* The dump of the keymap compiled in a context of its own. */
+    char *expected;
+};
+
+static void *
+compile_concurrently(void *data)
+{
+    struct thread_safe_job *job = data;
+
+    for (int i = 0; i < THREAD_SAFE_ITERATIONS; i++) {
+        struct xkb_keymap *keymap;
+        struct xkb_state *state;
+        char *dump;
+
+        keymap = xkb_keymap_new_from_names(job->ctx, &job->rmlvo, job->flags);
+        assert(keymap);
+        dump = xkb_keymap_get_as_string(keymap, XKB_KEYMAP_FORMAT_TEXT_V1);
+        assert(dump && streq(dump, job->expected));
+        free(dump);
+
+        state = xkb_state_new(keymap);
+        assert(state);
+        xkb_keymap_unref(keymap);
+        xkb_state_unref(state);
+    }
+
+    return NULL;
+}
+
+/*
+ * Threads compiling keymaps against one context get the same keymaps as
+ * they would alone, including when some are shared.
+ */
+static void
+test_thread_safe(void)
+{
+    struct thread_safe_job jobs[] = {
+        { .rmlvo = { "evdev", "pc105", "us", NULL, NULL } },
+        { .rmlvo = { "evdev", "pc105", "de", "neo", NULL } },
+        { .rmlvo = { "evdev", "pc105", "ru,ca", ",multix", "grp:alts_toggle" },
+          .flags = XKB_KEYMAP_COMPILE_PARALLEL },
+        { .rmlvo = { "evdev", "pc105", "us", NULL, NULL } },
+        { .rmlvo = { "evdev", "pc105", "il,us", NULL, "ctrl:nocaps" } },
+    };
+    pthread_t threads[ARRAY_SIZE(jobs)];
+    struct xkb_context *ctx;
+
+    for (unsigned i = 0; i < ARRAY_SIZE(jobs); i++) {
+        struct xkb_keymap *keymap;
+
+        ctx = test_get_context(0);
+        assert(ctx);
+        keymap = xkb_keymap_new_from_names(ctx, &jobs[i].rmlvo, 0);
+        assert(keymap);
+        jobs[i].expected = xkb_keymap_get_as_string(keymap,
+                                                    XKB_KEYMAP_FORMAT_TEXT_V1);
+        assert(jobs[i].expected);
+        xkb_keymap_unref(keymap);
+        xkb_context_unref(ctx);
+    }
+
+    ctx = test_get_context(CONTEXT_THREAD_SAFE | CONTEXT_SHARE_KEYMAPS);
+    assert(ctx);
+
+    for (unsigned i = 0; i < ARRAY_SIZE(jobs); i++) {
+        jobs[i].ctx = xkb_context_ref(ctx);
+        assert(pthread_create(&threads[i], NULL, compile_concurrently,
+                              &jobs[i]) == 0);
+    }
+    xkb_context_unref(ctx);
+
+    for (unsigned i = 0; i < ARRAY_SIZE(jobs); i++) {
+        assert(pthread_join(threads[i], NULL) == 0);
+        xkb_context_unref(jobs[i].ctx);
+        free(jobs[i].expected);
+    }
+}
+#endif
+
 int
 main(int argc, char *argv[])
 {
@@ -199,5 +440,19 @@ main(int argc, char *argv[])
     }
 
     xkb_context_unref(ctx);
+
+    test_shared_keymaps();
+
+    test_parallel("evdev", "pc105", "us,il,ru,ca", ",,,multix",
+                  "grp:alts_toggle,ctrl:nocaps,compose:rwin");
+    test_parallel("evdev", "pc105", "ru,ca,de,us", ",multix,neo,intl", "");
+    /* Logs while parsing. */
+    test_parallel("evdev", "", "cz", "bksl", "");
+    test_parallel("evdev", "", "us", "does-not-exist", "");
+
+#ifdef HAVE_PTHREADS
+    test_thread_safe();
+#endif
+
     return 0;
 }
@@ -26,6 +26,7 @@
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "evdev-scancodes.h"
 #include "test.h"
@@ -375,6 +376,66 @@ test_repeat(struct xkb_keymap *keymap)
     assert(xkb_keymap_key_repeats(keymap, KEY_KBDILLUMDOWN + 8));
 }
 
+static void
+test_state_repeat(struct xkb_keymap *keymap)
+{
+    struct xkb_state *state = xkb_state_new(keymap);
+    struct xkb_state *other = xkb_state_new(keymap);
+    struct xkb_state *clone;
+    uint32_t *bitmap;
+    size_t num_words;
+
+    assert(state && other);
+
+    /* By default, follow the keymap. */
+    assert(!xkb_state_key_repeats(state, KEY_LEFTSHIFT + 8));
+    assert(xkb_state_key_repeats(state, KEY_A + 8));
+    assert(!xkb_state_key_repeats(state, XKB_KEYCODE_INVALID));
+
+    assert(xkb_state_key_set_repeats(state, KEY_A + 8, 0) == 1);
+    assert(xkb_state_key_set_repeats(state, KEY_LEFTSHIFT + 8, 1) == 1);
+    assert(xkb_state_key_set_repeats(state, XKB_KEYCODE_INVALID, 1) == 0);
+    assert(!xkb_state_key_repeats(state, KEY_A + 8));
+    assert(xkb_state_key_repeats(state, KEY_LEFTSHIFT + 8));
+    assert(xkb_state_key_repeats(state, KEY_8 + 8));
+
+    /* The keymap and the other states are not affected. */
+    assert(xkb_keymap_key_repeats(keymap, KEY_A + 8));
+    assert(xkb_state_key_repeats(other, KEY_A + 8));
+    assert(!xkb_state_key_repeats(other, KEY_LEFTSHIFT + 8));
+
+    clone = xkb_state_clone(state);
+    assert(clone);
+    assert(!xkb_state_key_repeats(clone, KEY_A + 8));
+    assert(xkb_state_key_set_repeats(clone, KEY_A + 8, 1) == 1);
+    assert(!xkb_state_key_repeats(state, KEY_A + 8));
+    xkb_state_unref(clone);
+
+    /* Bulk export and import. */
+    num_words = xkb_state_get_repeats(state, NULL, 0);
+    assert(num_words == (xkb_keymap_max_keycode(keymap) / 32 + 1));
+    bitmap = calloc(num_words, sizeof(*bitmap));
+    assert(bitmap);
+    assert(xkb_state_get_repeats(state, bitmap, num_words) == num_words);
+    assert(!(bitmap[(KEY_A + 8) / 32] & (1u << ((KEY_A + 8) % 32))));
+    assert(bitmap[(KEY_8 + 8) / 32] & (1u << ((KEY_8 + 8) % 32)));
+
+    assert(xkb_state_set_repeats(other, bitmap, num_words) == 1);
+    for (xkb_keycode_t kc = xkb_keymap_min_keycode(keymap);
+         kc <= xkb_keymap_max_keycode(keymap); kc++)
+        assert(xkb_state_key_repeats(other, kc) ==
+               xkb_state_key_repeats(state, kc));
+
+    /* And back to the keymap. */
+    assert(xkb_state_set_repeats(state, NULL, 0) == 1);
+    assert(xkb_state_key_repeats(state, KEY_A + 8));
+    assert(!xkb_state_key_repeats(state, KEY_LEFTSHIFT + 8));
+
+    free(bitmap);
+    xkb_state_unref(other);
+    xkb_state_unref(state);
+}
+
 static void
 test_consume(struct xkb_keymap *keymap)
 {
@@ -519,6 +580,137 @@ test_range(struct xkb_keymap *keymap)
     assert(counter == xkb_keymap_max_keycode(keymap) + 1);
 }
 
+static void
+test_queries(struct xkb_context *context, struct xkb_keymap *keymap)
+{
+    struct xkb_state *state = xkb_state_new(keymap);
+    struct xkb_state *other_state;
+    struct xkb_keymap *other_keymap;
+    struct xkb_state_query *ctrl_alt, *ctrl_alt_any, *shift_only;
+    struct xkb_state_query *russian, *caps_led, *invalid;
+    const char *ctrl_alt_names[] = { XKB_MOD_NAME_CTRL, XKB_MOD_NAME_ALT };
+    const char *shift_names[] = { XKB_MOD_NAME_SHIFT };
+    const char *layout_names[] = { "Russian" };
+    const char *led_names[] = { XKB_LED_NAME_CAPS };
+    const char *invalid_names[] = { XKB_MOD_NAME_SHIFT, "Hyperactive" };
+
+    assert(state);
+
+    ctrl_alt = xkb_state_query_new_mods(keymap, XKB_STATE_MODS_EFFECTIVE,
+                                        XKB_STATE_MATCH_ALL,
+                                        ctrl_alt_names, 2);
+    ctrl_alt_any = xkb_state_query_new_mods(keymap, XKB_STATE_MODS_DEPRESSED,
+                                            XKB_STATE_MATCH_ANY |
+                                            XKB_STATE_MATCH_NON_EXCLUSIVE,
+                                            ctrl_alt_names, 2);
+    shift_only = xkb_state_query_new_mods(keymap, XKB_STATE_MODS_EFFECTIVE,
+                                          XKB_STATE_MATCH_ALL,
+                                          shift_names, 1);
+    russian = xkb_state_query_new_layouts(keymap, XKB_STATE_LAYOUT_EFFECTIVE,
+                                          XKB_STATE_MATCH_ANY,
+                                          layout_names, 1);
+    caps_led = xkb_state_query_new_leds(keymap, XKB_STATE_MATCH_ANY |
+                                        XKB_STATE_MATCH_NON_EXCLUSIVE,
+                                        led_names, 1);
+    assert(ctrl_alt && ctrl_alt_any && shift_only && russian && caps_led);
+
+    invalid = xkb_state_query_new_mods(keymap, XKB_STATE_MODS_EFFECTIVE,
+                                       XKB_STATE_MATCH_ALL, invalid_names, 2);
+    assert(!invalid);
+
+    assert(xkb_state_query_is_active(state, ctrl_alt) == 0);
+    assert(xkb_state_query_is_active(state, ctrl_alt_any) == 0);
+    assert(xkb_state_query_is_active(state, russian) == 0);
+
+    xkb_state_update_key(state, KEY_LEFTCTRL + EVDEV_OFFSET, XKB_KEY_DOWN);
+    assert(xkb_state_query_is_active(state, ctrl_alt) == 0);
+    assert(xkb_state_query_is_active(state, ctrl_alt_any) == 1);
+
+    xkb_state_update_key(state, KEY_LEFTALT + EVDEV_OFFSET, XKB_KEY_DOWN);
+    assert(xkb_state_query_is_active(state, ctrl_alt) == 1);
+    assert(xkb_state_query_is_active(state, ctrl_alt) ==
+           xkb_state_mod_names_are_active(state, XKB_STATE_MODS_EFFECTIVE,
+                                          XKB_STATE_MATCH_ALL,
+                                          XKB_MOD_NAME_CTRL,
+                                          XKB_MOD_NAME_ALT, NULL));
+
+    /* Exclusive matching. */
+    xkb_state_update_key(state, KEY_LEFTSHIFT + EVDEV_OFFSET, XKB_KEY_DOWN);
+    assert(xkb_state_query_is_active(state, ctrl_alt) == 0);
+    assert(xkb_state_query_is_active(state, shift_only) == 0);
+    xkb_state_update_key(state, KEY_LEFTCTRL + EVDEV_OFFSET, XKB_KEY_UP);
+    xkb_state_update_key(state, KEY_LEFTALT + EVDEV_OFFSET, XKB_KEY_UP);
+    assert(xkb_state_query_is_active(state, shift_only) == 1);
+    xkb_state_update_key(state, KEY_LEFTSHIFT + EVDEV_OFFSET, XKB_KEY_UP);
+
+    xkb_state_update_key(state, KEY_COMPOSE + EVDEV_OFFSET, XKB_KEY_DOWN);
+    xkb_state_update_key(state, KEY_COMPOSE + EVDEV_OFFSET, XKB_KEY_UP);
+    assert(xkb_state_query_is_active(state, russian) == 1);
+    assert(xkb_state_layout_name_is_active(state, "Russian",
+                                           XKB_STATE_LAYOUT_EFFECTIVE) == 1);
+
+    xkb_state_update_key(state, KEY_CAPSLOCK + EVDEV_OFFSET, XKB_KEY_DOWN);
+    xkb_state_update_key(state, KEY_CAPSLOCK + EVDEV_OFFSET, XKB_KEY_UP);
+    assert(xkb_state_query_is_active(state, caps_led) == 1);
+    assert(xkb_state_led_name_is_active(state, XKB_LED_NAME_CAPS) == 1);
+
+    /* A query only applies to its keymap. */
+    other_keymap = test_compile_rules(context, "evdev", "pc104", "us,ru",
+                                      NULL, NULL);
+    assert(other_keymap);
+    other_state = xkb_state_new(other_keymap);
+    assert(other_state);
+    assert(xkb_state_query_is_active(other_state, ctrl_alt) == -1);
+    xkb_state_unref(other_state);
+    xkb_keymap_unref(other_keymap);
+
+    xkb_state_query_unref(xkb_state_query_ref(ctrl_alt));
+    xkb_state_query_unref(ctrl_alt);
+    xkb_state_query_unref(ctrl_alt_any);
+    xkb_state_query_unref(shift_only);
+    xkb_state_query_unref(russian);
+    xkb_state_query_unref(caps_led);
+    xkb_state_query_unref(NULL);
+    xkb_state_unref(state);
+}
+
+/* Keys with fewer layouts than the keymap wrap the group into range. */
+static void
+test_layout_wrap(struct xkb_keymap *keymap)
+{
+    struct xkb_state *state = xkb_state_new(keymap);
+    struct xkb_state_components components = { 0 };
+
+    assert(state);
+    assert(xkb_keymap_num_layouts(keymap) == 2);
+
+    xkb_state_update_mask(state, 0, 0, 0, 0, 0, 1);
+    components.layout = 5;
+
+    for (xkb_keycode_t kc = xkb_keymap_min_keycode(keymap);
+         kc <= xkb_keymap_max_keycode(keymap); kc++) {
+        xkb_layout_index_t num_layouts =
+            xkb_keymap_num_layouts_for_key(keymap, kc);
+        xkb_layout_index_t layout = xkb_state_key_get_layout(state, kc);
+        xkb_layout_index_t snapshot_layout =
+            xkb_state_components_key_get_layout(keymap, &components, kc);
+
+        if (num_layouts == 0) {
+            assert(layout == XKB_LAYOUT_INVALID);
+            assert(snapshot_layout == XKB_LAYOUT_INVALID);
+        }
+        else {
+            assert(layout == 1 % num_layouts);
+            assert(snapshot_layout == 5 % num_layouts);
+        }
+    }
+
+    assert(xkb_state_key_get_layout(state, KEY_A + EVDEV_OFFSET) == 1);
+    assert(xkb_state_key_get_layout(state, KEY_ESC + EVDEV_OFFSET) == 0);
+
+    xkb_state_unref(state);
+}
+
 static void
 test_caps_keysym_transformation(struct xkb_keymap *keymap)
 {
@@ -707,11 +899,379 @@ test_ctrl_string_transformation(struct xkb_keymap *keymap)
     xkb_state_unref(state);
 }
 
+static void
+test_update_keys(struct xkb_keymap *keymap)
+{
+    struct xkb_state *state = xkb_state_new(keymap);
+    struct xkb_state *batch_state = xkb_state_new(keymap);
+    struct xkb_key_event events[] = {
+        { KEY_A + EVDEV_OFFSET, XKB_KEY_DOWN },
+        { KEY_A + EVDEV_OFFSET, XKB_KEY_UP },
+        { KEY_LEFTSHIFT + EVDEV_OFFSET, XKB_KEY_DOWN },
+        { KEY_A + EVDEV_OFFSET, XKB_KEY_DOWN },
+        { KEY_A + EVDEV_OFFSET, XKB_KEY_UP },
+        { KEY_CAPSLOCK + EVDEV_OFFSET, XKB_KEY_DOWN },
+        { KEY_CAPSLOCK + EVDEV_OFFSET, XKB_KEY_UP },
+        { KEY_LEFTSHIFT + EVDEV_OFFSET, XKB_KEY_UP },
+        { KEY_COMPOSE + EVDEV_OFFSET, XKB_KEY_DOWN },
+        { KEY_COMPOSE + EVDEV_OFFSET, XKB_KEY_UP },
+        { 300, XKB_KEY_DOWN },
+        { KEY_A + EVDEV_OFFSET, XKB_KEY_DOWN },
+        { KEY_A + EVDEV_OFFSET, XKB_KEY_UP },
+    };
+    enum xkb_state_component changed = 0, batch_changed;
+
+    assert(state && batch_state);
+
+    for (unsigned i = 0; i < ARRAY_SIZE(events); i++) {
+        xkb_keycode_t kc = events[i].keycode;
+        xkb_keysym_t sym = xkb_state_key_get_one_sym(state, kc);
+        uint32_t cp = xkb_state_key_get_utf32(state, kc);
+
+        changed |= xkb_state_update_key(state, kc, events[i].direction);
+        events[i].keysym = sym + 1;
+        events[i].utf32 = cp + 1;
+    }
+
+    batch_changed = xkb_state_update_keys(batch_state, events,
+                                          ARRAY_SIZE(events));
+    assert(batch_changed == changed);
+    assert(batch_changed & XKB_STATE_LEDS);
+    assert(xkb_state_serialize_mods(state, XKB_STATE_MODS_EFFECTIVE) ==
+           xkb_state_serialize_mods(batch_state, XKB_STATE_MODS_EFFECTIVE));
+    assert(xkb_state_serialize_layout(state, XKB_STATE_LAYOUT_EFFECTIVE) ==
+           xkb_state_serialize_layout(batch_state, XKB_STATE_LAYOUT_EFFECTIVE));
+    assert(xkb_state_led_name_is_active(batch_state, XKB_LED_NAME_CAPS) > 0);
+
+    assert(events[0].keysym == XKB_KEY_a && events[0].utf32 == 'a');
+    assert(events[3].keysym == XKB_KEY_A && events[3].utf32 == 'A');
+    assert(events[10].keysym == XKB_KEY_NoSymbol && events[10].utf32 == 0);
+    assert(events[11].keysym == XKB_KEY_Cyrillic_EF &&
+           events[11].utf32 == 0x0424);
+
+    /* The Caps Lock LED is toggled on and off within the batch. */
+    events[0] = events[5];
+    events[1] = events[6];
+    events[2] = events[5];
+    events[3] = events[6];
+    batch_changed = xkb_state_update_keys(batch_state, events, 4);
+    assert(batch_changed & XKB_STATE_MODS_LOCKED);
+    assert(!(batch_changed & XKB_STATE_LEDS));
+    assert(xkb_state_update_keys(batch_state, events, 0) == 0);
+
+    xkb_state_unref(batch_state);
+    xkb_state_unref(state);
+}
+
+static void
+test_update_mask_repeated(struct xkb_keymap *keymap)
+{
+    struct xkb_state *state = xkb_state_new(keymap);
+    struct xkb_state_components components;
+    xkb_mod_index_t caps, shift;
+    enum xkb_state_component changed;
+
+    assert(state);
+
+    caps = xkb_keymap_mod_get_index(keymap, XKB_MOD_NAME_CAPS);
+    shift = xkb_keymap_mod_get_index(keymap, XKB_MOD_NAME_SHIFT);
+
+    changed = xkb_state_update_mask(state, 1 << shift, 0, 1 << caps, 0, 0, 1);
+    assert(changed & XKB_STATE_LEDS);
+    changed = xkb_state_update_mask(state, 1 << shift, 0, 1 << caps, 0, 0, 1);
+    assert(changed == 0);
+
+    xkb_state_serialize_components(state, &components);
+    assert(components.depressed_mods == (1u << shift));
+    assert(components.latched_mods == 0);
+    assert(components.locked_mods == (1u << caps));
+    assert(components.mods == ((1u << shift) | (1u << caps)));
+    assert(components.depressed_layout == 0);
+    assert(components.latched_layout == 0);
+    assert(components.locked_layout == 1);
+    assert(components.layout == 1);
+    for (xkb_led_index_t led = 0; led < xkb_keymap_num_leds(keymap); led++)
+        assert(!!(components.leds & (1u << led)) ==
+               xkb_state_led_index_is_active(state, led));
+    assert(components.leds &
+           (1u << xkb_keymap_led_get_index(keymap, XKB_LED_NAME_CAPS)));
+
+    /* A key event in between must not make the same mask a no-op. */
+    xkb_state_update_key(state, KEY_LEFTSHIFT + EVDEV_OFFSET, XKB_KEY_DOWN);
+    xkb_state_update_key(state, KEY_LEFTSHIFT + EVDEV_OFFSET, XKB_KEY_UP);
+    assert(xkb_state_serialize_mods(state, XKB_STATE_MODS_DEPRESSED) == 0);
+    changed = xkb_state_update_mask(state, 1 << shift, 0, 1 << caps, 0, 0, 1);
+    assert(changed == (XKB_STATE_MODS_DEPRESSED | XKB_STATE_MODS_EFFECTIVE));
+
+    xkb_state_unref(state);
+}
+
+static void
+test_clone_and_snapshot(struct xkb_keymap *keymap)
+{
+    struct xkb_state *state = xkb_state_new(keymap);
+    struct xkb_state *clone;
+    struct xkb_state_components components;
+    xkb_mod_index_t shift = xkb_keymap_mod_get_index(keymap, XKB_MOD_NAME_SHIFT);
+
+    assert(state);
+
+    xkb_state_update_key(state, KEY_COMPOSE + EVDEV_OFFSET, XKB_KEY_DOWN);
+    xkb_state_update_key(state, KEY_COMPOSE + EVDEV_OFFSET, XKB_KEY_UP);
+    xkb_state_update_key(state, KEY_LEFTSHIFT + EVDEV_OFFSET, XKB_KEY_DOWN);
+
+    clone = xkb_state_clone(state);
+    assert(clone);
+    assert(xkb_state_get_keymap(clone) == keymap);
+
+    /* The held down Shift is carried over, but independently. */
+    xkb_state_update_key(state, KEY_LEFTSHIFT + EVDEV_OFFSET, XKB_KEY_UP);
+    assert(xkb_state_mod_index_is_active(state, shift,
+                                         XKB_STATE_MODS_EFFECTIVE) == 0);
+    assert(xkb_state_mod_index_is_active(clone, shift,
+                                         XKB_STATE_MODS_EFFECTIVE) > 0);
+    assert(xkb_state_key_get_layout(clone, KEY_A + EVDEV_OFFSET) == 1);
+
+    xkb_state_serialize_components(clone, &components);
+    xkb_state_update_key(clone, KEY_LEFTSHIFT + EVDEV_OFFSET, XKB_KEY_UP);
+    assert(xkb_state_mod_index_is_active(clone, shift,
+                                         XKB_STATE_MODS_EFFECTIVE) == 0);
+    xkb_state_unref(clone);
+
+    /* The snapshot answers as the state it was taken from. */
+    xkb_state_update_key(state, KEY_LEFTSHIFT + EVDEV_OFFSET, XKB_KEY_DOWN);
+    for (xkb_keycode_t kc = xkb_keymap_min_keycode(keymap);
+         kc <= xkb_keymap_max_keycode(keymap) + 1; kc++) {
+        const xkb_keysym_t *syms, *state_syms;
+        xkb_layout_index_t layout;
+        int nsyms;
+
+        layout = xkb_state_components_key_get_layout(keymap, &components, kc);
+        assert(layout == xkb_state_key_get_layout(state, kc));
+        if (layout != XKB_LAYOUT_INVALID)
+            assert(xkb_state_components_key_get_level(keymap, &components,
+                                                      kc, layout) ==
+                   xkb_state_key_get_level(state, kc, layout));
+
+        nsyms = xkb_state_components_key_get_syms(keymap, &components,
+                                                  kc, &syms);
+        assert(nsyms == xkb_state_key_get_syms(state, kc, &state_syms));
+        assert(syms == state_syms);
+
+        assert(xkb_state_components_key_get_consumed_mods(
+                   keymap, &components, kc, XKB_CONSUMED_MODE_XKB) ==
+               xkb_state_key_get_consumed_mods2(state, kc,
+                                                XKB_CONSUMED_MODE_XKB));
+        assert(xkb_state_components_key_get_consumed_mods(
+                   keymap, &components, kc, XKB_CONSUMED_MODE_GTK) ==
+               xkb_state_key_get_consumed_mods2(state, kc,
+                                                XKB_CONSUMED_MODE_GTK));
+    }
+
+    xkb_state_unref(state);
+}
+
+/*
+ * The LEDs are only updated when the components they depend on change;
+ * check they always match a from-scratch computation.
+ */
+static void
+test_led_updates(struct xkb_keymap *keymap)
+{
+    struct xkb_state *state = xkb_state_new(keymap);
+    const xkb_keycode_t keys[] = {
+        KEY_CAPSLOCK, KEY_NUMLOCK, KEY_SCROLLLOCK, KEY_COMPOSE,
+        KEY_LEFTSHIFT, KEY_A,
+    };
+
+    assert(state);
+
+    srand(1);
+    for (int i = 0; i < 1000; i++) {
+        struct xkb_state *fresh = xkb_state_new(keymap);
+        xkb_keycode_t kc = keys[rand() % ARRAY_SIZE(keys)] + EVDEV_OFFSET;
+
+        assert(fresh);
+
+        if (i % 3 == 0) {
+            xkb_state_update_mask(state, rand() & 0xff, 0, rand() & 0xff,
+                                  0, 0, rand() % 4);
+        }
+        else {
+            xkb_state_update_key(state, kc, XKB_KEY_DOWN);
+            xkb_state_update_key(state, kc, XKB_KEY_UP);
+        }
+
+        xkb_state_update_mask(fresh,
+            xkb_state_serialize_mods(state, XKB_STATE_MODS_DEPRESSED),
+            xkb_state_serialize_mods(state, XKB_STATE_MODS_LATCHED),
+            xkb_state_serialize_mods(state, XKB_STATE_MODS_LOCKED),
+            xkb_state_serialize_layout(state, XKB_STATE_LAYOUT_DEPRESSED),
+            xkb_state_serialize_layout(state, XKB_STATE_LAYOUT_LATCHED),
+            xkb_state_serialize_layout(state, XKB_STATE_LAYOUT_LOCKED));
+
+        for (xkb_led_index_t led = 0; led < xkb_keymap_num_leds(keymap); led++)
+            assert(xkb_state_led_index_is_active(state, led) ==
+                   xkb_state_led_index_is_active(fresh, led));
+
+        xkb_state_unref(fresh);
+    }
+
+    xkb_state_unref(state);
+}
+
+/*
+ * The texts precomputed with XKB_KEYMAP_COMPILE_CACHE_TEXT must give
+ * exactly the same results as the uncached keymap, in every state.
+ */
+static void
+test_cached_text(struct xkb_keymap *keymap, struct xkb_keymap *cached)
+{
+    struct xkb_state *state = xkb_state_new(keymap);
+    struct xkb_state *cached_state = xkb_state_new(cached);
+    const char *mod_names[] = {
+        XKB_MOD_NAME_SHIFT, XKB_MOD_NAME_CAPS, XKB_MOD_NAME_CTRL, "LevelThree",
+    };
+    xkb_mod_mask_t mods[ARRAY_SIZE(mod_names)];
+    char buf[64], cached_buf[64];
+
+    assert(state && cached_state);
+
+    for (unsigned i = 0; i < ARRAY_SIZE(mod_names); i++) {
+        xkb_mod_index_t idx = xkb_keymap_mod_get_index(keymap, mod_names[i]);
+        assert(idx != XKB_MOD_INVALID);
+        assert(idx == xkb_keymap_mod_get_index(cached, mod_names[i]));
+        mods[i] = 1u << idx;
+    }
+
+    for (xkb_layout_index_t layout = 0;
+         layout < xkb_keymap_num_layouts(keymap); layout++) {
+        for (uint32_t combo = 0; combo < (1u << ARRAY_SIZE(mods)); combo++) {
+            xkb_mod_mask_t depressed = 0;
+
+            for (unsigned i = 0; i < ARRAY_SIZE(mods); i++)
+                if (combo & (1u << i))
+                    depressed |= mods[i];
+
+            xkb_state_update_mask(state, depressed, 0, 0, 0, 0, layout);
+            xkb_state_update_mask(cached_state, depressed, 0, 0, 0, 0, layout);
+
+            for (xkb_keycode_t kc = xkb_keymap_min_keycode(keymap);
+                 kc <= xkb_keymap_max_keycode(keymap); kc++) {
+                for (size_t size = 0; size <= 3; size++) {
+                    memset(buf, 'X', sizeof(buf));
+                    memset(cached_buf, 'X', sizeof(cached_buf));
+                    assert(xkb_state_key_get_utf8(state, kc, buf, size) ==
+                           xkb_state_key_get_utf8(cached_state, kc,
+                                                  cached_buf, size));
+                    assert(memcmp(buf, cached_buf, sizeof(buf)) == 0);
+                }
+                xkb_state_key_get_utf8(state, kc, buf, sizeof(buf));
+                xkb_state_key_get_utf8(cached_state, kc,
+                                       cached_buf, sizeof(cached_buf));
+                assert(streq(buf, cached_buf));
+                assert(xkb_state_key_get_utf32(state, kc) ==
+                       xkb_state_key_get_utf32(cached_state, kc));
+            }
+        }
+    }
+
+    xkb_state_unref(cached_state);
+    xkb_state_unref(state);
+}
+
+static void
+count_log_fn(struct xkb_context *ctx, enum xkb_log_level level,
+             const char *fmt, va_list args)
+{
+    unsigned int *count = xkb_context_get_user_data(ctx);
+
+    if (level == XKB_LOG_LEVEL_WARNING && strstr(fmt, "keys with actions"))
+        (*count)++;
+}
+
+/*
+ * The actions of the keys held down beyond the number of filters are
+ * ignored, and the others are unaffected.
+ */
+static void
+test_filters_exhausted(void)
+{
+    struct xkb_context *context = test_get_context(0);
+    struct xkb_keymap *keymap;
+    struct xkb_state *state;
+    darray_char string = darray_new();
+    unsigned int warnings = 0;
+    char line[128];
+
+    assert(context);
+    xkb_context_set_user_data(context, &warnings);
+    xkb_context_set_log_fn(context, count_log_fn);
+    xkb_context_set_log_level(context, XKB_LOG_LEVEL_WARNING);
+
+    /* Keys 10 to 42 set Shift, and key 9 locks Lock. */
+    darray_append_string(string, "xkb_keymap {\n  xkb_keycodes {\n");
+    for (int kc = 9; kc <= 42; kc++) {
+        snprintf(line, sizeof(line), "    <K%d> = %d;\n", kc, kc);
+        darray_append_string(string, line);
+    }
+    darray_append_string(string,
+                         "  };\n"
+                         "  xkb_types { include \"basic\" };\n"
+                         "  xkb_compat { };\n"
+                         "  xkb_symbols {\n"
+                         "    key <K9> { [ Caps_Lock ], actions[Group1] ="
+                         " [ LockMods(modifiers=Lock) ] };\n");
+    for (int kc = 10; kc <= 42; kc++) {
+        snprintf(line, sizeof(line),
+                 "    key <K%d> { [ Shift_L ], actions[Group1] ="
+                 " [ SetMods(modifiers=Shift) ] };\n", kc);
+        darray_append_string(string, line);
+    }
+    darray_append_string(string, "  };\n};\n");
+
+    keymap = test_compile_string(context, string.item);
+    assert(keymap);
+    state = xkb_state_new(keymap);
+    assert(state);
+
+    for (xkb_keycode_t kc = 10; kc <= 42; kc++)
+        xkb_state_update_key(state, kc, XKB_KEY_DOWN);
+    assert(xkb_state_mod_name_is_active(state, XKB_MOD_NAME_SHIFT,
+                                        XKB_STATE_MODS_DEPRESSED) > 0);
+    assert(warnings == 1);
+
+    /* All the filters are taken. */
+    xkb_state_update_key(state, 9, XKB_KEY_DOWN);
+    xkb_state_update_key(state, 9, XKB_KEY_UP);
+    assert(xkb_state_mod_name_is_active(state, XKB_MOD_NAME_CAPS,
+                                        XKB_STATE_MODS_LOCKED) == 0);
+    assert(warnings == 1);
+
+    for (xkb_keycode_t kc = 10; kc <= 42; kc++)
+        xkb_state_update_key(state, kc, XKB_KEY_UP);
+    assert(xkb_state_mod_name_is_active(state, XKB_MOD_NAME_SHIFT,
+                                        XKB_STATE_MODS_DEPRESSED) == 0);
+
+    xkb_state_update_key(state, 9, XKB_KEY_DOWN);
+    xkb_state_update_key(state, 9, XKB_KEY_UP);
+    assert(xkb_state_mod_name_is_active(state, XKB_MOD_NAME_CAPS,
+                                        XKB_STATE_MODS_LOCKED) > 0);
+
+    xkb_state_unref(state);
+    xkb_keymap_unref(keymap);
+    darray_free(string);
+    xkb_context_unref(context);
+}
+
 int
 main(void)
 {
     struct xkb_context *context = test_get_context(0);
-    struct xkb_keymap *keymap;
+    struct xkb_keymap *keymap, *cached;
+    struct xkb_rule_names rmlvo = {
+        "evdev", "pc104", "us,ru", NULL, "grp:menu_toggle"
+    };
 
     assert(context);
 
@@ -724,20 +1284,52 @@ main(void)
     assert(keymap);
 
     test_update_key(keymap);
+    test_update_keys(keymap);
+    test_led_updates(keymap);
     test_serialisation(keymap);
     test_update_mask_mods(keymap);
+    test_update_mask_repeated(keymap);
+    test_clone_and_snapshot(keymap);
     test_repeat(keymap);
+    test_state_repeat(keymap);
     test_consume(keymap);
     test_range(keymap);
+    test_layout_wrap(keymap);
+    test_queries(context, keymap);
     test_get_utf8_utf32(keymap);
     test_ctrl_string_transformation(keymap);
 
+    xkb_keymap_unref(keymap);
+    keymap = xkb_keymap_new_from_names(context, &rmlvo, 0);
+    cached = xkb_keymap_new_from_names(context, &rmlvo,
+                                       XKB_KEYMAP_COMPILE_CACHE_TEXT);
+    assert(keymap && cached);
+
+    test_get_utf8_utf32(cached);
+    test_ctrl_string_transformation(cached);
+    test_cached_text(keymap, cached);
+
+    xkb_keymap_unref(cached);
     xkb_keymap_unref(keymap);
     keymap = test_compile_rules(context, "evdev", NULL, "ch", "fr", NULL);
     assert(keymap);
 
     test_caps_keysym_transformation(keymap);
 
+    rmlvo.model = NULL;
+    rmlvo.layout = "ch";
+    rmlvo.variant = "fr";
+    rmlvo.options = NULL;
+    cached = xkb_keymap_new_from_names(context, &rmlvo,
+                                       XKB_KEYMAP_COMPILE_CACHE_TEXT);
+    assert(cached);
+
+    test_caps_keysym_transformation(cached);
+    test_cached_text(keymap, cached);
+
+    xkb_keymap_unref(cached);
     xkb_keymap_unref(keymap);
     xkb_context_unref(context);
+
+    test_filters_exhausted();
 }
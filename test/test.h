@@ -62,6 +62,8 @@ test_read_file(const char *path_rel);
 enum test_context_flags {
     CONTEXT_NO_FLAG = 0,
     CONTEXT_ALLOW_ENVIRONMENT_NAMES = (1 << 0),
+    CONTEXT_SHARE_KEYMAPS = (1 << 1),
+    CONTEXT_THREAD_SAFE = (1 << 2),
 };
 
 struct xkb_context *
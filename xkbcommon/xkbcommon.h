@@ -527,7 +527,39 @@ enum xkb_context_flags {
      * Don't take RMLVO names from the environment.
      * @since 0.3.0
      */
-    XKB_CONTEXT_NO_ENVIRONMENT_NAMES = (1 << 1)
+    XKB_CONTEXT_NO_ENVIRONMENT_NAMES = (1 << 1),
+    /**
+     * Share the keymaps created from names.
+     *
+     * While a keymap created by xkb_keymap_new_from_names() is alive,
+     * calling it again with the same names, after applying the defaults,
+     * and the same flags returns a new reference to that keymap instead of
+     * compiling a new one.  This is only visible if the XKB files changed
+     * in between, or if the keymap was modified with
+     * xkb_keymap_key_set_repeats(), which stops it from being shared.
+     * Changing the include paths stops the existing keymaps from being
+     * shared too.
+     *
+     * @since 0.8.0
+     */
+    XKB_CONTEXT_SHARE_KEYMAPS = (1 << 2),
+    /**
+     * Allow several threads to use this context at once.
+     *
+     * Keymaps may then be created against the context from several
+     * threads concurrently, without external locking, and the context,
+     * keymaps and states may be referenced and unreferenced from any
+     * thread.  The functions which configure the context, such as
+     * xkb_context_include_path_append() or xkb_context_set_log_fn(), must
+     * still not be called while it is in use by other threads.  The log
+     * function may be called from any of the threads.
+     *
+     * xkb_context_new() fails with this flag if the library was built
+     * without threads.
+     *
+     * @since 0.8.0
+     */
+    XKB_CONTEXT_THREAD_SAFE = (1 << 3)
 };
 
 /**
@@ -777,7 +809,29 @@ xkb_context_set_log_fn(struct xkb_context *context,
 /** Flags for keymap compilation. */
 enum xkb_keymap_compile_flags {
     /** Do not apply any flags. */
-    XKB_KEYMAP_COMPILE_NO_FLAGS = 0
+    XKB_KEYMAP_COMPILE_NO_FLAGS = 0,
+    /**
+     * Precompute the text produced by every key level, so that
+     * xkb_state_key_get_utf8() and xkb_state_key_get_utf32() are mostly
+     * table lookups.  This makes the keymap use more memory.  Not
+     * supported by xkb_x11_keymap_new_from_device().
+     *
+     * @since 0.8.0
+     */
+    XKB_KEYMAP_COMPILE_CACHE_TEXT = (1 << 0),
+    /**
+     * Read and parse the files included by the keymap on several threads,
+     * one per CPU, before compiling it.  This only helps when the files
+     * were not parsed already in the context, and the keymap is the same
+     * as without this flag.
+     *
+     * The log messages from parsing the files are still reported from the
+     * calling thread, in the same order.  Ignored with a single CPU, or if
+     * the library was built without threads.
+     *
+     * @since 0.8.0
+     */
+    XKB_KEYMAP_COMPILE_PARALLEL = (1 << 1)
 };
 
 /**
@@ -801,10 +855,50 @@ xkb_keymap_new_from_names(struct xkb_context *context,
                           const struct xkb_rule_names *names,
                           enum xkb_keymap_compile_flags flags);
 
+/**
+ * Set a directory in which to cache the keymaps compiled from RMLVO names.
+ *
+ * When set, xkb_keymap_new_from_names() first looks for a keymap compiled
+ * earlier from the same names, with the same include paths and the same
+ * version of the library.  The cached keymap is used only if none of the
+ * files considered while compiling it, including the ones which were not
+ * found in an include path, have changed since; it is then loaded without
+ * processing the rules and the XKB data files.  Otherwise, the keymap is
+ * compiled normally and stored in the cache.
+ *
+ * The directory must exist and be writable; the library does not clean it
+ * up.  Cache entries are only valid for the system they were created on.
+ *
+ * @param context The context.
+ * @param path    The cache directory, or NULL to disable the cache.
+ *
+ * @returns 1 on success, or 0 if the path is not a directory.
+ *
+ * @memberof xkb_context
+ * @since 0.8.0
+ */
+int
+xkb_context_set_keymap_cache_dir(struct xkb_context *context,
+                                 const char *path);
+
 /** The possible keymap formats. */
 enum xkb_keymap_format {
     /** The current/classic XKB text format, as generated by xkbcomp -xkb. */
-    XKB_KEYMAP_FORMAT_TEXT_V1 = 1
+    XKB_KEYMAP_FORMAT_TEXT_V1 = 1,
+    /**
+     * A binary dump of a compiled keymap, which is loaded without any
+     * parsing or compilation.  It is meant for passing keymaps between
+     * processes on the same machine, e.g. in a shared memory file: it is
+     * in the byte order of the machine, and is only read by libxkbcommon
+     * versions which use the same version of the format.
+     *
+     * Use xkb_keymap_get_as_buffer() and xkb_keymap_new_from_buffer() or
+     * xkb_keymap_new_from_file() with this format; the strings functions
+     * don't support it.
+     *
+     * @since 0.8.0
+     */
+    XKB_KEYMAP_FORMAT_BINARY_V1 = 2
 };
 
 /**
@@ -850,6 +944,11 @@ xkb_keymap_new_from_string(struct xkb_context *context, const char *string,
  * This is just like xkb_keymap_new_from_string(), but takes a length argument
  * so the input string does not have to be zero-terminated.
  *
+ * This is also how keymaps in the XKB_KEYMAP_FORMAT_BINARY_V1 format are
+ * loaded, for example from a mapping of a shared memory file.  The keymap
+ * is copied out of the buffer in one pass, so the buffer is not used
+ * anymore once the function returns.
+ *
  * @see xkb_keymap_new_from_string()
  * @memberof xkb_keymap
  * @since 0.3.0
@@ -907,6 +1006,33 @@ char *
 xkb_keymap_get_as_string(struct xkb_keymap *keymap,
                          enum xkb_keymap_format format);
 
+/**
+ * Get the compiled keymap as a buffer.
+ *
+ * This is like xkb_keymap_get_as_string(), but also supports the formats
+ * which are not text, such as XKB_KEYMAP_FORMAT_BINARY_V1.
+ *
+ * @param keymap The keymap to get as a buffer.
+ * @param format The keymap format to use for the buffer, or
+ * XKB_KEYMAP_USE_ORIGINAL_FORMAT.
+ * @param[out] length Set to the length of the buffer.  For the text
+ * formats, the buffer is still NUL-terminated, and the length excludes
+ * the terminating NUL.
+ *
+ * @returns The keymap as a buffer, or NULL if unsuccessful.
+ *
+ * The returned buffer may be fed back into xkb_keymap_new_from_buffer() to
+ * get the exact same keymap.  It is dynamically allocated and should be
+ * freed by the caller.
+ *
+ * @memberof xkb_keymap
+ * @since 0.8.0
+ */
+char *
+xkb_keymap_get_as_buffer(struct xkb_keymap *keymap,
+                         enum xkb_keymap_format format,
+                         size_t *length);
+
 /** @} */
 
 /**
@@ -1171,6 +1297,19 @@ xkb_keymap_key_get_syms_by_level(struct xkb_keymap *keymap,
 int
 xkb_keymap_key_repeats(struct xkb_keymap *keymap, xkb_keycode_t key);
 
+/**
+ * Set whether a key should repeat, in the keymap itself.
+ *
+ * This modifies the keymap, which affects every user of it, including,
+ * with XKB_CONTEXT_SHARE_KEYMAPS, the users who got it from
+ * xkb_keymap_new_from_names(); later calls compile a new keymap instead.
+ * To give a key a different repeat behavior for a single keyboard, prefer
+ * xkb_state_key_set_repeats().
+ *
+ * @returns 1 on success, 0 if the key is not in the keymap.
+ *
+ * @memberof xkb_keymap
+ */
 int
 xkb_keymap_key_set_repeats(struct xkb_keymap *keymap, xkb_keycode_t kc, int enable);
 
@@ -1206,6 +1345,20 @@ xkb_state_new(struct xkb_keymap *keymap);
 struct xkb_state *
 xkb_state_ref(struct xkb_state *state);
 
+/**
+ * Create a copy of a keyboard state object.
+ *
+ * The copy has the same components and the same keys held down as the
+ * original, and uses the same keymap, but is otherwise independent.
+ *
+ * @returns A new keyboard state object, or NULL on failure.
+ *
+ * @memberof xkb_state
+ * @since 0.8.0
+ */
+struct xkb_state *
+xkb_state_clone(struct xkb_state *state);
+
 /**
  * Release a reference on a keybaord state object, and possibly free it.
  *
@@ -1231,6 +1384,75 @@ xkb_state_unref(struct xkb_state *state);
 struct xkb_keymap *
 xkb_state_get_keymap(struct xkb_state *state);
 
+/**
+ * Determine whether a key should repeat, for this keyboard state.
+ *
+ * This is the same as xkb_keymap_key_repeats(), unless the repeat
+ * behavior was overridden with xkb_state_key_set_repeats() or
+ * xkb_state_set_repeats().
+ *
+ * @returns 1 if the key should repeat, 0 otherwise.
+ *
+ * @memberof xkb_state
+ * @since 0.8.0
+ */
+int
+xkb_state_key_repeats(struct xkb_state *state, xkb_keycode_t key);
+
+/**
+ * Set whether a key should repeat, for this keyboard state only.
+ *
+ * Unlike xkb_keymap_key_set_repeats(), the keymap is not modified, so it
+ * can be shared by states with different repeat behaviors.
+ *
+ * @returns 1 on success, 0 if the key is not in the keymap or on failure.
+ *
+ * @memberof xkb_state
+ * @since 0.8.0
+ */
+int
+xkb_state_key_set_repeats(struct xkb_state *state, xkb_keycode_t key,
+                          int enable);
+
+/**
+ * Get whether every key should repeat, for this keyboard state, as a
+ * bitmap.
+ *
+ * Bit (key % 32) of bitmap[key / 32] is set if the key repeats.
+ *
+ * @param state     The keyboard state object.
+ * @param bitmap    The bitmap to fill, or NULL to only get its size.
+ * @param num_words The number of elements in bitmap.  Keys which don't
+ *                  fit are not reported.
+ *
+ * @returns The number of elements needed to report every key.
+ *
+ * @memberof xkb_state
+ * @since 0.8.0
+ */
+size_t
+xkb_state_get_repeats(struct xkb_state *state, uint32_t *bitmap,
+                      size_t num_words);
+
+/**
+ * Set whether every key should repeat, for this keyboard state only.
+ *
+ * @param state     The keyboard state object.
+ * @param bitmap    A bitmap in the format of xkb_state_get_repeats(), or
+ *                  NULL to go back to the behavior of the keymap for every
+ *                  key.
+ * @param num_words The number of elements in bitmap.  Keys which don't fit
+ *                  keep their current behavior.
+ *
+ * @returns 1 on success, 0 on failure.
+ *
+ * @memberof xkb_state
+ * @since 0.8.0
+ */
+int
+xkb_state_set_repeats(struct xkb_state *state, const uint32_t *bitmap,
+                      size_t num_words);
+
 /** Specifies the direction of the key (press / release). */
 enum xkb_key_direction {
     XKB_KEY_UP,   /**< The key was released. */
@@ -1306,6 +1528,57 @@ enum xkb_state_component
 xkb_state_update_key(struct xkb_state *state, xkb_keycode_t key,
                      enum xkb_key_direction direction);
 
+/**
+ * A key event, for use with xkb_state_update_keys().
+ *
+ * @since 0.8.0
+ */
+struct xkb_key_event {
+    /** The keycode of the key; set by the caller. */
+    xkb_keycode_t keycode;
+    /** Whether the key is pressed or released; set by the caller. */
+    enum xkb_key_direction direction;
+    /**
+     * The keysym of the key, as given by xkb_state_key_get_one_sym() just
+     * before the event is applied; set by xkb_state_update_keys().
+     */
+    xkb_keysym_t keysym;
+    /**
+     * The Unicode codepoint of the key, as given by
+     * xkb_state_key_get_utf32() just before the event is applied; set by
+     * xkb_state_update_keys().
+     */
+    uint32_t utf32;
+};
+
+/**
+ * Update the keyboard state to reflect a series of keys being pressed or
+ * released, e.g. all the key events of an evdev frame.
+ *
+ * This is equivalent to calling xkb_state_key_get_one_sym(),
+ * xkb_state_key_get_utf32() and xkb_state_update_key() for each event in
+ * turn, but is faster: in particular the LEDs are only updated once, at
+ * the end of the batch.
+ *
+ * @param state      The keyboard state object.
+ * @param events     The events to apply, in order.  The keysym and utf32
+ *                   fields of each event are filled in.
+ * @param num_events The number of events.
+ *
+ * @returns A mask of state components that have changed as a result of
+ * any of the events.  The XKB_STATE_LEDS component is only included if the
+ * LEDs differ before and after the whole batch.  If nothing in the state
+ * has changed, returns 0.
+ *
+ * @memberof xkb_state
+ *
+ * @sa xkb_state_update_key()
+ * @since 0.8.0
+ */
+enum xkb_state_component
+xkb_state_update_keys(struct xkb_state *state, struct xkb_key_event *events,
+                      size_t num_events);
+
 /**
  * Update a keyboard state from a set of explicit masks.
  *
@@ -1325,6 +1598,9 @@ xkb_state_update_key(struct xkb_state *state, xkb_keycode_t key,
  * xkb_state_update_key() instead.  The two functions should not generally be
  * used together.
  *
+ * Calling this function again with the same parameters is cheap, so it
+ * is not necessary to filter out redundant updates.
+ *
  * @returns A mask of state components that have changed as a result of
  * the update.  If nothing in the state has changed, returns 0.
  *
@@ -1541,6 +1817,48 @@ xkb_layout_index_t
 xkb_state_serialize_layout(struct xkb_state *state,
                            enum xkb_state_component components);
 
+/**
+ * All the components of a keyboard state, as returned by
+ * xkb_state_serialize_components().
+ *
+ * @since 0.8.0
+ */
+struct xkb_state_components {
+    /** As given by xkb_state_serialize_mods(XKB_STATE_MODS_DEPRESSED). */
+    xkb_mod_mask_t depressed_mods;
+    /** As given by xkb_state_serialize_mods(XKB_STATE_MODS_LATCHED). */
+    xkb_mod_mask_t latched_mods;
+    /** As given by xkb_state_serialize_mods(XKB_STATE_MODS_LOCKED). */
+    xkb_mod_mask_t locked_mods;
+    /** As given by xkb_state_serialize_mods(XKB_STATE_MODS_EFFECTIVE). */
+    xkb_mod_mask_t mods;
+    /** As given by xkb_state_serialize_layout(XKB_STATE_LAYOUT_DEPRESSED). */
+    xkb_layout_index_t depressed_layout;
+    /** As given by xkb_state_serialize_layout(XKB_STATE_LAYOUT_LATCHED). */
+    xkb_layout_index_t latched_layout;
+    /** As given by xkb_state_serialize_layout(XKB_STATE_LAYOUT_LOCKED). */
+    xkb_layout_index_t locked_layout;
+    /** As given by xkb_state_serialize_layout(XKB_STATE_LAYOUT_EFFECTIVE). */
+    xkb_layout_index_t layout;
+    /** The mask of active LEDs, by index. */
+    xkb_led_mask_t leds;
+};
+
+/**
+ * The same as calling xkb_state_serialize_mods() and
+ * xkb_state_serialize_layout() for every component, and getting the
+ * active LEDs, at once.
+ *
+ * @param state      The keyboard state object.
+ * @param components Filled with the components of the state.
+ *
+ * @memberof xkb_state
+ * @since 0.8.0
+ */
+void
+xkb_state_serialize_components(struct xkb_state *state,
+                               struct xkb_state_components *components);
+
 /**
  * Test whether a modifier is active in a given keyboard state by name.
  *
@@ -1737,6 +2055,62 @@ xkb_state_key_get_consumed_mods2(struct xkb_state *state, xkb_keycode_t key,
 xkb_mod_mask_t
 xkb_state_key_get_consumed_mods(struct xkb_state *state, xkb_keycode_t key);
 
+/**
+ * Same as xkb_state_key_get_layout(), for the state described by a
+ * snapshot taken with xkb_state_serialize_components().
+ *
+ * This function and the other xkb_state_components_* functions do not
+ * modify anything, so they may be called from several threads at once,
+ * e.g. with a snapshot published by the thread updating the state.
+ *
+ * @param keymap     The keymap of the state the snapshot was taken from.
+ * @param components The snapshot.
+ * @param key        The keycode of the key.
+ *
+ * @since 0.8.0
+ */
+xkb_layout_index_t
+xkb_state_components_key_get_layout(struct xkb_keymap *keymap,
+                                    const struct xkb_state_components *components,
+                                    xkb_keycode_t key);
+
+/**
+ * Same as xkb_state_key_get_level(), for the state described by a snapshot.
+ *
+ * @sa xkb_state_components_key_get_layout()
+ * @since 0.8.0
+ */
+xkb_level_index_t
+xkb_state_components_key_get_level(struct xkb_keymap *keymap,
+                                   const struct xkb_state_components *components,
+                                   xkb_keycode_t key,
+                                   xkb_layout_index_t layout);
+
+/**
+ * Same as xkb_state_key_get_syms(), for the state described by a snapshot.
+ *
+ * @sa xkb_state_components_key_get_layout()
+ * @since 0.8.0
+ */
+int
+xkb_state_components_key_get_syms(struct xkb_keymap *keymap,
+                                  const struct xkb_state_components *components,
+                                  xkb_keycode_t key,
+                                  const xkb_keysym_t **syms_out);
+
+/**
+ * Same as xkb_state_key_get_consumed_mods2(), for the state described by a
+ * snapshot.
+ *
+ * @sa xkb_state_components_key_get_layout()
+ * @since 0.8.0
+ */
+xkb_mod_mask_t
+xkb_state_components_key_get_consumed_mods(struct xkb_keymap *keymap,
+                                           const struct xkb_state_components *components,
+                                           xkb_keycode_t key,
+                                           enum xkb_consumed_mode mode);
+
 /**
  * Test whether a modifier is consumed by keyboard state translation for
  * a key.
@@ -1839,6 +2213,132 @@ xkb_state_led_name_is_active(struct xkb_state *state, const char *name);
 int
 xkb_state_led_index_is_active(struct xkb_state *state, xkb_led_index_t idx);
 
+/**
+ * @struct xkb_state_query
+ * Opaque prepared query of a keyboard state.
+ *
+ * A query tests the same thing as xkb_state_mod_names_are_active(),
+ * xkb_state_layout_name_is_active() or xkb_state_led_name_is_active(),
+ * with the names resolved once, when the query is created.  Testing it
+ * against a state is then only a mask comparison, so it is meant to be
+ * used by clients which check the same modifiers on every key event.
+ *
+ * A query is bound to the keymap it was created for, and is immutable
+ * (besides the reference count).
+ *
+ * @since 0.8.0
+ */
+struct xkb_state_query;
+
+/**
+ * Create a query testing whether a set of modifiers is active.
+ *
+ * @param keymap    The keymap the query will be used with.
+ * @param type      The component of the state against which to match the
+ * given modifiers.
+ * @param match     The manner by which to match the state against the
+ * given modifiers.
+ * @param names     The names of the modifiers.
+ * @param num_names The number of names.
+ *
+ * @returns A new query, or NULL if one of the modifiers does not exist in
+ * the keymap.
+ *
+ * @sa xkb_state_mod_names_are_active()
+ * @memberof xkb_state_query
+ * @since 0.8.0
+ */
+struct xkb_state_query *
+xkb_state_query_new_mods(struct xkb_keymap *keymap,
+                         enum xkb_state_component type,
+                         enum xkb_state_match match,
+                         const char *const *names, size_t num_names);
+
+/**
+ * Create a query testing whether a set of layouts is active.
+ *
+ * A layout is active if one of the layout components given in type is
+ * equal to its index; the match flags apply to the set of the active
+ * layouts, the same way as for modifiers.
+ *
+ * @param keymap    The keymap the query will be used with.
+ * @param type      The component of the state against which to match the
+ * given layouts.
+ * @param match     The manner by which to match the state against the
+ * given layouts.
+ * @param names     The names of the layouts.  If multiple layouts in the
+ * keymap have a name, the one with the lowest index is used.
+ * @param num_names The number of names.
+ *
+ * @returns A new query, or NULL if one of the layouts does not exist in
+ * the keymap.
+ *
+ * @sa xkb_state_layout_name_is_active()
+ * @memberof xkb_state_query
+ * @since 0.8.0
+ */
+struct xkb_state_query *
+xkb_state_query_new_layouts(struct xkb_keymap *keymap,
+                            enum xkb_state_component type,
+                            enum xkb_state_match match,
+                            const char *const *names, size_t num_names);
+
+/**
+ * Create a query testing whether a set of LEDs is active.
+ *
+ * @param keymap    The keymap the query will be used with.
+ * @param match     The manner by which to match the state against the
+ * given LEDs.
+ * @param names     The names of the LEDs.
+ * @param num_names The number of names.
+ *
+ * @returns A new query, or NULL if one of the LEDs does not exist in the
+ * keymap.
+ *
+ * @sa xkb_state_led_name_is_active()
+ * @memberof xkb_state_query
+ * @since 0.8.0
+ */
+struct xkb_state_query *
+xkb_state_query_new_leds(struct xkb_keymap *keymap,
+                         enum xkb_state_match match,
+                         const char *const *names, size_t num_names);
+
+/**
+ * Take a new reference on a query.
+ *
+ * @returns The passed in object.
+ *
+ * @memberof xkb_state_query
+ * @since 0.8.0
+ */
+struct xkb_state_query *
+xkb_state_query_ref(struct xkb_state_query *query);
+
+/**
+ * Release a reference on a query, and possibly free it.
+ *
+ * @param query The query.  If it is NULL, this function does nothing.
+ *
+ * @memberof xkb_state_query
+ * @since 0.8.0
+ */
+void
+xkb_state_query_unref(struct xkb_state_query *query);
+
+/**
+ * Test a prepared query against a keyboard state.
+ *
+ * @returns 1 if the query matches, 0 if it does not.  If the query was
+ * created for another keymap than the one of the state, returns -1.
+ *
+ * @memberof xkb_state
+ * @since 0.8.0
+ */
+int
+xkb_state_query_is_active(struct xkb_state *state,
+                          const struct xkb_state_query *query);
+
 /** @} */
 
 /* Leave this include last, so it can pick up our types, etc. */